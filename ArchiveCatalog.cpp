@@ -0,0 +1,512 @@
+/** @file ArchiveCatalog.cpp
+ * Contains the implementation of the ArchiveCatalog class.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#include "ArchiveCatalog.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+//from CommonClasses
+#include "OSPMessage.h"
+//from this project
+#include "ResultCache.h"
+
+//@cond DUMMY
+//the catalog file identification and format version
+static const char MAGIC[8] = {'O', 'S', 'P', 'C', 'A', 'T', '1', 0};
+//initial number of entries allocated in a new catalog
+static const uint32_t INITCAPACITY = 256;
+//seconds in a GPS week
+static const double WEEKSECS = 604800.0;
+//seconds from the Unix epoch to the GPS epoch (1980-01-06)
+static const int64_t GPSEPOCH = 315964800;
+//@endcond
+
+/**Header is the first part of the catalog file
+ */
+struct ArchiveCatalog::Header {
+	char magic[8];			//the MAGIC identification
+	uint32_t entrySize;		//the size of a CatalogEntry, to detect incompatible formats
+	uint32_t count;			//number of entries in use
+	uint32_t capacity;		//number of entries allocated
+	uint32_t reserved;
+	double maxSpan;			//the longest time span of any entry, to bound lookups
+	unsigned char padding[32];
+};
+
+/**Span is an element of the time index, sorted by start time
+ */
+struct ArchiveCatalog::Span {
+	double start;			//the start time of the entry
+	double end;				//the end time of the entry
+	uint64_t pathHash;		//the hash of the entry path, to speed up searches by name
+	uint32_t entry;			//the entry index
+	uint32_t reserved;
+};
+
+//@cond DUMMY
+//the catalog file size for a given capacity: header, entries, and time index
+static size_t catalogSize(uint32_t capacity) {
+	return 64 + (size_t) capacity * (sizeof(CatalogEntry) + 32);
+}
+//the hash of a path name
+static uint64_t pathHash(const string& path) {
+	Hash64 h;
+	h.update(path.c_str(), path.size());
+	return h.digest();
+}
+//number of days from 1970-01-01 to the given civil date
+static int64_t daysFromCivil(int y, int m, int d) {
+	y -= m <= 2;
+	int64_t era = (y >= 0 ? y : y - 399) / 400;
+	int64_t yoe = y - era * 400;
+	int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+	int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + doe - 719468;
+}
+//@endcond
+
+/**ArchiveCatalog
+ * constructs an empty and closed ArchiveCatalog object.
+ */
+ArchiveCatalog::ArchiveCatalog() {
+	fd = -1;
+	update = false;
+	map = NULL;
+	mapSize = 0;
+}
+
+/**~ArchiveCatalog
+ * closes the catalog, if open.
+ */
+ArchiveCatalog::~ArchiveCatalog() {
+	close();
+}
+
+/**open
+ * opens the given catalog file for lookups or updates, locking it.
+ * When opened for update, the catalog file is created if it does not exist.
+ *
+ *@param fileName the catalog file name. If empty, the catalog remains closed
+ *@param update true to add or refresh entries, false to perform lookups only
+ *@return true if the catalog is open, false otherwise
+ */
+bool ArchiveCatalog::open(string fileName, bool update) {
+	close();
+	if (fileName.empty()) return false;
+	if ((fd = ::open(fileName.c_str(), update ? O_RDWR | O_CREAT : O_RDONLY, 0664)) < 0) return false;
+	this->update = update;
+	struct stat st;
+	if ((flock(fd, update ? LOCK_EX : LOCK_SH) != 0) || (fstat(fd, &st) != 0)) {
+		close();
+		return false;
+	}
+	if (st.st_size == 0 && update) {	//a new catalog
+		if ((ftruncate(fd, catalogSize(INITCAPACITY)) != 0) || !mapFile(catalogSize(INITCAPACITY))) {
+			close();
+			return false;
+		}
+		Header* h = header();
+		memcpy(h->magic, MAGIC, sizeof MAGIC);
+		h->entrySize = sizeof(CatalogEntry);
+		h->capacity = INITCAPACITY;
+		return true;
+	}
+	if ((size_t) st.st_size < catalogSize(0) || !mapFile(st.st_size)
+		|| (memcmp(header()->magic, MAGIC, sizeof MAGIC) != 0)
+		|| (header()->entrySize != sizeof(CatalogEntry))
+		|| (catalogSize(header()->capacity) > mapSize)) {
+		close();
+		return false;
+	}
+	return true;
+}
+
+/**isOpen
+ * tells if the catalog is open.
+ *
+ *@return true if open, false otherwise
+ */
+bool ArchiveCatalog::isOpen() {
+	return map != NULL;
+}
+
+/**close
+ * unmaps and unlocks the catalog file.
+ */
+void ArchiveCatalog::close() {
+	if (map != NULL) {
+		if (update) msync(map, mapSize, MS_ASYNC);
+		munmap(map, mapSize);
+	}
+	map = NULL;
+	mapSize = 0;
+	if (fd >= 0) ::close(fd);	//also releases the lock
+	fd = -1;
+}
+
+/**size
+ * gives the number of entries in the catalog.
+ *
+ *@return the number of entries
+ */
+unsigned int ArchiveCatalog::size() {
+	return isOpen() ? header()->count : 0;
+}
+
+/**entry
+ * gives the entry in the given position of the time index. Entries are sorted by start time.
+ *
+ *@param n the position in the index
+ *@return the entry, or NULL if it does not exist
+ */
+const CatalogEntry* ArchiveCatalog::entry(unsigned int n) {
+	if (n >= size()) return NULL;
+	return entries() + spans()[n].entry;
+}
+
+/**find
+ * gives the catalog entry of the given OSP file, as it was cataloged.
+ *
+ *@param fileName the OSP file name
+ *@return the entry, or NULL if the file is not in the catalog
+ */
+const CatalogEntry* ArchiveCatalog::find(string fileName) {
+	if (!isOpen()) return NULL;
+	int n = findIndex(fullPath(fileName));
+	return n < 0 ? NULL : entries() + n;
+}
+
+/**addOSP
+ * adds the given OSP file to the catalog, or refreshes its entry if the file has changed since it was cataloged.
+ * The file is scanned to get the receiver identification, time span, number of epochs, and messages per MID.
+ * Output files already recorded for the file are kept.
+ *
+ *@param ospFile the OSP file name
+ *@param plog a pointer to the Logger
+ *@return the entry of the file, or NULL if the catalog is not open for update, the file cannot be read, or its path
+ * does not fit in the entry
+ */
+const CatalogEntry* ArchiveCatalog::addOSP(string ospFile, Logger* plog) {
+	if (!isOpen() || !update) return NULL;
+	string path = fullPath(ospFile);
+	if (path.size() >= sizeof ((CatalogEntry*) NULL)->path) {
+		plog->warning("Catalog: path too long to be cataloged " + path);
+		return NULL;
+	}
+	struct stat st;
+	if (stat(path.c_str(), &st) != 0) {
+		plog->warning("Catalog: cannot access " + path);
+		return NULL;
+	}
+	int n = findIndex(path);
+	if (n >= 0 && entries()[n].size == (uint64_t) st.st_size && entries()[n].mtime == (int64_t) st.st_mtime)
+		return entries() + n;
+	/// 1- Scans the OSP file messages
+	FILE* inFile = fopen(path.c_str(), "rb");
+	if (inFile == NULL) {
+		plog->warning("Catalog: cannot open " + path);
+		return NULL;
+	}
+	CatalogEntry e;
+	memset(&e, 0, sizeof e);
+	strcpy(e.path, path.c_str());
+	e.size = st.st_size;
+	e.mtime = st.st_mtime;
+	OSPMessage message;
+	while (message.fill(inFile)) {
+		int mid = message.get();
+		e.messages++;
+		e.midCount[mid & 0xFF]++;
+		if (mid == 6 && e.receiver[0] == 0) {		//MID 6: SiRF and customer versions
+			unsigned int lsirf = message.get();
+			unsigned int lcust = message.get();
+			string rx;
+			while (lsirf-- > 0) rx += (char) message.get();
+			rx += ';';
+			while (lcust-- > 0) rx += (char) message.get();
+			strncpy(e.receiver, rx.c_str(), sizeof e.receiver - 1);
+		} else if (mid == 7) {	//MID 7: extended week and TOW
+			double week = message.getUShort();
+			double t = week * WEEKSECS + message.getUInt() / 100.0;
+			if (e.epochs == 0 || t < e.start) e.start = t;
+			if (e.epochs == 0 || t > e.end) e.end = t;
+			e.epochs++;
+		}
+	}
+	fclose(inFile);
+	/// 2- Stores the entry, keeping outputs of a previous one, and updates the time index
+	if (n < 0) {
+		if (header()->count == header()->capacity && !grow()) {
+			plog->warning("Catalog: cannot grow catalog file");
+			return NULL;
+		}
+		n = header()->count;
+	} else memcpy(e.outputs, entries()[n].outputs, sizeof e.outputs);
+	memcpy(entries() + n, &e, sizeof e);
+	indexSpan(n);
+	if (e.end - e.start > header()->maxSpan) header()->maxSpan = e.end - e.start;
+	plog->fine("Catalog: " + path + " epochs " + to_string((long long) e.epochs)
+		+ " from " + gpsTimeTXT(e.start) + " to " + gpsTimeTXT(e.end));
+	return entries() + n;
+}
+
+/**addOutputs
+ * records in the catalog the given files as generated from the given OSP file.
+ * The OSP file is added to the catalog, or refreshed, if needed.
+ *
+ *@param ospFile the OSP file name
+ *@param outputs the names of the files generated from it
+ *@param plog a pointer to the Logger
+ *@return true if outputs have been recorded, false otherwise
+ */
+bool ArchiveCatalog::addOutputs(string ospFile, const vector<string>& outputs, Logger* plog) {
+	if (addOSP(ospFile, plog) == NULL) return false;
+	CatalogEntry* e = entries() + findIndex(fullPath(ospFile));
+	string all = e->outputs;
+	bool fits = true;
+	for (vector<string>::const_iterator it = outputs.begin(); it != outputs.end(); it++) {
+		string out = fullPath(*it);
+		if ((";" + all + ";").find(";" + out + ";") != string::npos) continue;
+		string added = all.empty() ? out : all + ";" + out;
+		if (added.size() >= sizeof e->outputs) {
+			fits = false;
+			continue;
+		}
+		all = added;
+	}
+	strncpy(e->outputs, all.c_str(), sizeof e->outputs - 1);
+	if (!fits) plog->warning("Catalog: no room to record all outputs of " + string(e->path));
+	return fits;
+}
+
+/**lookup
+ * gives the entries of OSP files having data in the given time span and from the given receiver.
+ *
+ *@param start the GPS time of the span start, in seconds
+ *@param end the GPS time of the span end, in seconds
+ *@param receiver a text to be contained in the receiver identification. Empty to select any receiver
+ *@return the entries found, sorted by start time
+ */
+vector<const CatalogEntry*> ArchiveCatalog::lookup(double start, double end, string receiver) {
+	vector<const CatalogEntry*> found;
+	if (!isOpen()) return found;
+	Span* sp = spans();
+	uint32_t lo = 0, hi = header()->count;
+	double from = start - header()->maxSpan;	//no entry starting before it can reach start
+	while (lo < hi) {
+		uint32_t mid = (lo + hi) / 2;
+		if (sp[mid].start < from) lo = mid + 1;
+		else hi = mid;
+	}
+	for (; lo < header()->count && sp[lo].start <= end; lo++) {
+		if (sp[lo].end < start) continue;
+		const CatalogEntry* e = entries() + sp[lo].entry;
+		if (receiver.empty() || strstr(e->receiver, receiver.c_str()) != NULL) found.push_back(e);
+	}
+	return found;
+}
+
+/**record
+ * opens the given catalog for update, adds or refreshes the given OSP file, records the given outputs generated
+ * from it, if any, and closes the catalog.
+ *
+ *@param catalogFile the catalog file name. If empty, nothing is done
+ *@param ospFile the OSP file name
+ *@param outputs the names of the files generated from the OSP file
+ *@param plog a pointer to the Logger
+ *@return true if the catalog has been updated, false otherwise
+ */
+bool ArchiveCatalog::record(string catalogFile, string ospFile, const vector<string>& outputs, Logger* plog) {
+	if (catalogFile.empty()) return false;
+	ArchiveCatalog catalog;
+	if (!catalog.open(catalogFile, true)) {
+		plog->warning("Cannot open catalog " + catalogFile);
+		return false;
+	}
+	if (outputs.empty()) return catalog.addOSP(ospFile, plog) != NULL;
+	return catalog.addOutputs(ospFile, outputs, plog);
+}
+
+/**gpsTimeTXT
+ * gives the given GPS time as a text with the format "YYYY-MM-DDThh:mm:ss.sss".
+ *
+ *@param gpsSeconds the GPS time in seconds from the GPS epoch
+ *@return the text
+ */
+string ArchiveCatalog::gpsTimeTXT(double gpsSeconds) {
+	time_t t = (time_t) (GPSEPOCH + (int64_t) gpsSeconds);
+	struct tm tmv;
+	char buf[40];
+	gmtime_r(&t, &tmv);
+	snprintf(buf, sizeof buf, "%04d-%02d-%02dT%02d:%02d:%06.3f", tmv.tm_year + 1900, tmv.tm_mon + 1, tmv.tm_mday,
+		tmv.tm_hour, tmv.tm_min, tmv.tm_sec + (gpsSeconds - (int64_t) gpsSeconds));
+	return string(buf);
+}
+
+/**gpsTimeVal
+ * gives the GPS time stated in the given text, with the format "YYYY-MM-DDThh:mm:ss" (GPS time scale) or "WEEK:TOW".
+ *
+ *@param txt the text to convert
+ *@param gpsSeconds where the GPS time in seconds from the GPS epoch is returned
+ *@return true if the text has a valid format, false otherwise
+ */
+bool ArchiveCatalog::gpsTimeVal(string txt, double& gpsSeconds) {
+	int year, month, day, hour = 0, minute = 0;
+	double sec = 0.0, tow;
+	char sep;
+	if (sscanf(txt.c_str(), "%d-%d-%d%c%d:%d:%lf", &year, &month, &day, &sep, &hour, &minute, &sec) >= 3) {
+		if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+		gpsSeconds = (double) (daysFromCivil(year, month, day) * 86400 - GPSEPOCH) + hour * 3600 + minute * 60 + sec;
+		return true;
+	}
+	if (sscanf(txt.c_str(), "%d:%lf", &day, &tow) == 2) {
+		gpsSeconds = day * WEEKSECS + tow;
+		return true;
+	}
+	return false;
+}
+
+/**header
+ * gives the catalog header.
+ *
+ *@return a pointer to the header in the mapped file
+ */
+ArchiveCatalog::Header* ArchiveCatalog::header() {
+	return (Header*) map;
+}
+
+/**entries
+ * gives the table of catalog entries.
+ *
+ *@return a pointer to the first entry in the mapped file
+ */
+CatalogEntry* ArchiveCatalog::entries() {
+	return (CatalogEntry*) (map + 64);
+}
+
+/**spans
+ * gives the time index, located after the entries allocated.
+ *
+ *@return a pointer to the first element of the index in the mapped file
+ */
+ArchiveCatalog::Span* ArchiveCatalog::spans() {
+	return (Span*) (map + 64 + (size_t) header()->capacity * sizeof(CatalogEntry));
+}
+
+/**mapFile
+ * maps in memory the given size of the catalog file.
+ *
+ *@param fileSize the size to map
+ *@return true if the file has been mapped, false otherwise
+ */
+bool ArchiveCatalog::mapFile(size_t fileSize) {
+	if (map != NULL) munmap(map, mapSize);
+	void* p = mmap(NULL, fileSize, update ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+	if (p == MAP_FAILED) {
+		map = NULL;
+		mapSize = 0;
+		return false;
+	}
+	map = (unsigned char*) p;
+	mapSize = fileSize;
+	return true;
+}
+
+/**grow
+ * doubles the number of entries allocated in the catalog file, moving the time index after them.
+ *
+ *@return true if the catalog has grown, false otherwise
+ */
+bool ArchiveCatalog::grow() {
+	uint32_t oldCapacity = header()->capacity;
+	uint32_t newCapacity = oldCapacity * 2;
+	if ((ftruncate(fd, catalogSize(newCapacity)) != 0) || !mapFile(catalogSize(newCapacity))) return false;
+	Span* oldSpans = spans();
+	header()->capacity = newCapacity;
+	memmove(spans(), oldSpans, (size_t) header()->count * sizeof(Span));
+	return true;
+}
+
+/**findIndex
+ * searches the entry of the given path.
+ *
+ *@param path the absolute path of the file
+ *@return the entry index, or -1 if not found
+ */
+int ArchiveCatalog::findIndex(string path) {
+	uint64_t h = pathHash(path);
+	Span* sp = spans();
+	for (uint32_t i = 0; i < header()->count; i++)
+		if (sp[i].pathHash == h && path.compare(entries()[sp[i].entry].path) == 0) return sp[i].entry;
+	return -1;
+}
+
+/**indexSpan
+ * places in the time index the given entry, according to its start time.
+ * If the entry is not yet indexed, it is added to the catalog.
+ *
+ *@param entryIdx the entry index
+ */
+void ArchiveCatalog::indexSpan(uint32_t entryIdx) {
+	Span* sp = spans();
+	uint32_t n = header()->count;
+	uint32_t i;
+	for (i = 0; i < n && sp[i].entry != entryIdx; i++);
+	if (i < n) {	//remove the old position
+		memmove(sp + i, sp + i + 1, (size_t) (n - i - 1) * sizeof(Span));
+		n--;
+	}
+	Span s;
+	CatalogEntry* e = entries() + entryIdx;
+	s.start = e->start;
+	s.end = e->end;
+	s.pathHash = pathHash(e->path);
+	s.entry = entryIdx;
+	s.reserved = 0;
+	uint32_t lo = 0, hi = n;
+	while (lo < hi) {
+		uint32_t mid = (lo + hi) / 2;
+		if (sp[mid].start <= s.start) lo = mid + 1;
+		else hi = mid;
+	}
+	memmove(sp + lo + 1, sp + lo, (size_t) (n - lo) * sizeof(Span));
+	sp[lo] = s;
+	header()->count = n + 1;
+}
+
+/**fullPath
+ * gives the absolute path of the given file, resolving links, if possible.
+ *
+ *@param fileName the file name
+ *@return the absolute path, or the name given if it cannot be resolved
+ */
+string ArchiveCatalog::fullPath(string fileName) {
+	char buf[PATH_MAX];
+	if (realpath(fileName.c_str(), buf) == NULL) return fileName;
+	return string(buf);
+}
@@ -0,0 +1,98 @@
+/** @file ArchiveCatalog.h
+ * Contains the definition of the ArchiveCatalog class, used to record and look up the OSP files in an archive and the
+ * files generated from them.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef ARCHIVECATALOG_H
+#define ARCHIVECATALOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+
+using namespace std;
+
+/**CatalogEntry is the record stored in the catalog for each OSP file.
+ * All strings are null terminated. Times are GPS seconds from the GPS epoch (week * 604800 + TOW).
+ * OSP files with an absolute path longer than 255 characters are not cataloged, as it would not fit in path.
+ */
+struct CatalogEntry {
+	char path[256];				//the absolute path of the OSP file
+	char receiver[96];			//the receiver identification: SiRF and customer versions in MID 6, separated by ';'
+	double start;				//GPS time of the first MID 7
+	double end;					//GPS time of the last MID 7
+	uint64_t size;				//the file size in bytes when it was cataloged
+	int64_t mtime;				//the file modification time when it was cataloged
+	uint32_t epochs;			//number of epochs (MID 7 messages)
+	uint32_t messages;			//number of messages
+	uint32_t midCount[256];		//number of messages for each MID
+	char outputs[632];			//files generated from the OSP file, separated by ';'
+};
+
+/**ArchiveCatalog defines data and methods to keep a catalog of OSP files and the files (RINEX, RTK, ...) generated
+ * from them, and to find quickly the files covering a given time span and receiver.
+ *<p>
+ * The catalog is a single file mapped in memory, containing a header, a table of fixed size CatalogEntry records, and
+ * an index of the time spans of the entries, sorted by start time. A lookup is a binary search in the index, without
+ * reading the OSP files. Entries are added or refreshed incrementally: an OSP file is scanned again only when its size
+ * or modification time have changed since it was cataloged.
+ *<p>
+ * The catalog file is locked while open: shared for lookups, exclusive for updates. Pointers to entries returned by
+ * methods are valid until the next update or close.
+ *<p>
+ * Commands generating files use record to open the catalog, add their outputs, and close it, holding the lock only
+ * while updating.
+ *<p>
+ * An empty catalog file name disables the catalog: all methods do nothing.
+ * This class is available only on POSIX systems.
+ */
+class ArchiveCatalog {
+public:
+	ArchiveCatalog();
+	~ArchiveCatalog();
+	bool open(string fileName, bool update);
+	bool isOpen();
+	void close();
+	unsigned int size();
+	const CatalogEntry* entry(unsigned int n);
+	const CatalogEntry* find(string fileName);
+	const CatalogEntry* addOSP(string ospFile, Logger* plog);
+	bool addOutputs(string ospFile, const vector<string>& outputs, Logger* plog);
+	vector<const CatalogEntry*> lookup(double start, double end, string receiver);
+	static bool record(string catalogFile, string ospFile, const vector<string>& outputs, Logger* plog);
+	static string gpsTimeTXT(double gpsSeconds);
+	static bool gpsTimeVal(string txt, double& gpsSeconds);
+private:
+	struct Header;
+	struct Span;
+	int fd;				//the descriptor of the catalog file, or -1 if closed
+	bool update;		//if the catalog was opened for update
+	unsigned char* map;	//the catalog file mapped in memory
+	size_t mapSize;		//the size of the mapped area
+	Header* header();
+	CatalogEntry* entries();
+	Span* spans();
+	bool mapFile(size_t fileSize);
+	bool grow();
+	int findIndex(string path);
+	void indexSpan(uint32_t entryIdx);
+	static string fullPath(string fileName);
+};
+#endif
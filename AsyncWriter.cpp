@@ -0,0 +1,233 @@
+/** @file AsyncWriter.cpp
+ * Contains the implementation of the AsyncWriter class.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#include "AsyncWriter.h"
+
+#include <string.h>
+#include <chrono>
+#include <new>
+
+/**AsyncWriter
+ * constructs an AsyncWriter not yet opened.
+ */
+AsyncWriter::AsyncWriter() {
+	outFile = NULL;
+	writer = NULL;
+	ring = NULL;
+	capacity = 0;
+	flushPeriod = 0;
+	head = 0;
+	tail = 0;
+	error = false;
+	nBatches = 0;
+	nWaits = 0;
+	stopping = false;
+}
+
+/**~AsyncWriter
+ * closes the writer, if open, writing pending data.
+ */
+AsyncWriter::~AsyncWriter() {
+	close();
+}
+
+/**open
+ * allocates the ring buffer and starts the background thread writing to the given file.
+ * The file shall remain open until the writer is closed.
+ *
+ *@param outFile the file where data will be written
+ *@param capacity the ring buffer size in bytes
+ *@param flushPeriod the maximum time, in milliseconds, data can stay in the ring before being written
+ *@return true if the writer has been started, false otherwise (already open or not enough memory)
+ */
+bool AsyncWriter::open(FILE* outFile, size_t capacity, int flushPeriod) {
+	if (outFile == NULL) return false;
+	return start(outFile, NULL, capacity, flushPeriod);
+}
+
+/**open
+ * allocates the ring buffer and starts the background thread writing through the given OutputWriter.
+ * The writer shall remain open until this AsyncWriter is closed.
+ *
+ *@param writer the writer of the file where data will be written
+ *@param capacity the ring buffer size in bytes
+ *@param flushPeriod the maximum time, in milliseconds, data can stay in the ring before being written
+ *@return true if the writer has been started, false otherwise (already open or not enough memory)
+ */
+bool AsyncWriter::open(OutputWriter* writer, size_t capacity, int flushPeriod) {
+	if (writer == NULL || !writer->isOpen()) return false;
+	return start(NULL, writer, capacity, flushPeriod);
+}
+
+//@cond DUMMY
+/**start
+ * allocates the ring buffer and starts the background thread writing to the given file or writer.
+ *
+ *@param outFile the file where data will be written, or NULL if they are written through the writer
+ *@param writer the writer of the file where data will be written, or NULL if they are written to outFile
+ *@param capacity the ring buffer size in bytes
+ *@param flushPeriod the maximum time, in milliseconds, data can stay in the ring before being written
+ *@return true if the writer has been started, false otherwise (already open or not enough memory)
+ */
+bool AsyncWriter::start(FILE* outFile, OutputWriter* writer, size_t capacity, int flushPeriod) {
+	if (ring != NULL || capacity == 0) return false;
+	ring = new (nothrow) unsigned char[capacity];
+	if (ring == NULL) return false;
+	this->outFile = outFile;
+	this->writer = writer;
+	this->capacity = capacity;
+	this->flushPeriod = flushPeriod;
+	head = 0;
+	tail = 0;
+	error = false;
+	nBatches = 0;
+	nWaits = 0;
+	stopping = false;
+	writerThread = thread(&AsyncWriter::run, this);
+	return true;
+}
+//@endcond
+
+/**write
+ * copies the given data into the ring buffer, to be written by the background thread.
+ * If there is not space enough in the ring, waits until the background thread releases it.
+ *
+ *@param data the pointer to data to be written
+ *@param len the number of bytes to write
+ *@return true if data have been accepted, false if the writer is not open or a write error has happened
+ */
+bool AsyncWriter::write(const void* data, size_t len) {
+	if (ring == NULL || error) return false;
+	const unsigned char* src = (const unsigned char*) data;
+	uint64_t h = head.load(memory_order_relaxed);
+	while (len > 0) {
+		size_t space = capacity - (size_t) (h - tail.load(memory_order_acquire));
+		if (space == 0) {
+			nWaits++;
+			unique_lock<mutex> lock(mtx);
+			dataCv.notify_one();
+			spaceCv.wait(lock, [&] {return error || tail.load(memory_order_acquire) != h - capacity;});
+			if (error) return false;
+			continue;
+		}
+		size_t n = len < space? len : space;
+		size_t pos = (size_t) (h % capacity);
+		size_t first = n < capacity - pos? n : capacity - pos;
+		memcpy(ring + pos, src, first);
+		if (n > first) memcpy(ring, src + first, n - first);
+		h += n;
+		src += n;
+		len -= n;
+		head.store(h, memory_order_release);
+	}
+	//wake up the writer thread only when a batch is ready; otherwise it will wake up at the flush period
+	if (h - tail.load(memory_order_relaxed) >= capacity / 2) dataCv.notify_one();
+	return true;
+}
+
+/**close
+ * stops the background thread after writing all pending data, and releases the ring buffer.
+ * The file is flushed, but not closed.
+ *
+ *@return true if all data have been written, false if a write error has happened
+ */
+bool AsyncWriter::close() {
+	if (ring == NULL) return !error;
+	{
+		lock_guard<mutex> lock(mtx);
+		stopping = true;
+	}
+	dataCv.notify_one();
+	writerThread.join();
+	delete[] ring;
+	ring = NULL;
+	return !error;
+}
+
+/**failed
+ * tells if a write error has happened.
+ *
+ *@return true if a write error has happened, false otherwise
+ */
+bool AsyncWriter::failed() {
+	return error;
+}
+
+/**bytesWritten
+ * gives the number of bytes written to the file.
+ *
+ *@return the number of bytes
+ */
+uint64_t AsyncWriter::bytesWritten() {
+	return tail.load(memory_order_acquire);
+}
+
+/**batches
+ * gives the number of batches written to the file.
+ *
+ *@return the number of batches
+ */
+uint64_t AsyncWriter::batches() {
+	return nBatches.load(memory_order_relaxed);
+}
+
+/**producerWaits
+ * gives the number of times the producer had to wait for space in the ring.
+ *
+ *@return the number of waits
+ */
+uint64_t AsyncWriter::producerWaits() {
+	return nWaits;
+}
+
+/**run
+ * is the body of the background thread: waits for a batch of data, or the flush period, and writes to the file
+ * the data in the ring, until the writer is closing and all data have been written.
+ */
+void AsyncWriter::run() {
+	bool last = false;
+	while (!last) {
+		{
+			unique_lock<mutex> lock(mtx);
+			dataCv.wait_for(lock, chrono::milliseconds(flushPeriod), [&] {
+				return stopping || head.load(memory_order_acquire) - tail.load(memory_order_relaxed) >= capacity / 2;
+			});
+			last = stopping;
+		}
+		uint64_t t = tail.load(memory_order_relaxed);
+		uint64_t h = head.load(memory_order_acquire);
+		if (h == t) continue;
+		if (!error) {
+			size_t n = (size_t) (h - t);
+			size_t pos = (size_t) (t % capacity);
+			size_t first = n < capacity - pos? n : capacity - pos;
+			if (writer != NULL) {
+				if (!writer->write(ring + pos, first) || (n > first && !writer->write(ring, n - first))
+					|| !writer->flush()) error = true;
+			} else if (fwrite(ring + pos, 1, first, outFile) != first
+				|| (n > first && fwrite(ring, 1, n - first, outFile) != n - first)
+				|| fflush(outFile) != 0) error = true;
+			nBatches++;
+		}
+		{
+			lock_guard<mutex> lock(mtx);
+			tail.store(h, memory_order_release);
+		}
+		spaceCv.notify_one();
+	}
+}
@@ -0,0 +1,77 @@
+/** @file AsyncWriter.h
+ * Contains the definition of the AsyncWriter class, used to write data to a file from a background thread.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ *<p>V1.1	|10/2026	|Added writing through an OutputWriter
+ */
+#ifndef ASYNCWRITER_H
+#define ASYNCWRITER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include "OutputWriter.h"
+
+using namespace std;
+
+/**AsyncWriter decouples the thread producing data from the writing of these data into a file.
+ * The producer copies data into a ring buffer, and a background thread writes them to the file in batches: when
+ * the ring is half full, when the flush period expires, or when the writer is closed.
+ * There shall be only one producer thread. Its cost for each write is the copy into the ring, unless the ring
+ * is full: in this case the producer waits for the background thread to release space (data are never dropped).
+ *<p>
+ * Data can be written to a stdio stream, or through an OutputWriter. In both cases each batch is flushed to the file.
+ *<p>
+ * Write errors are detected by the background thread. After an error, write returns false and data are ignored.
+ */
+class AsyncWriter {
+public:
+	AsyncWriter();
+	~AsyncWriter();
+	bool open(FILE* outFile, size_t capacity = 1048576, int flushPeriod = 500);
+	bool open(OutputWriter* writer, size_t capacity = 1048576, int flushPeriod = 500);
+	bool write(const void* data, size_t len);
+	bool close();
+	bool failed();
+	uint64_t bytesWritten();
+	uint64_t batches();
+	uint64_t producerWaits();
+private:
+	FILE* outFile;				//the file where data are written, if not written through an OutputWriter
+	OutputWriter* writer;		//the writer of the file, if data are written through it
+	unsigned char* ring;		//the ring buffer
+	size_t capacity;			//the ring buffer size in bytes
+	int flushPeriod;			//the maximum time in milliseconds data can stay in the ring
+	atomic<uint64_t> head;		//total bytes put into the ring by the producer
+	atomic<uint64_t> tail;		//total bytes taken from the ring by the writer thread
+	atomic<bool> error;			//true after a write error
+	atomic<uint64_t> nBatches;	//number of batches written
+	uint64_t nWaits;			//times the producer waited for space in the ring
+	bool stopping;				//true when the writer is closing
+	mutex mtx;					//to wait for data or space
+	condition_variable dataCv;
+	condition_variable spaceCv;
+	thread writerThread;
+	bool start(FILE* outFile, OutputWriter* writer, size_t capacity, int flushPeriod);
+	void run();
+	AsyncWriter(const AsyncWriter&);			//not copyable
+	AsyncWriter& operator=(const AsyncWriter&);
+};
+#endif
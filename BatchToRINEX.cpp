@@ -0,0 +1,353 @@
+/** @file BatchToRINEX.cpp
+ * Contains the command line program to convert into OSP, RINEX and RTK files all the GP2, PKT and OSP files
+ * of a campaign, running the conversion commands in parallel.
+ *<p>Usage:
+ *<p>BatchToRINEX {options} [INDIR]
+ *<p>Options are:
+ *	- -b BINDIR or --bindir=BINDIR : Directory where the conversion commands are. Default value BINDIR = .
+ *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -o OUTDIR or --outdir=OUTDIR : Directory where conversion outputs are placed. Default value OUTDIR = .
+ *	- -r RNXOPT or --rinexopt=RNXOPT : Options to pass to OSPtoRINEX (blank separated). Default value RNXOPT = -n
+ *	- -w WORKERS or --workers=WORKERS : Number of conversions running at the same time (0 = number of cores). Default value WORKERS = 0
+ *Default value for operator is: . (the current directory)
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+#include "Utilities.h"
+//from this project
+#include "ConversionChain.h"
+//standard and Linux
+#include <stdio.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+//@cond DUMMY
+///The command line format
+const string CMDLINE = "BatchToRINEX {options} [INDIR]";
+///The current program version
+const string MYVER = " V1.0";
+///The parser object to store options and operators passed in the command line
+ArgParser parser;
+//Metavariables for options
+int BINDIR, HELP, LOGLEVEL, OUTDIR, RNXOPT, WORKERS;
+//Metavariables for operators
+int INDIR;
+
+///A task of the campaign: a conversion stage to run for a given input file
+struct Task {
+	int file;			//index of the input file in the campaign file list
+	ConvStage stage;	//the stage to run
+	long long size;		//the input file size, used as estimation of the task work
+
+	Task(int f, ConvStage st, long long sz) {
+		file = f;
+		stage = st;
+		size = sz;
+	}
+	bool operator<(const Task& other) const {return size > other.size;}	//largest first
+};
+///The deque of tasks of a worker. The owner and thieves take tasks from the front, where the largest ones are
+struct WorkQueue {
+	mutex mtx;
+	deque<Task> tasks;
+};
+///Statistics of a conversion stage
+struct StageStats {
+	int nTasks;
+	int nFailed;
+	double busy;	//seconds
+};
+//the campaign data
+vector<string> files;
+vector<WorkQueue*> queues;
+atomic<int> pendingTasks(0);	//tasks queued or running, including dependent tasks not yet queued
+mutex idleMtx;
+condition_variable idleCv;
+StageStats stats[NSTAGES];
+mutex statsMtx;
+vector<bool> busyFiles;		//files having a task running, as tasks of a file share its working directory and log
+mutex busyMtx;
+mutex logMtx;
+//functions in this file
+void listInputs(string dir);
+void pushTask(int wk, Task task);
+bool takeTask(int wk, Task& task);
+int availableTask(WorkQueue& queue);
+void worker(int wk, ConversionChain* chain, Logger* plog);
+//@endcond
+
+/**main
+ * gets the command line arguments, set parameters accordingly and converts all the campaign files in the input directory.
+ *<p>
+ * For each GP2, PKT or OSP file in the input directory a set of tasks is built: the translation to OSP (GP2toOSP or
+ * PacketToOSP, not needed for OSP files), followed by two independent tasks, the generation of RINEX files (OSPtoRINEX)
+ * and the generation of the RTK file (OSPtoRTK), which are queued when the translation to OSP ends.
+ *<p>
+ * Tasks are run by a pool of workers, each one with its own task queue. Initial tasks are dealt to the queues
+ * largest input first. Each worker takes the largest task in its queue; when it is empty, it steals the largest task
+ * queued by other workers. Tasks queued when a translation ends are placed in the queue of the worker that performed it,
+ * in order of size. This way tasks of different files and stages run overlapped, and the big files, which
+ * determine the campaign duration, start as soon as possible. The tasks of a file run one after the other, as they
+ * share the working directory of the file and its log: a task of a file with another task running is left queued
+ * until it ends.
+ *<p>
+ * At the end, a summary with the tasks run, failed and the time used per stage, and the workers utilization is
+ * printed to the standard output and the log file.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning:
+ *		- (0) no errors have been detected
+ *		- (1) an error has been detected in arguments
+ *		- (2) error when reading the input directory, it has no files to convert, or outputs cannot be created
+ *		- (3) some conversion task has failed
+ */
+int main(int argc, char** argv) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	WORKERS = parser.addOption("-w", "--workers", "WORKERS", "Number of conversions running at the same time (0 = number of cores)", "0");
+	RNXOPT = parser.addOption("-r", "--rinexopt", "RNXOPT", "Options to pass to OSPtoRINEX (blank separated)", "-n");
+	OUTDIR = parser.addOption("-o", "--outdir", "OUTDIR", "Directory where conversion outputs are placed", ".");
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	BINDIR = parser.addOption("-b", "--bindir", "BINDIR", "Directory where the conversion commands are", ".");
+	/// 3- Setups the default values for operators in the command line
+	INDIR = parser.addOperator(".");
+	/// 4- Parses arguments in the command line extracting options and operators
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	log.info(parser.showOpeValues());
+	if (parser.getBoolOpt(HELP)) {
+		//help info has been requested
+		parser.usage("Converts to OSP, RINEX and RTK all GP2, PKT and OSP files in a directory, running conversions in parallel", CMDLINE);
+		return 0;
+	}
+	/// 5- Sets logging level stated in option
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	int nWorkers = stoi(parser.getStrOpt(WORKERS));
+	if (nWorkers <= 0) nWorkers = (int) thread::hardware_concurrency();
+	if (nWorkers <= 0) nWorkers = 1;
+	/// 6- Lists the campaign files and builds the initial tasks, sorted largest first
+	listInputs(parser.getOperator(INDIR));
+	if (files.empty()) {
+		log.severe("No GP2, PKT or OSP files to convert in " + parser.getOperator(INDIR));
+		return 2;
+	}
+	vector<Task> initial;
+	for (int i = 0; i < (int) files.size(); i++) {
+		struct stat st;
+		long long size = stat(files[i].c_str(), &st) == 0? (long long) st.st_size : 0;
+		ConvStage stage = ConversionChain::firstStage(files[i]);
+		if (stage == OSP_RINEX) {
+			initial.push_back(Task(i, OSP_RINEX, size));
+			initial.push_back(Task(i, OSP_RTK, size));
+			pendingTasks += 2;
+		} else {
+			initial.push_back(Task(i, stage, size));
+			pendingTasks += 3;
+		}
+	}
+	stable_sort(initial.begin(), initial.end());
+	/// 7- Deals the initial tasks to the worker queues, and runs workers until all tasks end
+	for (int i = 0; i < nWorkers; i++) queues.push_back(new WorkQueue());
+	busyFiles.assign(files.size(), false);
+	for (size_t i = 0; i < initial.size(); i++) queues[i % nWorkers]->tasks.push_back(initial[i]);
+	log.info("Files to convert: " + to_string((long long) files.size()) + ". Workers: " + to_string((long long) nWorkers));
+	ConversionChain chain(parser.getStrOpt(BINDIR), parser.getStrOpt(OUTDIR), getTokens(parser.getStrOpt(RNXOPT), ' '));
+	for (size_t i = 0; i < files.size(); i++) {
+		if (!chain.prepare(files[i])) {
+			log.severe("Cannot create working directory for " + files[i]);
+			return 2;
+		}
+	}
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	vector<thread> pool;
+	for (int i = 0; i < nWorkers; i++) pool.push_back(thread(worker, i, &chain, &log));
+	for (size_t i = 0; i < pool.size(); i++) pool[i].join();
+	double wall = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	/// 8- Prints the summary of stages and workers utilization
+	char textBuf[200];
+	double totalBusy = 0.0;
+	int totalFailed = 0;
+	printf("%-12s %6s %6s %10s %6s\n", "Stage", "Tasks", "Failed", "Busy(s)", "Util%");
+	for (int i = 0; i < NSTAGES; i++) {
+		if (stats[i].nTasks == 0) continue;
+		sprintf(textBuf, "%-12s %6d %6d %10.1f %6.1f", ConversionChain::stageName((ConvStage) i).c_str(),
+			stats[i].nTasks, stats[i].nFailed, stats[i].busy, 100.0 * stats[i].busy / (wall * nWorkers));
+		printf("%s\n", textBuf);
+		log.info(string(textBuf));
+		totalBusy += stats[i].busy;
+		totalFailed += stats[i].nFailed;
+	}
+	sprintf(textBuf, "Campaign time %.1fs; work %.1fs; ideal (work/workers) %.1fs; workers utilization %.1f%%",
+		wall, totalBusy, totalBusy / nWorkers, 100.0 * totalBusy / (wall * nWorkers));
+	printf("%s\n", textBuf);
+	log.info(string(textBuf));
+	for (size_t i = 0; i < queues.size(); i++) delete queues[i];
+	return totalFailed == 0? 0 : 3;
+}
+
+//@cond DUMMY
+/**listInputs
+ * fills the campaign file list with the GP2, PKT and OSP files in the given directory.
+ *
+ *@param dir the input directory
+ */
+void listInputs(string dir) {
+	DIR* dp = opendir(dir.c_str());
+	if (dp == NULL) return;
+	struct dirent* de;
+	while ((de = readdir(dp)) != NULL) {
+		string path = dir + "/" + string(de->d_name);
+		struct stat st;
+		if ((stat(path.c_str(), &st) == 0) && S_ISREG(st.st_mode) && (ConversionChain::firstStage(path) != NSTAGES))
+			files.push_back(path);
+	}
+	closedir(dp);
+}
+
+/**pushTask
+ * places a task in the queue of the given worker keeping the queue sorted largest first.
+ *
+ *@param wk the worker index
+ *@param task the task to queue
+ */
+void pushTask(int wk, Task task) {
+	{
+		lock_guard<mutex> lock(queues[wk]->mtx);
+		deque<Task>& q = queues[wk]->tasks;
+		q.insert(upper_bound(q.begin(), q.end(), task), task);
+	}
+	idleCv.notify_all();
+}
+
+/**takeTask
+ * takes the largest task available (of a file without other task running) from the queue of the given worker or, if
+ * there is none, steals the largest one available from the queues of other workers. The file of the task taken is
+ * marked busy.
+ *
+ *@param wk the worker index
+ *@param task where the task taken is placed
+ *@return true if a task has been taken, false if there are no tasks available
+ */
+bool takeTask(int wk, Task& task) {
+	//look for the largest task available in the own queue or, if none, in the queue of a victim
+	int victim = -1;
+	long long largest = -1;
+	for (int n = 0; n < (int) queues.size(); n++) {
+		int i = (wk + n) % (int) queues.size();
+		lock_guard<mutex> lock(queues[i]->mtx);
+		lock_guard<mutex> busyLock(busyMtx);
+		int pos = availableTask(*queues[i]);
+		if (pos >= 0 && queues[i]->tasks[pos].size > largest) {
+			largest = queues[i]->tasks[pos].size;
+			victim = i;
+			if (i == wk) break;
+		}
+	}
+	if (victim < 0) return false;
+	lock_guard<mutex> lock(queues[victim]->mtx);
+	lock_guard<mutex> busyLock(busyMtx);
+	int pos = availableTask(*queues[victim]);
+	if (pos < 0) return false;	//another worker was faster; caller will retry
+	task = queues[victim]->tasks[pos];
+	queues[victim]->tasks.erase(queues[victim]->tasks.begin() + pos);
+	busyFiles[task.file] = true;
+	return true;
+}
+
+/**availableTask
+ * gives the position in the given queue of the largest task of a file without other task running.
+ * The caller shall hold the queue mutex and busyMtx.
+ *
+ *@param queue the worker queue
+ *@return the position of the task, or -1 if there is none
+ */
+int availableTask(WorkQueue& queue) {
+	for (size_t i = 0; i < queue.tasks.size(); i++)
+		if (!busyFiles[queue.tasks[i].file]) return (int) i;
+	return -1;
+}
+
+/**worker
+ * runs tasks until all campaign tasks end. When a translation to OSP ends, the RINEX and RTK tasks of the file are queued.
+ * When a task ends, its file is released, so other tasks of the file can be taken.
+ *
+ *@param wk the worker index
+ *@param chain the conversion chain used to run tasks
+ *@param plog the pointer to the logger
+ */
+void worker(int wk, ConversionChain* chain, Logger* plog) {
+	Task task(0, NSTAGES, 0);
+	while (pendingTasks > 0) {
+		if (!takeTask(wk, task)) {
+			//nothing to do now: wait for new tasks queued when a translation ends
+			unique_lock<mutex> lock(idleMtx);
+			idleCv.wait_for(lock, chrono::milliseconds(100));
+			continue;
+		}
+		string inFile = files[task.file];
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		int result = chain->runStage(task.stage, inFile);
+		double busy = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		{
+			lock_guard<mutex> lock(busyMtx);
+			busyFiles[task.file] = false;
+		}
+		{
+			lock_guard<mutex> lock(statsMtx);
+			stats[task.stage].nTasks++;
+			stats[task.stage].busy += busy;
+			if (result != 0) stats[task.stage].nFailed++;
+		}
+		if ((task.stage == GP2_OSP) || (task.stage == PKT_OSP)) {
+			if (result == 0) {
+				pushTask(wk, Task(task.file, OSP_RINEX, task.size));
+				pushTask(wk, Task(task.file, OSP_RTK, task.size));
+			} else pendingTasks -= 2;	//dependent tasks will not run
+		}
+		{
+			lock_guard<mutex> lock(logMtx);
+			if (result == 0) plog->fine(ConversionChain::stageName(task.stage) + " OK for " + inFile);
+			else plog->warning(ConversionChain::stageName(task.stage) + " failed for " + inFile + ". Exit status " + to_string((long long) result));
+		}
+		--pendingTasks;
+		idleCv.notify_all();	//wakes waiting workers: all tasks ended, or the file tasks can be taken now
+	}
+}
+//@endcond
@@ -0,0 +1,222 @@
+/** @file ConversionChain.cpp
+ * Contains the implementation of the ConversionChain class used to run OSPtools commands as child processes.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#include "ConversionChain.h"
+#include "FileList.h"
+
+#include <errno.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+/**ConversionChain
+ * constructs a ConversionChain object.
+ *
+ *@param binDir the directory where the OSPtools commands (GP2toOSP, PacketToOSP, OSPtoRINEX, OSPtoRTK) are located
+ *@param outDir the directory where the working directories for each input file will be created
+ *@param rinexOpts the additional options to be passed to OSPtoRINEX (i.e. -n to generate navigation files)
+ */
+ConversionChain::ConversionChain(string binDir, string outDir, vector<string> rinexOpts) {
+	//commands are executed in the working directories: paths shall be absolute
+	char absPath[PATH_MAX];
+	this->binDir = realpath(binDir.c_str(), absPath) == NULL? binDir : string(absPath);
+	this->outDir = realpath(outDir.c_str(), absPath) == NULL? outDir : string(absPath);
+	this->rinexOpts = rinexOpts;
+}
+
+/**firstStage
+ * identifies from the file name extension (GP2, PKT or OSP, case insensitive) the first conversion stage to apply.
+ *
+ *@param fileName the name of the input file
+ *@return the first stage to apply, or NSTAGES if the file is not a convertible one
+ */
+ConvStage ConversionChain::firstStage(string fileName) {
+	string ext = FileList::upperExt(fileName);
+	if (ext.compare("GP2") == 0) return GP2_OSP;
+	if (ext.compare("PKT") == 0) return PKT_OSP;
+	if (ext.compare("OSP") == 0) return OSP_RINEX;
+	return NSTAGES;
+}
+
+/**stageName
+ * gives a readable name of the conversion stage (the name of the command that performs it).
+ *
+ *@param stage the conversion stage
+ *@return the name of the stage
+ */
+string ConversionChain::stageName(ConvStage stage) {
+	switch (stage) {
+	case GP2_OSP: return "GP2toOSP";
+	case PKT_OSP: return "PacketToOSP";
+	case OSP_RINEX: return "OSPtoRINEX";
+	case OSP_RTK: return "OSPtoRTK";
+	default: return "UNKNOWN";
+	}
+}
+
+/**workDir
+ * gives the working directory where the outputs of the conversion of the given input file are placed.
+ * Same named files from different directories shall not share it, so its name includes a tag of the input directory.
+ *
+ *@param inFile the input file name
+ *@return the working directory name: the output directory plus the input file name, with dots replaced by underscores,
+ * and the tag of the input directory
+ */
+string ConversionChain::workDir(string inFile) {
+	string dirName = baseName(inFile);
+	for (size_t i = 0; i < dirName.size(); i++) if (dirName[i] == '.') dirName[i] = '_';
+	return outDir + "/" + dirName + "_" + dirTag(inFile);
+}
+
+/**ospFile
+ * gives the name of the OSP file used as input for the RINEX and RTK stages.
+ *
+ *@param inFile the input file name
+ *@return the OSP file name, placed in the working directory of the input file
+ */
+string ConversionChain::ospFile(string inFile) {
+	string name = baseName(inFile);
+	size_t dot = name.rfind('.');
+	if (dot != string::npos) name = name.substr(0, dot);
+	return workDir(inFile) + "/" + name + ".OSP";
+}
+
+/**prepare
+ * creates the working directory of the given input file. When the input is already an OSP file it is linked into
+ * the working directory, so as the RINEX and RTK outputs are placed there and the input is not modified.
+ *
+ *@param inFile the input file name
+ *@return true if the working directory is ready, false otherwise
+ */
+bool ConversionChain::prepare(string inFile) {
+	string dir = workDir(inFile);
+	if ((mkdir(dir.c_str(), 0775) != 0) && (errno != EEXIST)) return false;
+	if (firstStage(inFile) != OSP_RINEX) return true;
+	string osp = ospFile(inFile);
+	unlink(osp.c_str());
+	if (link(inFile.c_str(), osp.c_str()) == 0) return true;
+	//when input and output are in different file systems hard links are not possible: use a symbolic one
+	char absPath[PATH_MAX];
+	if (realpath(inFile.c_str(), absPath) == NULL) return false;
+	return symlink(absPath, osp.c_str()) == 0;
+}
+
+/**runStage
+ * runs the command for the given stage of the conversion of the given input file, and waits for its end.
+ *
+ *@param stage the stage to run
+ *@param inFile the input file name
+ *@return the exit status of the command, or -1 if it cannot be launched or it has been terminated by a signal
+ */
+int ConversionChain::runStage(ConvStage stage, string inFile) {
+	vector<string> args(1, stageName(stage));
+	char absPath[PATH_MAX];
+	string input = inFile;
+	if (realpath(inFile.c_str(), absPath) != NULL) input = string(absPath);
+	switch (stage) {
+	case GP2_OSP:
+		args.push_back("-i");
+		args.push_back(input);
+		args.push_back("-o");
+		args.push_back(ospFile(inFile));
+		//a time window covering any GP2 time tag, instead of the GP2toOSP default dates
+		args.push_back("-d");
+		args.push_back("01/01/1980");
+		args.push_back("-D");
+		args.push_back("31/12/2099");
+		break;
+	case PKT_OSP:
+		args.push_back("-f");
+		args.push_back(ospFile(inFile));
+		args.push_back(input);
+		break;
+	case OSP_RINEX:
+		args.insert(args.end(), rinexOpts.begin(), rinexOpts.end());
+		args.push_back(ospFile(inFile));
+		break;
+	case OSP_RTK:
+		args.push_back(ospFile(inFile));
+		break;
+	default:
+		return -1;
+	}
+	return runTool(args, workDir(inFile));
+}
+
+//@cond DUMMY
+/**runTool
+ * forks a child process that changes to the given directory and executes the given command.
+ * The argument vector is built before forking, as only async-signal-safe calls are allowed in the child
+ * of a multithreaded process.
+ *
+ *@param args the command name and its arguments
+ *@param dir the directory where the command will be executed
+ *@return the exit status of the command, or -1 if it cannot be launched or it has been terminated by a signal
+ */
+int ConversionChain::runTool(vector<string> args, string dir) {
+	string cmdPath = binDir + "/" + args[0];
+	vector<char*> argv;
+	for (size_t i = 0; i < args.size(); i++) argv.push_back((char*) args[i].c_str());
+	argv.push_back(NULL);
+	pid_t pid = fork();
+	if (pid < 0) return -1;
+	if (pid == 0) {
+		//the command shall not inherit signals blocked by the caller
+		sigset_t noSignals;
+		sigemptyset(&noSignals);
+		sigprocmask(SIG_SETMASK, &noSignals, NULL);
+		if (chdir(dir.c_str()) == 0) execv(cmdPath.c_str(), &argv[0]);
+		_exit(127);
+	}
+	int status;
+	while (waitpid(pid, &status, 0) < 0) {
+		if (errno != EINTR) return -1;
+	}
+	if (WIFEXITED(status)) return WEXITSTATUS(status);
+	return -1;
+}
+
+/**baseName
+ * gives the file name without the directory part.
+ */
+string ConversionChain::baseName(string path) {
+	size_t slash = path.rfind('/');
+	return slash == string::npos? path : path.substr(slash + 1);
+}
+
+/**dirTag
+ * gives a tag identifying the directory of the given file: the 32 bits FNV-1a hash of its absolute path, in hexadecimal.
+ */
+string ConversionChain::dirTag(string path) {
+	size_t slash = path.rfind('/');
+	string dir = slash == string::npos? "." : path.substr(0, slash + 1);
+	char absPath[PATH_MAX];
+	if (realpath(dir.c_str(), absPath) != NULL) dir = string(absPath);
+	uint32_t h = 2166136261u;
+	for (size_t i = 0; i < dir.size(); i++) h = (h ^ (unsigned char) dir[i]) * 16777619u;
+	char tag[9];
+	snprintf(tag, sizeof tag, "%08x", h);
+	return string(tag);
+}
+//@endcond
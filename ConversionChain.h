@@ -0,0 +1,57 @@
+/** @file ConversionChain.h
+ * Contains the definitions used to run the chain of OSPtools commands that converts a receiver data file
+ * (GP2, PKT or OSP) into OSP, RINEX and RTK files.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef CONVERSIONCHAIN_H
+#define CONVERSIONCHAIN_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**ConvStage identifies each step of the conversion chain.
+ * Input files are first translated to OSP (when they are GP2 or PKT files) and then the OSP file is converted
+ * to RINEX and to RTK. The RINEX and RTK stages do not depend one on the other.
+ */
+enum ConvStage {GP2_OSP = 0, PKT_OSP, OSP_RINEX, OSP_RTK, NSTAGES};
+
+/**ConversionChain defines the data and methods needed to launch the OSPtools commands as child processes.
+ * Each input file is converted in its own working directory, placed in the output directory and named after the input
+ * file and its directory. This way the outputs of different files never collide (i.e. RINEX file names), even for same
+ * named files in different directories, and each one has its own LogFile.txt.
+ * The output directory shall exist when the object is constructed.
+ */
+class ConversionChain {
+public:
+	ConversionChain(string binDir, string outDir, vector<string> rinexOpts);
+	static ConvStage firstStage(string fileName);
+	static string stageName(ConvStage stage);
+	string workDir(string inFile);
+	string ospFile(string inFile);
+	bool prepare(string inFile);
+	int runStage(ConvStage stage, string inFile);
+private:
+	string binDir;				//directory where the OSPtools commands are
+	string outDir;				//directory where working directories will be created
+	vector<string> rinexOpts;	//additional options to pass to OSPtoRINEX
+	static string baseName(string path);
+	static string dirTag(string path);
+	int runTool(vector<string> args, string dir);
+};
+#endif
@@ -0,0 +1,61 @@
+/** @file FileList.cpp
+ * Contains the implementation of the FileList class.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#include "FileList.h"
+
+#include <ctype.h>
+#include <dirent.h>
+#include <sys/stat.h>
+
+/**upperExt
+ * gives the extension of the given file name in upper case.
+ *
+ *@param path the file name, with or without directory part
+ *@return the extension (text after the last dot in the name) in upper case, or empty if the name has no extension
+ */
+string FileList::upperExt(string path) {
+	size_t slash = path.find_last_of("/\\");
+	string name = slash == string::npos? path : path.substr(slash + 1);
+	size_t dot = name.rfind('.');
+	if (dot == string::npos) return string();
+	string ext = name.substr(dot + 1);
+	for (size_t i = 0; i < ext.size(); i++) ext[i] = toupper(ext[i]);
+	return ext;
+}
+
+/**listDir
+ * adds to the given list the regular files in the given directory having the given extension.
+ *
+ *@param dir the directory
+ *@param ext the extension, in upper case (i.e. "OSP")
+ *@param files the list where the paths of files found are added
+ *@return true if the directory has been read, false otherwise
+ */
+bool FileList::listDir(string dir, string ext, vector<string>& files) {
+	DIR* dp = opendir(dir.c_str());
+	if (dp == NULL) return false;
+	struct dirent* de;
+	struct stat st;
+	while ((de = readdir(dp)) != NULL) {
+		string path = dir + "/" + de->d_name;
+		if ((upperExt(de->d_name).compare(ext) == 0) && (stat(path.c_str(), &st) == 0) && S_ISREG(st.st_mode))
+			files.push_back(path);
+	}
+	closedir(dp);
+	return true;
+}
@@ -0,0 +1,35 @@
+/** @file FileList.h
+ * Contains the definition of the FileList class, used by the tools to select input files by their type.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef FILELIST_H
+#define FILELIST_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**FileList contains methods to select files by their type, given by the file name extension in any case (i.e. "OSP",
+ * "osp" or "Osp" are the same type).
+ */
+class FileList {
+public:
+	static string upperExt(string path);
+	static bool listDir(string dir, string ext, vector<string>& files);
+};
+#endif
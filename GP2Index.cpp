@@ -0,0 +1,261 @@
+/** @file GP2Index.cpp
+ * Contains the implementation of the GP2Index class.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#include "GP2Index.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <ctype.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <algorithm>
+
+//@cond DUMMY
+//the sidecar file identification and format version
+static const char MAGIC[8] = {'G', 'P', '2', 'I', 'D', 'X', '0', '1'};
+//the size of the buffers used to read the GP2 file
+static const size_t LINESIZE = 8192;
+static const size_t IOBUFSIZE = 1048576;
+//@endcond
+
+/**Header is the first part of the sidecar file
+ */
+struct GP2Index::Header {
+	char magic[8];			//the MAGIC identification
+	uint64_t fileSize;		//size of the GP2 file indexed
+	int64_t mtime;			//modification time of the GP2 file indexed
+	uint64_t lines;			//number of lines in the GP2 file
+	uint32_t nEntries;		//number of minutes
+	uint32_t monotonic;		//1 if time tags never decrease, 0 otherwise
+};
+
+/**GP2Index
+ * constructs an empty index: offsets given cover the whole file.
+ */
+GP2Index::GP2Index() {
+	fileSize = 0;
+	nLines = 0;
+	monotonic = false;
+}
+
+/**open
+ * loads the index of the given GP2 file from its sidecar. If the sidecar does not exist, or it does not match the
+ * size and modification time of the GP2 file, the index is built and the sidecar saved.
+ *
+ *@param gp2File the GP2 file name
+ *@param plog a pointer to the Logger
+ *@return true if the index is available, false if the GP2 file cannot be read
+ */
+bool GP2Index::open(string gp2File, Logger* plog) {
+	struct stat st;
+	if (stat(gp2File.c_str(), &st) != 0) return false;
+	string idxFile = gp2File + ".idx";
+	if (load(idxFile, (uint64_t) st.st_size, (int64_t) st.st_mtime)) {
+		plog->fine("Index loaded from " + idxFile);
+		return true;
+	}
+	plog->info("Building index " + idxFile);
+	if (!build(gp2File)) {
+		plog->warning("Cannot build index of " + gp2File);
+		return false;
+	}
+	if (!save(idxFile, (int64_t) st.st_mtime)) plog->warning("Cannot save index " + idxFile);
+	plog->info("Index built: " + to_string((long long) entries.size()) + " minutes, " + to_string((long long) nLines)
+		+ " lines" + (monotonic? "" : ". Time tags decrease: offsets not used"));
+	return true;
+}
+
+/**isMonotonic
+ * tells if time tags in the GP2 file never decrease, a condition needed to use offsets to read a time span.
+ *
+ *@return true if time tags never decrease, false otherwise
+ */
+bool GP2Index::isMonotonic() {
+	return monotonic;
+}
+
+/**minutes
+ * gives the number of minutes in the index.
+ *
+ *@return the number of minutes
+ */
+unsigned int GP2Index::minutes() {
+	return (unsigned int) entries.size();
+}
+
+/**lines
+ * gives the number of lines in the GP2 file.
+ *
+ *@return the number of lines
+ */
+uint64_t GP2Index::lines() {
+	return nLines;
+}
+
+/**startOffset
+ * gives the offset in the GP2 file of the first line of the first minute including or after the given time.
+ *
+ *@param from the start of the time span to read
+ *@return the offset, or 0 if time tags decrease in the file
+ */
+uint64_t GP2Index::startOffset(time_t from) {
+	if (!monotonic) return 0;
+	vector<Entry>::iterator it = lower_bound(entries.begin(), entries.end(), minuteKey(from),
+		[](const Entry& e, int64_t k) {return e.minute < k;});
+	return it == entries.end()? fileSize : it->offset;
+}
+
+/**endOffset
+ * gives the offset in the GP2 file of the first line of the first minute after the given time.
+ *
+ *@param to the end of the time span to read
+ *@return the offset, or the file size if time tags decrease in the file
+ */
+uint64_t GP2Index::endOffset(time_t to) {
+	if (!monotonic) return fileSize;
+	vector<Entry>::iterator it = upper_bound(entries.begin(), entries.end(), minuteKey(to),
+		[](int64_t k, const Entry& e) {return k < e.minute;});
+	return it == entries.end()? fileSize : it->offset;
+}
+
+/**minuteKey
+ * gives the identification of the minute including the given time, as a yyyymmddhhmm number in local time, like GP2
+ * time tags.
+ *
+ *@param t the time
+ *@return the minute identification
+ */
+int64_t GP2Index::minuteKey(time_t t) {
+	struct tm* tmt = localtime(&t);
+	if (tmt == NULL) return -1;
+	return ((((int64_t) (tmt->tm_year + 1900) * 100 + tmt->tm_mon + 1) * 100 + tmt->tm_mday) * 100 + tmt->tm_hour) * 100 + tmt->tm_min;
+}
+
+/**minuteKey
+ * gives the identification of the minute of the given GP2 time tag, as a yyyymmddhhmm number.
+ *
+ *@param timeTag the time tag at the start of a GP2 line: dd/mm/yyyy hh:mm...
+ *@return the minute identification, or -1 if the time tag is not valid
+ */
+int64_t GP2Index::minuteKey(const char* timeTag) {
+	static const int DIGITS[] = {0, 1, 3, 4, 6, 7, 8, 9, 11, 12, 14, 15};
+	for (int i = 0; i < 12; i++) if (!isdigit((unsigned char) timeTag[DIGITS[i]])) return -1;
+	if (timeTag[2] != '/' || timeTag[5] != '/' || timeTag[10] != ' ' || timeTag[13] != ':') return -1;
+	int64_t day = (timeTag[0] - '0') * 10 + timeTag[1] - '0';
+	int64_t month = (timeTag[3] - '0') * 10 + timeTag[4] - '0';
+	int64_t year = (((timeTag[6] - '0') * 10 + timeTag[7] - '0') * 10 + timeTag[8] - '0') * 10 + timeTag[9] - '0';
+	int64_t hour = (timeTag[11] - '0') * 10 + timeTag[12] - '0';
+	int64_t minute = (timeTag[14] - '0') * 10 + timeTag[15] - '0';
+	return (((year * 100 + month) * 100 + day) * 100 + hour) * 100 + minute;
+}
+
+//@cond DUMMY
+/**build
+ * builds the index reading all lines in the GP2 file.
+ *
+ *@param gp2File the GP2 file name
+ *@return true if built, false if the file cannot be read
+ */
+bool GP2Index::build(string gp2File) {
+	FILE* inFile = fopen(gp2File.c_str(), "rb");
+	if (inFile == NULL) return false;
+	setvbuf(inFile, NULL, _IOFBF, IOBUFSIZE);
+	entries.clear();
+	nLines = 0;
+	monotonic = true;
+	char line[LINESIZE];
+	uint64_t offset = 0;
+	bool lineStart = true;		//true if the text read starts a line
+	while (fgets(line, LINESIZE, inFile) != NULL) {
+		size_t len = strlen(line);
+		if (lineStart) {
+			nLines++;
+			int64_t key = len >= 16 ? minuteKey(line) : -1;
+			if (key >= 0 && (entries.empty() || key != entries.back().minute)) {
+				if (!entries.empty() && key < entries.back().minute) monotonic = false;
+				Entry e = {key, offset, 0, 0};
+				entries.push_back(e);
+			}
+			if (!entries.empty()) entries.back().lines++;
+		}
+		lineStart = len > 0 && line[len - 1] == '\n';
+		offset += len;
+	}
+	fclose(inFile);
+	fileSize = offset;
+	return true;
+}
+
+/**load
+ * loads the index from the sidecar file, if it matches the given size and modification time of the GP2 file.
+ *
+ *@param idxFile the sidecar file name
+ *@param size the current size of the GP2 file
+ *@param mtime the current modification time of the GP2 file
+ *@return true if loaded, false if it does not exist, is not valid, or does not match the GP2 file
+ */
+bool GP2Index::load(string idxFile, uint64_t size, int64_t mtime) {
+	FILE* f = fopen(idxFile.c_str(), "rb");
+	if (f == NULL) return false;
+	Header h;
+	bool ok = fread(&h, sizeof h, 1, f) == 1 && memcmp(h.magic, MAGIC, sizeof MAGIC) == 0
+		&& h.fileSize == size && h.mtime == mtime;
+	if (ok) {
+		entries.resize(h.nEntries);
+		ok = h.nEntries == 0 || fread(&entries[0], sizeof(Entry), h.nEntries, f) == h.nEntries;
+	}
+	fclose(f);
+	if (!ok) {
+		entries.clear();
+		return false;
+	}
+	fileSize = h.fileSize;
+	nLines = h.lines;
+	monotonic = h.monotonic != 0;
+	return true;
+}
+
+/**save
+ * saves the index into the sidecar file. It is written into a temporary file renamed when complete, so readers never
+ * find a partial index.
+ *
+ *@param idxFile the sidecar file name
+ *@param mtime the modification time of the GP2 file indexed
+ *@return true if saved, false otherwise
+ */
+bool GP2Index::save(string idxFile, int64_t mtime) {
+	string tmpFile = idxFile + ".tmp";
+	FILE* f = fopen(tmpFile.c_str(), "wb");
+	if (f == NULL) return false;
+	Header h;
+	memset(&h, 0, sizeof h);
+	memcpy(h.magic, MAGIC, sizeof MAGIC);
+	h.fileSize = fileSize;
+	h.mtime = mtime;
+	h.lines = nLines;
+	h.nEntries = (uint32_t) entries.size();
+	h.monotonic = monotonic ? 1 : 0;
+	bool ok = fwrite(&h, sizeof h, 1, f) == 1;
+	if (ok && !entries.empty()) ok = fwrite(&entries[0], sizeof(Entry), entries.size(), f) == entries.size();
+	ok = (fclose(f) == 0) && ok;
+	remove(idxFile.c_str());
+	if (ok && rename(tmpFile.c_str(), idxFile.c_str()) == 0) return true;
+	remove(tmpFile.c_str());
+	return false;
+}
+//@endcond
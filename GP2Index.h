@@ -0,0 +1,71 @@
+/** @file GP2Index.h
+ * Contains the definition of the GP2Index class, used to locate quickly the lines of a GP2 file by their time tag.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef GP2INDEX_H
+#define GP2INDEX_H
+
+#include <stdint.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+
+using namespace std;
+
+/**GP2Index defines data and methods to build, store and use the time tag index of a GP2 file.
+ *<p>
+ * The index contains, for each minute in the GP2 file time tags, the byte offset of its first line and its number of
+ * lines. Minutes are identified by their time tag as a yyyymmddhhmm number. The index is stored in a small sidecar
+ * file, named as the GP2 file with the ".idx" suffix, together with the size and modification time of the GP2 file
+ * when it was built.
+ *<p>
+ * When the index is opened, the sidecar is used if it matches the current size and modification time of the GP2 file.
+ * Otherwise the index is rebuilt in a single pass over the GP2 file and the sidecar is saved again.
+ *<p>
+ * Offsets can be used to read only the lines in a time span if time tags in the GP2 file never decrease. This
+ * condition is checked when building the index (see isMonotonic).
+ */
+class GP2Index {
+public:
+	GP2Index();
+	bool open(string gp2File, Logger* plog);
+	bool isMonotonic();
+	unsigned int minutes();
+	uint64_t lines();
+	uint64_t startOffset(time_t from);
+	uint64_t endOffset(time_t to);
+	static int64_t minuteKey(time_t t);
+	static int64_t minuteKey(const char* timeTag);
+private:
+	struct Header;
+	struct Entry {
+		int64_t minute;		//the minute, as yyyymmddhhmm
+		uint64_t offset;	//byte offset of its first line
+		uint32_t lines;		//number of lines
+		uint32_t reserved;
+	};
+	vector<Entry> entries;	//the minutes in the GP2 file, in file order
+	uint64_t fileSize;		//size of the GP2 file indexed
+	uint64_t nLines;		//number of lines in the GP2 file
+	bool monotonic;			//true if time tags never decrease
+	bool build(string gp2File);
+	bool load(string idxFile, uint64_t size, int64_t mtime);
+	bool save(string idxFile, int64_t mtime);
+};
+#endif
@@ -4,15 +4,23 @@
  *<p>Usage:
  *<p>GP2toOSP.exe {options}
  *<p>Options are:
+ *	- -C CACHE or --cache=CACHE : Directory of the conversion result cache (empty: no cache). Default value CACHE is empty
  *	- -D TODATE or --todate=TODATE : To date (dd/mm/aaaa). Default value TODATE = 31/12/2020
  *	- -d FROMDATE or --fromdate=FROMDATE : From date (dd/mm/aaaa). Default value FROMDATE = 01/01/2014
+ *	- -G or --timetags : Write with each output file a sidecar with the GP2 time tag and (n) field of each message. Default value TIMETAGS=FALSE
+ *	- -I or --index : Use the time tag index of the input file to read only the lines in the time windows, building it when missing or stale. Default value INDEX=FALSE
  *	- -i INFILE or --infile=INFILE : GP2 input file. Default value INFILE = SLCLog.GP2
  *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -K CATALOG or --catalog=CATALOG : Archive catalog file to record the output in (empty: no catalog). Not available on Windows. Default value CATALOG is empty
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
  *	- -o OUTFILE or --outfile=OUTFILE : OSP binary output file. Default value OUTFILE = DATA.OSP
+ *	- -S SPLIT or --split=SPLIT : Split outputs at local time boundaries of the time tags (HOUR, DAY, empty: no split). Default value SPLIT is empty
  *	- -T TOTIME or --totime=TOTIME : To time (hh:mm:sec). Default value TOTIME = 23:59:59
  *	- -t FROMTIME or --fromtime=FROMTIME : From time (hh:mm:sec). Default value FROMTIME = 00:00:00
+ *	- -W WINDOWS or --windows=WINDOWS : Named time windows, each one extracted to its own output file, instead of the single interval and output file (empty: not used). Default value WINDOWS is empty
  *	- -w WMSG or --wmsg=WMSG : Wanted messages MIDs (a comma separated list, ALL, RINEX,  or RINEX,list. Default value WMSG = RINEX
+ *	- -x TRACE or --trace=TRACE : Chrome trace-event file for the processing stages timeline (empty: no trace). Default value TRACE is empty
+ *	- -z WRITER or --writer=WRITER : Output writer settings: buffer size, preallocation extent size, DIRECT for direct I/O (a comma separated list, empty: defaults). Default value WRITER is empty
  *<p>
  *Copyright 2015, 2021 by Francisco Cancillo & Luis Cancillo
  *<p>
@@ -30,27 +38,48 @@
  *<p>V1.0	|2/2015	|First release
  *<p>V1.1	|2/2016	|Minor improvements for logging messages
  *<p>V1.2	|2/2016	|Reviewed to run on Linux
+ *<p>V1.3	|10/2026	|Added conversion result cache
+ *<p>				|Added processing stages trace
+ *<p>				|Added archive catalog update
+ *<p>				|Added multiple time windows
+ *<p>				|Added time tag index
+ *<p>				|Added hourly or daily output split
+ *<p>				|Added time tag sidecar
+ *<p>				|Added output writer with preallocation
  */
 
 #include <string.h>
 #include <time.h>
+#include <algorithm>
 
 //from CommonClasses
 #include "ArgParser.h"
 #include "Logger.h"
+//from this project
+#include "ResultCache.h"
+#include "TraceLog.h"
+#include "GP2Index.h"
+#include "TimeTagSidecar.h"
+#include "OutputWriter.h"
+#if !defined(_WIN32) && !defined(WIN32) && !defined(_WIN64) && !defined(WIN64)
+#include "ArchiveCatalog.h"
+#define ARCHIVECAT	///<archive catalog update is available
+#endif
 
 using namespace std;
 
 //@cond DUMMY
+///Program name
+const string THISPRG = "GP2toOSP";
 ///The command line format
-const string CMDLINE = "GP2toOSP.exe {options}";
+const string CMDLINE = THISPRG + ".exe {options}";
 ///The current program version
-const string MYVER = " V1.2";
+const string MYVER = " V1.3";
 //@cond DUMMY
 ///The parser object to store options and operators passed in the comman line
 ArgParser parser;
 //Metavariables for options
-int INFILE, OUTFILE, HELP, LOGLEVEL, FROMDATE, TODATE, FROMTIME, TOTIME, WMSG;
+int CACHE, CATALOG, INDEX, INFILE, OUTFILE, HELP, LOGLEVEL, FROMDATE, TODATE, FROMTIME, TOTIME, SPLIT, TIMETAGS, TRACE, WINDOWS, WMSG, WRITER;
 //Metavariables for operators
 //n/a
 //Constraints used in this program
@@ -61,17 +90,39 @@ int INFILE, OUTFILE, HELP, LOGLEVEL, FROMDATE, TODATE, FROMTIME, TOTIME, WMSG;
 #define START2 162	//0xA2	//sequence of two bytes with values START1, START2
 #define END1 176	//0XB0	//OSP messages from/to receiver are followed by the end
 #define END2 179	//0XB3	//sequence of two bytes with values END1, END2
+#define TTAGEXT ".ttag"		//the suffix added to an output file name to name its time tag sidecar
 //variables and objects
 char GP2line[GP2SIZE];			//a buffer for a line from the GP2 input file
 unsigned char OSPmsg[MSGSIZE];	//a buffer to place the output binary OSP message
 int OSPmsgSize = 0;				//current message size
 //the list of OSP messages useful to obtain RINEX data
 unsigned char WANTEDMsg[WMSGSIZE] = {2,6,7,56,8,11,12,15,28,50,64,75,0};
+///A time window: messages with time tag in [from, to] are extracted to its output file, or to the files of each period
+struct TimeWindow {
+	string outName;		//the output file name
+	time_t from;
+	time_t to;
+	OutputWriter* outFile;	//the writer of the output file
+	int64_t period;		//the period of the output file open, when outputs are split
+	vector<string> outputs;	//the output files created
+	TimeTagSidecar tags;	//the time tag sidecar of the output file open, when time tags are kept
+	int nMessages;		//messages written
+	bool operator<(const TimeWindow& w) const {return from < w.from;}
+};
+vector<TimeWindow> windows;	//the time windows, sorted by start time
+int64_t splitDivisor = 0;	//to get the period from a yyyymmddhhmm minute: 100 for hours, 10000 for days, 0 for no split
+bool timeTags = false;		//true if time tag sidecars are written
+///The conversion result cache
+ResultCache cache;
 //prototypes of functions defined in this module
-int extractMsgs(Logger*, FILE *, time_t, time_t, FILE *);
+int extractMsgs(Logger*, FILE *, long long);
+bool openTags(TimeWindow&, string, bool, Logger*);
+bool parseWindows(string, Logger*);
+void recordOutput(string, Logger*);
+bool selectPeriodFile(TimeWindow&, time_t, Logger*);
 bool wantedMsg(unsigned char);
 time_t dt2time (string);
-bool checkInterval(string, time_t, time_t);
+long utcOffset(time_t);
 void addWANTED(string);
 //@endcond 
 
@@ -104,6 +155,17 @@ void addWANTED(string);
  *   the number of bytes in the payload, and the computed payload checksum shall be equal to provided checksum. 
  * - Lines with time tag outside the time interval of validity are skipped. By default this interval is
  *   [01/01/2014 00:00:00 , 31/12/2020 23:59:59]. A different time interval can be defined using the related command options.
+ * - Alternatively, a list of named time windows can be given, each one with its own output file. All windows are
+ *   extracted in a single pass over the input file: lines whose time tag is in a window are written to its output file.
+ *   Each window is stated as "OUTFILE,dd/mm/yyyy hh:mm:ss,dd/mm/yyyy hh:mm:ss" and windows are separated by ";".
+ *   The list can be given in a file, one window per line, stating its name preceded by "@".
+ * - When the split of outputs is requested, messages of each window are written to a file for each local time hour or
+ *   day of their time tags, named after the window output file and the period start: name_yyyymmdd_hh.ext or name_yyyymmdd.ext.
+ * - When the index is used, only the lines from the first minute of the earliest window to the last minute of the
+ *   latest window are read, using the time tag index of the input file (see GP2Index). The index is built, or rebuilt
+ *   if the input file has changed, and saved in a sidecar file for the next conversions.
+ * - When time tags are kept, a sidecar file named as each output file with the ".ttag" suffix is written in the same pass,
+ *   containing for each message written, in the same order, the time tag and "(n)" field of its line (see TimeTagSidecar).
  * - Lines containing messages with MID not in the list of "wanted MIDs" are skipped.  By default this list includes the MID values 
  *   used to generate RINEX files (2,6,7,56,8,11,12,15,28,50,64,75). A different list can be defined using the related command options.
  *   Possibility exists to not filter messages (ALL MID wanted).
@@ -114,22 +176,35 @@ void addWANTED(string);
  *		- (0) no errors have been detected
  *		- (1) an error has been detected in arguments
  *		- (2) error when opening the input file
- *		- (3) error when creating output file
+ *		- (3) error when creating or writing output files
+ *<p>
+ * When a cache directory is given, the output of a previous conversion of the same input file with the same options
+ * is reused, if it exists in the cache. Otherwise the output generated is stored in the cache.
+ *<p>
+ * When an archive catalog is given, the output file is added to it (see OSPCatalog).
  */
 int main(int argc, char* argv[]) {
 	/**The main process sequence follows:*/
 	/// 1- Defines and sets the error logger object
 	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
 	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	WRITER = parser.addOption("-z", "--writer", "WRITER", "Output writer settings: buffer size, preallocation extent size, DIRECT for direct I/O (a comma separated list, empty: defaults)", "");
+	TRACE = parser.addOption("-x", "--trace", "TRACE", "Chrome trace-event file for the processing stages timeline (empty: no trace)", "");
 	WMSG = parser.addOption("-w", "--wmsg", "WMSG", "Wanted mesages MIDs (a comma separated list, ALL, RINEX,  or RINEX,list", "RINEX");
+	WINDOWS = parser.addOption("-W", "--windows", "WINDOWS", "Named time windows (OUTFILE,FROM,TO;... or @file), extracted to their own output files (empty: not used)", "");
 	FROMTIME = parser.addOption("-t", "--fromtime", "FROMTIME", "From time (hh:mm:sec)", "00:00:00");
 	TOTIME = parser.addOption("-T", "--totime", "TOTIME", "To time (hh:mm:sec)", "23:59:59");
+	SPLIT = parser.addOption("-S", "--split", "SPLIT", "Split outputs at local time boundaries of the time tags (HOUR, DAY, empty: no split)", "");
 	OUTFILE = parser.addOption("-o", "--outfile", "OUTFILE", "OSP binary output file", "DATA.OSP");
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
 	INFILE = parser.addOption("-i", "--infile", "INFILE", "GP2 input file", "SLCLog.GP2");
+	INDEX = parser.addOption("-I", "--index", "INDEX", "Use the time tag index of the input file, building it when missing or stale", false);
+	TIMETAGS = parser.addOption("-G", "--timetags", "TIMETAGS", "Write with each output file a sidecar with the GP2 time tag and (n) field of each message", false);
 	FROMDATE = parser.addOption("-d", "--fromdate", "FROMDATE", "From date (dd/mm/aaaa)", "01/01/2014");
 	TODATE = parser.addOption("-D", "--todate", "TODATE", "To date (dd/mm/aaaa)", "31/12/2020");
+	CACHE = parser.addOption("-C", "--cache", "CACHE", "Directory of the conversion result cache (empty: no cache)", "");
+	CATALOG = parser.addOption("-K", "--catalog", "CATALOG", "Archive catalog file to record the output in (empty: no catalog)", "");
 	/// 3- Parses arguments in the command line extracting options and operators
 	try {
 		parser.parseArgs(argc, argv);
@@ -157,62 +232,179 @@ int main(int argc, char* argv[]) {
 	if (WANTEDMsg[0] == 0) s += "ALL";
 	else for (int i=0; i<WMSGSIZE && WANTEDMsg[i] != 0; i++) s += " " + to_string((long long) WANTEDMsg[i]);
 	log.info(s);
-	/// 6- Sets start and end time of the time interval for messages wanted 
-	time_t startTime, endTime;
-	startTime = dt2time(parser.getStrOpt (FROMDATE) + " " + parser.getStrOpt (FROMTIME));
-	endTime = dt2time(parser.getStrOpt (TODATE) + " " + parser.getStrOpt (TOTIME));
-	if ((startTime < 0) || (endTime < 0) || (startTime > endTime)) {
-		log.severe("Incorrect From or To date or time option");
+	/// 6- Sets the time windows for messages wanted: the given list, or the interval from start to end time
+	if (parser.getStrOpt(WINDOWS).empty()) {
+		TimeWindow window;
+		window.outName = parser.getStrOpt(OUTFILE);
+		window.from = dt2time(parser.getStrOpt (FROMDATE) + " " + parser.getStrOpt (FROMTIME));
+		window.to = dt2time(parser.getStrOpt (TODATE) + " " + parser.getStrOpt (TOTIME));
+		if ((window.from < 0) || (window.to < 0) || (window.from > window.to)) {
+			log.severe("Incorrect From or To date or time option");
+			return 1;
+		}
+		windows.push_back(window);
+	} else if (!parseWindows(parser.getStrOpt(WINDOWS), &log)) return 1;
+	sort(windows.begin(), windows.end());
+	s = parser.getStrOpt(SPLIT);
+	if (s.compare("HOUR") == 0) splitDivisor = 100;
+	else if (s.compare("DAY") == 0) splitDivisor = 10000;
+	else if (!s.empty()) {
+		log.severe("Incorrect split period " + s);
 		return 1;
 	}
+	timeTags = parser.getBoolOpt(TIMETAGS);
+	if (!OutputWriter::configure(parser.getStrOpt(WRITER))) {
+		log.severe("Incorrect output writer settings " + parser.getStrOpt(WRITER));
+		return 1;
+	}
+	/// 7- If a result cache is used, reuses the outputs of a previous conversion with the same input and options
+	if (cache.open(parser.getStrOpt(CACHE), THISPRG + MYVER) && cache.addInput(parser.getStrOpt(INFILE))) {
+		cache.addOption("WMSG", parser.getStrOpt(WMSG));
+		string windowList;
+		for (vector<TimeWindow>::iterator it = windows.begin(); it != windows.end(); it++)
+			windowList += it->outName + "," + to_string((long long) it->from) + "," + to_string((long long) it->to) + ";";
+		cache.addOption("WINDOWS", windowList);
+		cache.addOption("SPLIT", parser.getStrOpt(SPLIT));
+		cache.addOption("TIMETAGS", timeTags? "TRUE" : "FALSE");
+		//window bounds and split periods are local time: the key includes the local time offsets at the start and end
+		time_t lastTo = windows.front().to;
+		for (vector<TimeWindow>::iterator it = windows.begin(); it != windows.end(); it++) lastTo = max(lastTo, it->to);
+		cache.addOption("TZ", to_string((long long) utcOffset(windows.front().from)) + "," + to_string((long long) utcOffset(lastTo)));
+		if (cache.restore(&log)) {
+			log.info("Output reused from cache entry " + cache.key());
+			for (vector<string>::const_iterator it = cache.outputFiles().begin(); it != cache.outputFiles().end(); it++) {
+				size_t ext = it->size() - min(it->size(), strlen(TTAGEXT));
+				if (it->compare(ext, string::npos, TTAGEXT) != 0) recordOutput(*it, &log);
+			}
+			return 0;
+		}
+		for (vector<TimeWindow>::iterator it = windows.begin(); it != windows.end(); it++) cache.release(it->outName);
+	}
 	FILE *inFile;
-	/// 7- Opens the SP2 input file
-	if ((inFile = fopen(parser.getStrOpt(INFILE).c_str(), "r")) == NULL) {
+	/// 8- Opens the SP2 input file. It is read in binary mode when the index is used, as index offsets are byte offsets
+	if ((inFile = fopen(parser.getStrOpt(INFILE).c_str(), parser.getBoolOpt(INDEX)? "rb" : "r")) == NULL) {
 		log.severe("Cannot open input file" + parser.getStrOpt(INFILE));
 		return 2;
 	}
-	/// 8- Creates the OSP binary output file
-	FILE *outFile;
-	if ((outFile = fopen(parser.getStrOpt(OUTFILE).c_str(), "wb")) == NULL) {
-		log.severe("Cannot create output file" + parser.getStrOpt(OUTFILE));
-		return 3;
+	/// 9- If the index is used, positions the input file at the first line to read and sets the bytes to read
+	long long toRead = -1;
+	GP2Index index;
+	if (parser.getBoolOpt(INDEX) && index.open(parser.getStrOpt(INFILE), &log) && index.isMonotonic()) {
+		uint64_t start = index.startOffset(windows.front().from);
+		uint64_t end = start;
+		for (vector<TimeWindow>::iterator it = windows.begin(); it != windows.end(); it++) end = max(end, index.endOffset(it->to));
+#if defined(_WIN32) || defined(WIN32) || defined(_WIN64) || defined(WIN64)
+		int sought = _fseeki64(inFile, (__int64) start, SEEK_SET);
+#else
+		int sought = fseeko(inFile, (off_t) start, SEEK_SET);
+#endif
+		if (sought == 0) {
+			toRead = (long long) (end - start);
+			log.info("Lines read using index: bytes " + to_string((long long) start) + " to " + to_string((long long) end));
+		} else rewind(inFile);
+	}
+	/// 10- Creates the OSP binary output file of each time window. When outputs are split, they are created when needed
+	for (vector<TimeWindow>::iterator it = windows.begin(); it != windows.end(); it++) {
+		it->nMessages = 0;
+		it->period = -1;
+		it->outFile = new OutputWriter();
+		if (splitDivisor != 0) continue;
+		if (!it->outFile->open(it->outName, "wb")) {
+			log.severe("Cannot create output file" + it->outName);
+			return 3;
+		}
+		it->outputs.push_back(it->outName);
+		if (!openTags(*it, it->outName, false, &log)) return 3;
 	}
-	/// 9- Extracts/verifies/filters line by line messages from the SP2 file and translate/write them into OSP format
-	int n = extractMsgs(&log, inFile, startTime, endTime, outFile);
+	/// 11- Extracts/verifies/filters line by line messages from the SP2 file and translate/write them into OSP format
+	TraceLog::open(parser.getStrOpt(TRACE));
+	int n = extractMsgs(&log, inFile, toRead);
 	log.info("End of data extraction. Messages extracted: " + to_string((long long) n));
 	fclose(inFile);
-	fclose(outFile);
+	bool written = n >= 0;		//if all outputs have been written completely
+	for (vector<TimeWindow>::iterator it = windows.begin(); it != windows.end(); it++) {
+		if (it->outFile->isOpen()) {
+			if (!it->outFile->close()) {
+				log.severe("Cannot write output file " + it->outName);
+				written = false;
+			}
+			log.info(it->outFile->report());
+		}
+		delete it->outFile;
+		if (it->tags.isOpen() && !it->tags.close()) {
+			log.severe("Cannot write time tag sidecar of " + it->outName);
+			written = false;
+		}
+		if (windows.size() > 1) log.info(it->outName + ": " + to_string((long long) it->nMessages) + " messages");
+		if (splitDivisor != 0) log.info(it->outName + " split into " + to_string((long long) it->outputs.size()) + " files");
+	}
+	if (TraceLog::close()) log.info("Processing trace written to " + parser.getStrOpt(TRACE));
+	/// 12- If all outputs have been written, stores them in the result cache, and records them in the archive catalog,
+	/// if used
+	if (!written) return 3;
+	for (vector<TimeWindow>::iterator it = windows.begin(); it != windows.end(); it++)
+		for (vector<string>::iterator ot = it->outputs.begin(); ot != it->outputs.end(); ot++) {
+			cache.addOutput(*ot);
+			if (timeTags) cache.addOutput(*ot + TTAGEXT);
+		}
+	cache.store(&log);
+	for (vector<TimeWindow>::iterator it = windows.begin(); it != windows.end(); it++)
+		for (vector<string>::iterator ot = it->outputs.begin(); ot != it->outputs.end(); ot++) recordOutput(*ot, &log);
 	return 0;
 }
 //@cond DUMMY
 /**extractMsgs
- * extracts OSP messages contained in a SLCog.gp2 input file and writes them into a OSP binary output file.
- * Only messages having a time tag included in the time interval [fromT, toT] are extracted.
+ * extracts OSP messages contained in a SLCog.gp2 input file and writes them into the OSP binary output files of the
+ * time windows.
+ * Only messages having a time tag included in a time window [from, to] are extracted, to the output file of each
+ * window including it.
  * Only messages having a "wanted" MID are extracted.
+ * As time tags in the input file grow, the windows are checked from a cursor pointing to the first window not ended at
+ * the time tag of the previous line. The cursor is moved back to the first window if a time tag lower than the
+ * previous one is found.
+ * When time tags are kept, the time tag and "(n)" field of each message written are added to the sidecar of the output
+ * file, so that sidecar records and output messages keep the same order.
  *
  * @param plog a pointer to the error logger
  * @param inFile the gp2 input file with GPS receiver messages
- * @param fromT defines the start of the time interval for messages to be extracted
- * @param toT defines the end of the time interval
- * @param outFile the output OSP file to place binary messages
+ * @param toRead the number of bytes to read from the current position, or -1 to read to the end of file
  * @return the number of OSP messages extracted
  */
-int extractMsgs(Logger* plog, FILE *inFile, time_t fromT, time_t toT, FILE *outFile) {
+int extractMsgs(Logger* plog, FILE *inFile, long long toRead) {
 	char *header, *tail;
 	unsigned int ui, payloadLen, computedCheck, messageCheck, nbytesRead;
 	string timeTag;
 	int nMessages = 0;
+	size_t cursor = 0;		//the first window not ended at the last time tag
+	time_t tag = -1;		//the time of the current line time tag
+	time_t lastTag = -1;	//the time of the previous line time tag
+	string lastTagSecs;		//the time tag of the previous line, to the seconds
+	uint64_t tr = TraceLog::mark();	//start time of the stage being traced
 
 	//read input file line by line: each line shall be an OSP message
-	while (fgets(GP2line, GP2SIZE, inFile) != NULL) {
+	while ((toRead != 0) && (fgets(GP2line, GP2SIZE, inFile) != NULL)) {
+		if (toRead > 0) toRead = max(0LL, toRead - (long long) strlen(GP2line));
+		tr = TraceLog::span(TR_READ, tr);
 		timeTag = string(GP2line, 23);
-		//check if line time tag is in the wanted time interval
-		if (!checkInterval(GP2line, fromT, toT)) {
+		//check if line time tag is in any wanted time window. Time tag conversion is reused for lines in the same second
+		if (timeTag.compare(0, 19, lastTagSecs) != 0) {
+			lastTagSecs = timeTag.substr(0, 19);
+			tag = dt2time(lastTagSecs);
+		}
+		if (tag < lastTag) cursor = 0;
+		lastTag = tag;
+		while (cursor < windows.size() && windows[cursor].to < tag) cursor++;
+		bool inInterval = false;
+		for (size_t i = cursor; !inInterval && i < windows.size() && windows[i].from <= tag; i++)
+			inInterval = tag != -1 && tag <= windows[i].to;
+		tr = TraceLog::span(TR_FILTER, tr);
+		if (!inInterval) {
 			plog->finest(timeTag + " Time tag outside interval");
 			continue;
 		}
 		header = strstr(GP2line, "A0 A2");	//find header
-		tail =  strstr(header+5, "B0 B3");	//find tail
+		tail = header==NULL? NULL : strstr(header+5, "B0 B3");	//find tail
+		tr = TraceLog::span(TR_FRAME, tr);
 		if (header==NULL || tail==NULL) {	//log this error
 			plog->warning(timeTag + " No message header or tailer");
 			continue;
@@ -246,6 +438,7 @@ int extractMsgs(Logger* plog, FILE *inFile, time_t fromT, time_t toT, FILE *outF
 			computedCheck &= 0x7FFF;
 		}
 		messageCheck = (OSPmsg[payloadLen+2] << 8) | OSPmsg[payloadLen+3];
+		tr = TraceLog::span(TR_DECODE, tr);
 		if (computedCheck != messageCheck) {
 			plog->warning(timeTag + " Wrong checksum");
 			continue;
@@ -253,8 +446,19 @@ int extractMsgs(Logger* plog, FILE *inFile, time_t fromT, time_t toT, FILE *outF
 		//check if message MID is in the list of wanted ones
 		if (wantedMsg(OSPmsg[2])) {
 			//printf("wt|");
-			//wanted, write it to the OSP output file
-			if (fwrite(OSPmsg, 1, payloadLen+2, outFile) == payloadLen+2) nMessages++;
+			//wanted, write it to the OSP output file of each window including it
+			bool written = true;
+			int64_t millis = timeTags? TimeTagSidecar::tagMillis(GP2line) : 0;
+			int32_t field = timeTags? TimeTagSidecar::tagField(GP2line) : 0;
+			for (size_t i = cursor; written && i < windows.size() && windows[i].from <= tag; i++) {
+				if (tag > windows[i].to) continue;
+				if ((splitDivisor != 0) && !selectPeriodFile(windows[i], tag, plog)) return -nMessages - 4;
+				written = windows[i].outFile->write(OSPmsg, payloadLen+2);
+				if (timeTags && written) written = windows[i].tags.add(millis, field);
+				if (written) windows[i].nMessages++;
+			}
+			tr = TraceLog::span(TR_WRITE, tr);
+			if (written) nMessages++;
 			else {
 				plog->severe("Cannot writte to binary output file");
 				return -nMessages - 4;
@@ -303,21 +507,150 @@ time_t dt2time (string dateAndTime) {
 	}
 	return -1;	//wrong date or time
 }
-/**checkInterval
- * checks if the time tag provided is in the given time interval  [fromT, toT].
+/**utcOffset
+ * gives the offset from UTC of the local time at the given time, as set by the TZ environment variable or the system.
  *
- *@param timeTag the time tag string of the current line
- *@param fromT the initial time of the interval
- *@param toT the final time of the interval
- *@return true if the line time tag is in the time interval [fromT, toT], false otherwyse
+ *@param t the time
+ *@return the local time offset in seconds
  **/
- bool checkInterval(string timeTag, time_t fromT, time_t toT) {
-	bool result = false;
-	time_t tag = dt2time(timeTag);
-	if (tag != -1) {
-		result = (fromT <= tag) && (tag <= toT);
+long utcOffset(time_t t) {
+	struct tm utc = *gmtime(&t);
+	utc.tm_isdst = -1;
+	return (long) difftime(t, mktime(&utc));
+}
+/**selectPeriodFile
+ * sets as output file of the given window the file of the period including the given time, when outputs are split.
+ * The file of the previous period is closed, and the file of the new period created, or reopened to append if it was
+ * created before, as it happens when time tags go back. The same applies to their time tag sidecars, when kept.
+ *
+ *@param window the time window
+ *@param tag the time tag of the message to write
+ *@param plog a pointer to the error logger
+ *@return true if the output file is available, false if it cannot be created or the previous one cannot be written
+ **/
+bool selectPeriodFile(TimeWindow& window, time_t tag, Logger* plog) {
+	int64_t period = GP2Index::minuteKey(tag) / splitDivisor;
+	if (period == window.period) return true;
+	if (window.outFile->isOpen()) {
+		bool closed = window.outFile->close();
+		plog->info(window.outFile->report());
+		if (!closed) {
+			plog->severe("Cannot write output file " + window.outName);
+			return false;
 		}
-	return result;
+	}
+	if (window.tags.isOpen() && !window.tags.close()) {
+		plog->severe("Cannot write time tag sidecar of " + window.outName);
+		return false;
+	}
+	window.period = period;
+	//name the file after the window output file and the period start
+	string periodTxt = splitDivisor == 100 ? to_string((long long) (period / 100)) + "_" + to_string((long long) (period % 100 / 10))
+		+ to_string((long long) (period % 10)) : to_string((long long) period);
+	size_t dot = window.outName.find_last_of('.');
+	size_t sep = window.outName.find_last_of("/\\");
+	if (dot == string::npos || (sep != string::npos && dot < sep)) dot = window.outName.size();
+	string name = window.outName.substr(0, dot) + "_" + periodTxt + window.outName.substr(dot);
+	bool created = find(window.outputs.begin(), window.outputs.end(), name) != window.outputs.end();
+	if (!created) cache.release(name);
+	if (!window.outFile->open(name, created? "ab" : "wb")) {
+		plog->severe("Cannot create output file" + name);
+		return false;
+	}
+	if (!created) {
+		window.outputs.push_back(name);
+		plog->fine("Output file " + name + " created");
+	}
+	return openTags(window, name, created, plog);
+}
+
+/**openTags
+ * opens the time tag sidecar of the given output file of a window, when time tags are kept.
+ *
+ *@param window the time window
+ *@param outName the output file name
+ *@param append true to append records to the sidecar written before for this output file, false to create it
+ *@param plog a pointer to the error logger
+ *@return true if the sidecar is open or time tags are not kept, false if it cannot be created
+ **/
+bool openTags(TimeWindow& window, string outName, bool append, Logger* plog) {
+	if (!timeTags) return true;
+	string name = outName + TTAGEXT;
+	if (!append) cache.release(name);
+	if (!window.tags.open(name, append)) {
+		plog->severe("Cannot create time tag sidecar " + name);
+		return false;
+	}
+	return true;
+}
+
+/**recordOutput
+ * records the given output file in the archive catalog, if used, together with its time tag sidecar, when kept.
+ *
+ *@param outName the output file name
+ *@param plog a pointer to the error logger
+ **/
+void recordOutput(string outName, Logger* plog) {
+#ifdef ARCHIVECAT
+	vector<string> sidecars;
+	if (timeTags) sidecars.push_back(outName + TTAGEXT);
+	ArchiveCatalog::record(parser.getStrOpt(CATALOG), outName, sidecars, plog);
+#endif
+}
+
+/**parseWindows
+ * adds to the list of time windows the ones given. Each window is stated as "OUTFILE,dd/mm/yyyy hh:mm:ss,dd/mm/yyyy hh:mm:ss"
+ * and windows are separated by ";". If the list starts with "@", windows are read from the file named after it, one
+ * per line. Empty lines and lines starting with "#" are ignored.
+ *
+ *@param windowList the list of windows, or the name of the file containing them preceded by "@"
+ *@param plog a pointer to the error logger
+ *@return true if all windows are correct and have different output files, false otherwise
+ **/
+bool parseWindows(string windowList, Logger* plog) {
+	vector<string> specs;
+	if (windowList[0] == '@') {
+		FILE* listFile = fopen(windowList.substr(1).c_str(), "r");
+		if (listFile == NULL) {
+			plog->severe("Cannot open time windows file " + windowList.substr(1));
+			return false;
+		}
+		char line[512];
+		while (fgets(line, sizeof line, listFile) != NULL) {
+			line[strcspn(line, "\r\n")] = 0;
+			if (line[0] != 0 && line[0] != '#') specs.push_back(string(line));
+		}
+		fclose(listFile);
+	} else {
+		size_t pos = 0, sep;
+		while ((sep = windowList.find(';', pos)) != string::npos) {
+			if (sep > pos) specs.push_back(windowList.substr(pos, sep - pos));
+			pos = sep + 1;
+		}
+		if (pos < windowList.size()) specs.push_back(windowList.substr(pos));
+	}
+	for (vector<string>::iterator it = specs.begin(); it != specs.end(); it++) {
+		TimeWindow window;
+		size_t c1 = it->find(',');
+		size_t c2 = c1 == string::npos? string::npos : it->find(',', c1 + 1);
+		if (c2 != string::npos) {
+			window.outName = it->substr(0, c1);
+			window.from = dt2time(it->substr(c1 + 1, c2 - c1 - 1));
+			window.to = dt2time(it->substr(c2 + 1));
+		}
+		if ((c2 == string::npos) || window.outName.empty() || (window.from < 0) || (window.to < 0) || (window.from > window.to)) {
+			plog->severe("Incorrect time window " + *it);
+			return false;
+		}
+		for (vector<TimeWindow>::iterator w = windows.begin(); w != windows.end(); w++)
+			if (w->outName.compare(window.outName) == 0) {
+				plog->severe("Output file " + window.outName + " stated in several time windows");
+				return false;
+			}
+		windows.push_back(window);
+	}
+	if (windows.empty()) plog->severe("No time windows in " + windowList);
+	return !windows.empty();
 }
 
 /**addWANTED
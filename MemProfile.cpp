@@ -0,0 +1,257 @@
+/** @file MemProfile.cpp
+ * Contains the implementation of the MemProfile and related classes, and the replacement of the global new and
+ * delete operators used to account memory per subsystem.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#include "MemProfile.h"
+
+#include <stdlib.h>
+#include <cstddef>
+#include <atomic>
+#include <new>
+#if !defined(_WIN32) && !defined(WIN32) && !defined(_WIN64) && !defined(WIN64)
+#include <sys/resource.h>
+#endif
+
+//@cond DUMMY
+///The counters of a subsystem
+struct MemCounters {
+	atomic<long long> current;
+	atomic<long long> peak;
+	atomic<long long> total;
+	atomic<long long> allocs;
+	atomic<long long> frees;
+};
+static MemCounters counters[MEM_NTAGS];
+static MemCounters overall;
+static thread_local unsigned char currentTag = MEM_OTHER;
+
+///The data stated in the header of each block allocated
+struct BlockInfo {
+	size_t size;
+	unsigned int tag;
+};
+///The header size, keeping the block returned aligned as the one given by malloc
+static const size_t HDRSIZE = alignof(max_align_t) >= sizeof(BlockInfo)? alignof(max_align_t) : 2 * alignof(max_align_t);
+
+static void charge(MemCounters& c, long long size) {
+	long long now = c.current.fetch_add(size, memory_order_relaxed) + size;
+	long long top = c.peak.load(memory_order_relaxed);
+	while (now > top && !c.peak.compare_exchange_weak(top, now, memory_order_relaxed));
+	c.total.fetch_add(size, memory_order_relaxed);
+	c.allocs.fetch_add(1, memory_order_relaxed);
+}
+
+static void credit(MemCounters& c, long long size) {
+	c.current.fetch_sub(size, memory_order_relaxed);
+	c.frees.fetch_add(1, memory_order_relaxed);
+}
+
+static void* allocate(size_t size) {
+	char* p = (char*) malloc(size + HDRSIZE);
+	if (p == NULL) return NULL;
+	BlockInfo* info = (BlockInfo*) p;
+	info->size = size;
+	info->tag = currentTag;
+	charge(counters[info->tag], (long long) size);
+	charge(overall, (long long) size);
+	return p + HDRSIZE;
+}
+
+static void* allocateOrThrow(size_t size) {
+	void* p;
+	while ((p = allocate(size)) == NULL) {
+		new_handler handler = get_new_handler();
+		if (handler == NULL) throw bad_alloc();
+		handler();
+	}
+	return p;
+}
+
+static void release(void* ptr) {
+	if (ptr == NULL) return;
+	char* p = (char*) ptr - HDRSIZE;
+	BlockInfo* info = (BlockInfo*) p;
+	credit(counters[info->tag], (long long) info->size);
+	credit(overall, (long long) info->size);
+	free(p);
+}
+//@endcond
+
+void* operator new(size_t size) {return allocateOrThrow(size);}
+void* operator new[](size_t size) {return allocateOrThrow(size);}
+void* operator new(size_t size, const nothrow_t&) noexcept {return allocate(size);}
+void* operator new[](size_t size, const nothrow_t&) noexcept {return allocate(size);}
+void operator delete(void* ptr) noexcept {release(ptr);}
+void operator delete[](void* ptr) noexcept {release(ptr);}
+void operator delete(void* ptr, const nothrow_t&) noexcept {release(ptr);}
+void operator delete[](void* ptr, const nothrow_t&) noexcept {release(ptr);}
+
+/**setTag
+ * states the subsystem to be charged with the memory allocated by the calling thread from now on.
+ *
+ *@param tag the subsystem
+ *@return the subsystem previously stated
+ */
+MemTag MemProfile::setTag(MemTag tag) {
+	MemTag previous = (MemTag) currentTag;
+	currentTag = (unsigned char) tag;
+	return previous;
+}
+
+/**getTag
+ * gives the subsystem charged with the memory allocated by the calling thread.
+ *
+ *@return the subsystem currently stated
+ */
+MemTag MemProfile::getTag() {
+	return (MemTag) currentTag;
+}
+
+/**tagName
+ * gives the name of the subsystem as shown in reports.
+ *
+ *@param tag the subsystem
+ *@return the subsystem name
+ */
+string MemProfile::tagName(MemTag tag) {
+	switch (tag) {
+	case MEM_OTHER: return "other";
+	case MEM_HEADER: return "header";
+	case MEM_EPOCH: return "epoch";
+	case MEM_NAVIGATION: return "navigation";
+	case MEM_LOGGING: return "logging";
+	case MEM_IO: return "I/O buffers";
+	default: return "unknown";
+	}
+}
+
+/**current
+ * gives the bytes currently in use by the given subsystem.
+ *
+ *@param tag the subsystem
+ *@return the number of bytes
+ */
+long long MemProfile::current(MemTag tag) {
+	return counters[tag].current.load(memory_order_relaxed);
+}
+
+/**peak
+ * gives the maximum bytes that have been in use by the given subsystem.
+ *
+ *@param tag the subsystem
+ *@return the number of bytes
+ */
+long long MemProfile::peak(MemTag tag) {
+	return counters[tag].peak.load(memory_order_relaxed);
+}
+
+/**cumulative
+ * gives the total bytes allocated by the given subsystem.
+ *
+ *@param tag the subsystem
+ *@return the number of bytes
+ */
+long long MemProfile::cumulative(MemTag tag) {
+	return counters[tag].total.load(memory_order_relaxed);
+}
+
+/**allocations
+ * gives the number of blocks allocated by the given subsystem.
+ *
+ *@param tag the subsystem
+ *@return the number of allocations
+ */
+long long MemProfile::allocations(MemTag tag) {
+	return counters[tag].allocs.load(memory_order_relaxed);
+}
+
+/**releases
+ * gives the number of blocks allocated by the given subsystem that have been released.
+ *
+ *@param tag the subsystem
+ *@return the number of releases
+ */
+long long MemProfile::releases(MemTag tag) {
+	return counters[tag].frees.load(memory_order_relaxed);
+}
+
+/**peakRSS
+ * gives the maximum resident set size of the process, as stated by the operating system.
+ *
+ *@return the peak RSS in bytes, or -1 if it is not available
+ */
+long long MemProfile::peakRSS() {
+#if defined(_WIN32) || defined(WIN32) || defined(_WIN64) || defined(WIN64)
+	return -1;
+#else
+	struct rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#if defined(__APPLE__)
+	return (long long) usage.ru_maxrss;			//given in bytes
+#else
+	return (long long) usage.ru_maxrss * 1024;	//given in kilobytes
+#endif
+#endif
+}
+
+/**report
+ * prints a table with the current, peak and cumulative bytes, and the allocations and releases of each subsystem,
+ * followed by the totals and the process peak RSS.
+ *
+ *@param out the stream where the report is printed
+ */
+void MemProfile::report(FILE* out) {
+	fprintf(out, "%-12s %12s %12s %14s %10s %10s\n", "Subsystem", "Current(B)", "Peak(B)", "Cumulative(B)", "Allocs", "Releases");
+	for (int i = 0; i < MEM_NTAGS; i++) {
+		MemTag tag = (MemTag) i;
+		fprintf(out, "%-12s %12lld %12lld %14lld %10lld %10lld\n", tagName(tag).c_str(),
+			current(tag), peak(tag), cumulative(tag), allocations(tag), releases(tag));
+	}
+	fprintf(out, "%-12s %12lld %12lld %14lld %10lld %10lld\n", "Total",
+		overall.current.load(memory_order_relaxed), overall.peak.load(memory_order_relaxed),
+		overall.total.load(memory_order_relaxed), overall.allocs.load(memory_order_relaxed),
+		overall.frees.load(memory_order_relaxed));
+	long long rss = peakRSS();
+	if (rss < 0) fprintf(out, "Process peak RSS: not available\n");
+	else fprintf(out, "Process peak RSS: %lld kB\n", rss / 1024);
+}
+
+/**IOBuffer
+ * allocates a stream buffer of the given size, charging it to the MEM_IO subsystem.
+ *
+ *@param size the buffer size in bytes
+ */
+IOBuffer::IOBuffer(size_t size) {
+	MemScope scope(MEM_IO);
+	buffer = new char[size];
+	this->size = size;
+}
+
+IOBuffer::~IOBuffer() {
+	delete[] buffer;
+}
+
+/**attach
+ * states this buffer as the full buffering buffer of the given stream.
+ *
+ *@param stream the stream, just opened
+ *@return true if the buffer has been attached, false otherwise
+ */
+bool IOBuffer::attach(FILE* stream) {
+	return setvbuf(stream, buffer, _IOFBF, size) == 0;
+}
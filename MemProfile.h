@@ -0,0 +1,90 @@
+/** @file MemProfile.h
+ * Contains the definition of the MemProfile class, used to account the dynamic memory allocated by the different
+ * subsystems of OSPtools commands, and related classes.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef MEMPROFILE_H
+#define MEMPROFILE_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <string>
+
+using namespace std;
+
+/**MemTag identifies the subsystems whose memory is accounted.
+ */
+enum MemTag {MEM_OTHER = 0, MEM_HEADER, MEM_EPOCH, MEM_NAVIGATION, MEM_LOGGING, MEM_IO, MEM_NTAGS};
+
+/**MemProfile accounts the memory allocated with new and released with delete, per subsystem.
+ * Linking MemProfile.cpp into a command replaces the global new and delete operators with ones that add a small
+ * header to each block, stating its size and the subsystem it was charged to. The subsystem charged is the one
+ * stated for the allocating thread when the block was allocated (see setTag and MemScope), and the same subsystem
+ * is credited when the block is released, whatever the thread or subsystem current at that time.
+ *<p>
+ * For each subsystem it is accounted the current and peak bytes in use, the cumulative bytes allocated, and the
+ * number of allocations and releases. Counters are updated with relaxed atomic operations.
+ */
+class MemProfile {
+public:
+	static MemTag setTag(MemTag tag);
+	static MemTag getTag();
+	static string tagName(MemTag tag);
+	static long long current(MemTag tag);
+	static long long peak(MemTag tag);
+	static long long cumulative(MemTag tag);
+	static long long allocations(MemTag tag);
+	static long long releases(MemTag tag);
+	static long long peakRSS();
+	static void report(FILE* out);
+};
+
+/**MemScope charges to the given subsystem the memory allocated by the current thread from its construction to its
+ * destruction. Scopes can be nested: the subsystem previously stated is restored when the scope ends.
+ */
+class MemScope {
+public:
+	MemScope(MemTag tag) {
+		previous = MemProfile::setTag(tag);
+	}
+	~MemScope() {
+		MemProfile::setTag(previous);
+	}
+private:
+	MemTag previous;
+};
+
+/**MEMLOG runs the given logging statement charging to the logging subsystem the memory it allocates, including the
+ * one used to build the message logged.
+ */
+#define MEMLOG(...) do {MemScope memLogScope(MEM_LOGGING); __VA_ARGS__;} while (0)
+
+/**IOBuffer is a stdio stream buffer allocated in the MEM_IO subsystem, to account the memory used for I/O buffering.
+ * It shall be attached to a stream before any I/O is performed on it, and shall exist until the stream is closed.
+ */
+class IOBuffer {
+public:
+	IOBuffer(size_t size);
+	~IOBuffer();
+	bool attach(FILE* stream);
+private:
+	char* buffer;
+	size_t size;
+	IOBuffer(const IOBuffer&);				//not copyable
+	IOBuffer& operator=(const IOBuffer&);
+};
+#endif
@@ -0,0 +1,455 @@
+/** @file MinuteRollup.cpp
+ * Contains the implementation of the MinuteRollup class.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#include "MinuteRollup.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+
+//from this project
+#include "ResultCache.h"
+
+//@cond DUMMY
+//the sidecar file identification and format version
+static const char MAGIC[8] = {'O', 'S', 'P', 'R', 'L', 'U', 'P', '2'};
+//the block identification
+static const char BLKMAGIC[4] = {'R', 'B', 'L', 'K'};
+//size of the block header: magic, rows, first and last minutes
+static const size_t BLKHEADSIZE = 16;
+//size of a row in the columns: minute, 4 counters, 2 means
+static const size_t ROWSIZE = 4 + 4 * 2 + 2 * 4;
+//seconds in a GPS week
+static const double WEEKSECS = 604800.0;
+
+//big endian values in a payload
+static inline uint16_t be16(const unsigned char* p) {return (uint16_t) ((p[0] << 8) | p[1]);}
+static inline uint32_t be32(const unsigned char* p) {
+	return ((uint32_t) p[0] << 24) | ((uint32_t) p[1] << 16) | ((uint32_t) p[2] << 8) | p[3];
+}
+//number of bits set
+static inline int popCount(uint64_t v) {
+	int n = 0;
+	for (; v != 0; v &= v - 1) n++;
+	return n;
+}
+//@endcond
+
+/**Header is the first part of the sidecar file
+ */
+struct MinuteRollup::Header {
+	char magic[8];			//the MAGIC identification
+	uint32_t rowSize;		//the size of a row in the columns, to detect incompatible formats
+	uint32_t nRows;			//number of rows stored
+	uint64_t validEnd;		//size of the sidecar with all its blocks completely written
+	uint64_t sourceHash;	//hash of the source file path of the last block
+	uint64_t resumeOffset;	//offset in the source file where the minute after the last block starts
+	uint64_t sourceSize;	//size of the source file when the last block was written
+	int64_t sourceMtime;	//modification time of the source file when the last block was written
+	uint64_t sourceIno;		//inode of the source file when the last block was written
+	int32_t lastMinute;		//the last minute stored, or INT32_MIN if none
+	unsigned char padding[4];
+};
+
+/**MinuteRollup
+ * constructs an empty and closed MinuteRollup object.
+ */
+MinuteRollup::MinuteRollup() {
+	file = NULL;
+	plog = NULL;
+	blockRows = 1;
+	srcHash = 0;
+	offset = 0;
+	lastMinute = INT32_MIN;
+	nStored = 0;
+	curMinute = INT32_MIN;
+	resetMinute();
+	epochStart = 0;
+	resetEpoch();
+}
+
+/**~MinuteRollup
+ * closes the sidecar, if open, without storing the current minute.
+ */
+MinuteRollup::~MinuteRollup() {
+	close(false);
+}
+
+/**open
+ * opens the given rollup sidecar file to append rows computed from the given source OSP file.
+ * The sidecar is created if it does not exist. Rows of a block partially written are discarded.
+ * If the last rows came from the same source, and it has shrunk or has been replaced since (its size is smaller, or
+ * its inode or its modification time with the same size have changed), all rows are discarded to rebuild the sidecar.
+ *
+ *@param rollupFile the rollup sidecar file name. If empty, the rollup remains closed
+ *@param sourceFile the OSP file the messages will come from
+ *@param blockRows the number of complete rows to buffer before writing them as a block
+ *@param plog a pointer to the Logger
+ *@return true if the sidecar is open, false otherwise
+ */
+bool MinuteRollup::open(string rollupFile, string sourceFile, int blockRows, Logger* plog) {
+	close(false);
+	if (rollupFile.empty()) return false;
+	this->plog = plog;
+	this->blockRows = blockRows > 0 ? blockRows : 1;
+	char buf[PATH_MAX];
+	string path = realpath(sourceFile.c_str(), buf) == NULL ? sourceFile : string(buf);
+	srcPath = path;
+	Hash64 h64;
+	h64.update(path.c_str(), path.size());
+	srcHash = h64.digest();
+	Header h;
+	if ((file = fopen(rollupFile.c_str(), "r+b")) == NULL) {	//a new sidecar
+		if ((file = fopen(rollupFile.c_str(), "w+b")) == NULL) {
+			plog->warning("Rollup: cannot create " + rollupFile);
+			return false;
+		}
+		memset(&h, 0, sizeof h);
+		memcpy(h.magic, MAGIC, sizeof MAGIC);
+		h.rowSize = ROWSIZE;
+		h.validEnd = sizeof h;
+		h.lastMinute = INT32_MIN;
+		if (!writeHeader(h)) {
+			plog->warning("Rollup: cannot write " + rollupFile);
+			close(false);
+			return false;
+		}
+	} else if (!readHeader(h)) {
+		plog->warning("Rollup: wrong format in " + rollupFile);
+		close(false);
+		return false;
+	}
+	struct stat st;
+	if ((h.sourceHash == srcHash) && (h.nRows > 0) && (stat(path.c_str(), &st) == 0)
+		&& (((uint64_t) st.st_size < h.sourceSize) || ((uint64_t) st.st_ino != h.sourceIno)
+		|| (((uint64_t) st.st_size == h.sourceSize) && ((int64_t) st.st_mtime != h.sourceMtime)))) {
+		plog->warning("Rollup: " + sourceFile + " has shrunk or has been replaced. Rebuilding " + rollupFile);
+		h.nRows = 0;
+		h.validEnd = sizeof h;
+		h.resumeOffset = 0;
+		h.lastMinute = INT32_MIN;
+		if (!writeHeader(h) || (ftruncate(fileno(file), h.validEnd) != 0)) {
+			plog->warning("Rollup: cannot write " + rollupFile);
+			close(false);
+			return false;
+		}
+	}
+	if ((fstat(fileno(file), &st) == 0) && ((uint64_t) st.st_size > h.validEnd)) {
+		plog->warning("Rollup: discarded a partial block at the end of " + rollupFile);
+		if (ftruncate(fileno(file), h.validEnd) != 0) {
+			close(false);
+			return false;
+		}
+	}
+	lastMinute = h.lastMinute;
+	offset = h.sourceHash == srcHash ? h.resumeOffset : 0;
+	nStored = 0;
+	curMinute = INT32_MIN;
+	resetMinute();
+	epochStart = offset;
+	resetEpoch();
+	return true;
+}
+
+/**isOpen
+ * tells if the sidecar is open.
+ *
+ *@return true if open, false otherwise
+ */
+bool MinuteRollup::isOpen() {
+	return file != NULL;
+}
+
+/**resumeOffset
+ * gives the offset in the source file where message processing shall start: the beginning of the first minute not
+ * yet stored, if the last rows stored came from the same source, or 0 otherwise.
+ *
+ *@return the offset in bytes
+ */
+uint64_t MinuteRollup::resumeOffset() {
+	return offset;
+}
+
+/**restart
+ * states that messages will be processed from the beginning of the source file, as when it has been rewritten.
+ */
+void MinuteRollup::restart() {
+	offset = 0;
+	curMinute = INT32_MIN;
+	resetMinute();
+	epochStart = 0;
+	resetEpoch();
+}
+
+/**add
+ * accounts the given OSP message in the aggregates of its epoch, and these in the ones of the minute of the MID 7
+ * closing the epoch. Messages shall be given in the order they are in the source file, starting at the resume offset.
+ * When a MID 7 starts a new minute, the current one is completed, and a block is written if the number of rows
+ * pending reaches the block size.
+ *
+ *@param payload the message payload
+ *@param len the payload length
+ *@return false if a block had to be written and a write error happened, true otherwise
+ */
+bool MinuteRollup::add(const unsigned char* payload, unsigned int len) {
+	if (file == NULL) return true;
+	offset += 2 + len;
+	if (len == 0) return true;
+	switch (payload[0]) {
+	case 7:		//MID 7, clock status data: extended week, TOW, satellites used, drift. It closes the epoch
+		if (len >= 12) {
+			double t = be16(payload + 1) * WEEKSECS + be32(payload + 3) / 100.0;
+			int32_t minute = (int32_t) (t / 60.0);
+			if (minute != curMinute) {
+				if (curMinute != INT32_MIN) closeMinute(epochStart);
+				curMinute = minute;
+			}
+			epochs++;
+			driftSum += be32(payload + 8);
+			for (int i = 0; i < 4; i++) svSet[i] |= epochSvSet[i];
+			cn0Sum += epochCn0Sum;
+			cn0Count += epochCn0Count;
+			solutions += epochSolutions;
+			fixes += epochFixes;
+			epochStart = offset;
+			resetEpoch();
+		}
+		break;
+	case 2:		//MID 2, solution data: mode 1 bits 0-2 state the fix type (0 no fix)
+		if (len >= 20) {
+			epochSolutions++;
+			if ((payload[19] & 0x07) != 0) epochFixes++;
+		}
+		break;
+	case 28:	//MID 28, navigation library measurement data: satellite and 10 C/N0 values
+		if (len >= 48) {
+			unsigned int sv = payload[6];
+			epochSvSet[sv >> 6] |= (uint64_t) 1 << (sv & 63);
+			for (int i = 0; i < 10; i++) epochCn0Sum += payload[38 + i];
+			epochCn0Count += 10;
+		}
+		break;
+	default:
+		break;
+	}
+	if ((int) pending.size() >= blockRows) return flush();
+	return true;
+}
+
+/**flush
+ * writes the complete rows pending as a new block, and updates the sidecar header.
+ *
+ *@return true if rows have been written, or no rows are pending, false if a write error happened
+ */
+bool MinuteRollup::flush() {
+	if (file == NULL || pending.empty()) return true;
+	size_t n = pending.size();
+	vector<unsigned char> block(BLKHEADSIZE + n * ROWSIZE);
+	unsigned char* p = &block[0];
+	uint32_t nRows = (uint32_t) n;
+	memcpy(p, BLKMAGIC, 4);
+	memcpy(p + 4, &nRows, 4);
+	memcpy(p + 8, &pending.front().minute, 4);
+	memcpy(p + 12, &pending.back().minute, 4);
+	p += BLKHEADSIZE;
+	for (size_t i = 0; i < n; i++, p += 4) memcpy(p, &pending[i].minute, 4);
+	for (size_t i = 0; i < n; i++, p += 2) memcpy(p, &pending[i].epochs, 2);
+	for (size_t i = 0; i < n; i++, p += 2) memcpy(p, &pending[i].svs, 2);
+	for (size_t i = 0; i < n; i++, p += 2) memcpy(p, &pending[i].solutions, 2);
+	for (size_t i = 0; i < n; i++, p += 2) memcpy(p, &pending[i].fixes, 2);
+	for (size_t i = 0; i < n; i++, p += 4) memcpy(p, &pending[i].meanCN0, 4);
+	for (size_t i = 0; i < n; i++, p += 4) memcpy(p, &pending[i].meanDrift, 4);
+	Header h;
+	bool written = readHeader(h) && (fseeko(file, h.validEnd, SEEK_SET) == 0)
+		&& (fwrite(&block[0], block.size(), 1, file) == 1) && (fflush(file) == 0);
+	if (written) {
+		struct stat st;
+		if (stat(srcPath.c_str(), &st) != 0) memset(&st, 0, sizeof st);
+		h.nRows += nRows;
+		h.validEnd += block.size();
+		h.sourceHash = srcHash;
+		h.resumeOffset = pendingOffsets.back();
+		h.sourceSize = st.st_size;
+		h.sourceMtime = st.st_mtime;
+		h.sourceIno = st.st_ino;
+		h.lastMinute = pending.back().minute;
+		written = writeHeader(h);
+	}
+	if (!written) {
+		plog->severe("Rollup: write error");
+		return false;
+	}
+	nStored += nRows;
+	pending.clear();
+	pendingOffsets.clear();
+	return true;
+}
+
+/**close
+ * writes the rows pending and closes the sidecar.
+ *
+ *@param finished true if the source data are complete, and the current minute shall be stored, false otherwise.
+ * Messages after the last MID 7 are not accounted
+ *@return true if all rows have been written, false otherwise
+ */
+bool MinuteRollup::close(bool finished) {
+	if (file == NULL) return true;
+	if (finished && curMinute != INT32_MIN) closeMinute(epochStart);
+	curMinute = INT32_MIN;
+	resetEpoch();
+	bool written = flush();
+	fclose(file);
+	file = NULL;
+	pending.clear();
+	pendingOffsets.clear();
+	return written;
+}
+
+/**rowsStored
+ * gives the number of rows written since the sidecar was opened.
+ *
+ *@return the number of rows
+ */
+unsigned int MinuteRollup::rowsStored() {
+	return nStored;
+}
+
+/**readRows
+ * reads from the given sidecar file the rows for the minutes in the given span. Blocks out of the span are skipped.
+ *
+ *@param rollupFile the rollup sidecar file name
+ *@param fromMinute the first minute of the span
+ *@param toMinute the last minute of the span
+ *@param rows the vector where rows read are appended
+ *@return true if the sidecar has been read, false if it cannot be read or has a wrong format
+ */
+bool MinuteRollup::readRows(string rollupFile, int32_t fromMinute, int32_t toMinute, vector<RollupRow>& rows) {
+	MinuteRollup reader;
+	Header h;
+	if ((reader.file = fopen(rollupFile.c_str(), "rb")) == NULL) return false;
+	if (!reader.readHeader(h)) return false;
+	vector<unsigned char> cols;
+	unsigned char bh[BLKHEADSIZE];
+	uint64_t pos = sizeof h;
+	while (pos + BLKHEADSIZE <= h.validEnd) {
+		if ((fseeko(reader.file, pos, SEEK_SET) != 0) || (fread(bh, BLKHEADSIZE, 1, reader.file) != 1)
+			|| (memcmp(bh, BLKMAGIC, 4) != 0)) return false;
+		uint32_t n;
+		int32_t first, last;
+		memcpy(&n, bh + 4, 4);
+		memcpy(&first, bh + 8, 4);
+		memcpy(&last, bh + 12, 4);
+		pos += BLKHEADSIZE + (uint64_t) n * ROWSIZE;
+		if (last < fromMinute || first > toMinute || n == 0) continue;
+		cols.resize(n * ROWSIZE);
+		if (fread(&cols[0], cols.size(), 1, reader.file) != 1) return false;
+		const unsigned char* p[7];
+		p[0] = &cols[0];
+		p[1] = p[0] + n * 4;
+		p[2] = p[1] + n * 2;
+		p[3] = p[2] + n * 2;
+		p[4] = p[3] + n * 2;
+		p[5] = p[4] + n * 2;
+		p[6] = p[5] + n * 4;
+		for (uint32_t i = 0; i < n; i++) {
+			RollupRow r;
+			memcpy(&r.minute, p[0] + i * 4, 4);
+			if (r.minute < fromMinute || r.minute > toMinute) continue;
+			memcpy(&r.epochs, p[1] + i * 2, 2);
+			memcpy(&r.svs, p[2] + i * 2, 2);
+			memcpy(&r.solutions, p[3] + i * 2, 2);
+			memcpy(&r.fixes, p[4] + i * 2, 2);
+			memcpy(&r.meanCN0, p[5] + i * 4, 4);
+			memcpy(&r.meanDrift, p[6] + i * 4, 4);
+			rows.push_back(r);
+		}
+	}
+	return true;
+}
+
+//@cond DUMMY
+/**closeMinute
+ * completes the current minute, adding its row to the pending ones if it is not already stored.
+ *
+ *@param nextOffset the offset in the source file of the message starting the next minute
+ */
+void MinuteRollup::closeMinute(uint64_t nextOffset) {
+	if (curMinute > lastMinute) {
+		RollupRow r;
+		r.minute = curMinute;
+		r.epochs = epochs > 65535 ? 65535 : epochs;
+		r.svs = popCount(svSet[0]) + popCount(svSet[1]) + popCount(svSet[2]) + popCount(svSet[3]);
+		r.solutions = solutions > 65535 ? 65535 : solutions;
+		r.fixes = fixes > 65535 ? 65535 : fixes;
+		r.meanCN0 = cn0Count > 0 ? (float) (cn0Sum / cn0Count) : 0.0f;
+		r.meanDrift = epochs > 0 ? (float) (driftSum / epochs) : 0.0f;
+		pending.push_back(r);
+		pendingOffsets.push_back(nextOffset);
+		lastMinute = curMinute;
+	}
+	resetMinute();
+}
+
+/**resetMinute
+ * clears the accumulators of the current minute.
+ */
+void MinuteRollup::resetMinute() {
+	epochs = 0;
+	memset(svSet, 0, sizeof svSet);
+	cn0Sum = 0.0;
+	cn0Count = 0;
+	solutions = 0;
+	fixes = 0;
+	driftSum = 0.0;
+}
+
+/**resetEpoch
+ * clears the accumulators of the epoch in progress.
+ */
+void MinuteRollup::resetEpoch() {
+	memset(epochSvSet, 0, sizeof epochSvSet);
+	epochCn0Sum = 0.0;
+	epochCn0Count = 0;
+	epochSolutions = 0;
+	epochFixes = 0;
+}
+
+/**readHeader
+ * reads and verifies the sidecar header.
+ *
+ *@param h where the header is returned
+ *@return true if the header has been read and has the right format, false otherwise
+ */
+bool MinuteRollup::readHeader(Header& h) {
+	return (fseeko(file, 0, SEEK_SET) == 0) && (fread(&h, sizeof h, 1, file) == 1)
+		&& (memcmp(h.magic, MAGIC, sizeof MAGIC) == 0) && (h.rowSize == ROWSIZE);
+}
+
+/**writeHeader
+ * writes the sidecar header.
+ *
+ *@param h the header
+ *@return true if the header has been written, false otherwise
+ */
+bool MinuteRollup::writeHeader(const Header& h) {
+	return (fseeko(file, 0, SEEK_SET) == 0) && (fwrite(&h, sizeof h, 1, file) == 1) && (fflush(file) == 0);
+}
+//@endcond
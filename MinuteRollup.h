@@ -0,0 +1,108 @@
+/** @file MinuteRollup.h
+ * Contains the definition of the MinuteRollup class, used to compute per minute aggregates of OSP data and store them
+ * in a sidecar file.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef MINUTEROLLUP_H
+#define MINUTEROLLUP_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "Logger.h"
+
+using namespace std;
+
+/**RollupRow contains the aggregates of one minute of OSP data
+ */
+struct RollupRow {
+	int32_t minute;		//GPS minute: GPS seconds from the GPS epoch / 60
+	uint16_t epochs;	//number of epochs (MID 7)
+	uint16_t svs;		//number of different satellites tracked (MID 28)
+	uint16_t solutions;	//number of navigation solutions (MID 2)
+	uint16_t fixes;		//number of solutions with a valid fix (MID 2 mode 1 not "no fix")
+	float meanCN0;		//mean C/N0 of the measurements (MID 28), in dB-Hz
+	float meanDrift;	//mean clock drift (MID 7), in Hz
+};
+
+/**MinuteRollup computes, in a single pass over the OSP messages, the aggregates of each minute of data (see RollupRow),
+ * and appends them to a rollup sidecar file.
+ *<p>
+ * The MID 28 and MID 2 messages of an epoch precede its MID 7, so they are kept apart until the MID 7 closing the
+ * epoch arrives, and then assigned to the minute of this MID 7. Messages after the last MID 7 are not accounted.
+ * A minute is complete when a MID 7 of a later minute arrives. Only complete minutes are stored, unless the OSP data
+ * are stated finished when closing.
+ *<p>
+ * The sidecar file is columnar and appendable: after a header, it contains blocks of rows, each one with a block header
+ * stating the number of rows and the minutes span, followed by the column arrays (minute, epochs, svs, solutions,
+ * fixes, meanCN0, meanDrift). Values are stored in the host byte order. A query reads only the blocks in the span
+ * requested. The header states the source OSP file of the last rows and the offset in it where the next minute
+ * starts, so a later update of the same source resumes from there, processing only the data added. Rows for minutes
+ * already stored are not added again. The header also states the size, modification time and inode of the source
+ * when the last rows were stored, so a source shrunk or replaced is detected and the sidecar rebuilt. The header is
+ * updated after each block is written, so a block partially written is discarded when the sidecar is opened again.
+ */
+class MinuteRollup {
+public:
+	MinuteRollup();
+	~MinuteRollup();
+	bool open(string rollupFile, string sourceFile, int blockRows, Logger* plog);
+	bool isOpen();
+	uint64_t resumeOffset();
+	void restart();
+	bool add(const unsigned char* payload, unsigned int len);
+	bool flush();
+	bool close(bool finished);
+	unsigned int rowsStored();
+	static bool readRows(string rollupFile, int32_t fromMinute, int32_t toMinute, vector<RollupRow>& rows);
+private:
+	struct Header;
+	FILE* file;				//the sidecar file, or NULL if closed
+	Logger* plog;			//the logger
+	int blockRows;			//number of complete rows to be buffered before writing a block
+	string srcPath;			//the absolute path of the source file
+	uint64_t srcHash;		//the hash of the source file path
+	uint64_t offset;		//offset in the source file of the next message
+	int32_t lastMinute;		//the last minute stored in the sidecar
+	unsigned int nStored;	//rows stored in this session
+	vector<RollupRow> pending;			//complete rows not yet written
+	vector<uint64_t> pendingOffsets;	//offset of the minute following each pending row
+	//accumulators for the current minute
+	int32_t curMinute;
+	unsigned int epochs;
+	uint64_t svSet[4];
+	double cn0Sum;
+	unsigned int cn0Count;
+	unsigned int solutions;
+	unsigned int fixes;
+	double driftSum;
+	//accumulators for the epoch in progress, waiting for its MID 7
+	uint64_t epochStart;	//offset in the source file of the first message of the epoch
+	uint64_t epochSvSet[4];
+	double epochCn0Sum;
+	unsigned int epochCn0Count;
+	unsigned int epochSolutions;
+	unsigned int epochFixes;
+	void closeMinute(uint64_t nextOffset);
+	void resetMinute();
+	void resetEpoch();
+	bool readHeader(Header& h);
+	bool writeHeader(const Header& h);
+};
+#endif
@@ -0,0 +1,173 @@
+/** @file OSPCatalog.cpp
+ * Contains the command line program to update and query the catalog of an archive of OSP files.
+ *<p>Usage:
+ *<p>OSPCatalog.exe {options} [CATALOG]
+ *<p>Options are:
+ *	- -a ADD or --add=ADD : OSP file, or directory containing OSP files, to add or refresh in the catalog (empty: none). Default value ADD is empty
+ *	- -e END or --end=END : End of the time span to look up, as YYYY-MM-DDThh:mm:ss or WEEK:TOW in GPS time (empty: no end). Default value END is empty
+ *	- -h or --help : Show usage data. Default value HELP=FALSE
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -r RECEIVER or --receiver=RECEIVER : Text contained in the receiver identification of the files to look up (empty: any). Default value RECEIVER is empty
+ *	- -s START or --start=START : Start of the time span to look up, as YYYY-MM-DDThh:mm:ss or WEEK:TOW in GPS time (empty: no start). Default value START is empty
+ *Default value for operator is: ARCHIVE.CAT
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+#include "Utilities.h"
+//from this project
+#include "ArchiveCatalog.h"
+#include "FileList.h"
+//standard
+#include <stdio.h>
+#include <sys/stat.h>
+#include <chrono>
+
+using namespace std;
+
+//@cond DUMMY
+///The command line format
+const string CMDLINE = "OSPCatalog.exe {options} [CATALOG]";
+///The current program version
+const string MYVER = " V1.0";
+///The parser object to store options and operators passed in the command line
+ArgParser parser;
+//Metavariables for options
+int ADD, END, HELP, LOGLEVEL, RECEIVER, START;
+//Metavariables for operators
+int CATALOG;
+//functions in this file
+void listOSP(string input, vector<string>& files);
+void printEntry(const CatalogEntry* e);
+//@endcond
+
+/**main
+ * gets the command line arguments, sets parameters accordingly, and updates or queries the archive catalog.
+ * When files to add are given, they are added to the catalog, or refreshed if they have changed since cataloged.
+ * Otherwise the catalog is looked up for the OSP files having data in the given time span and from the given
+ * receiver, and for each one it is printed to stdout: the path, receiver identification, time span, number of epochs,
+ * number of messages per MID, and the files generated from it.
+ *<p>
+ * Conversion commands (GP2toOSP, PacketToOSP, RXtoOSP, OSPtoRINEX, OSPtoRTK) update the catalog when it is given
+ * in their catalog option.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning:
+ *		- (0) no errors have been detected
+ *		- (1) an error has been detected in arguments
+ *		- (2) the catalog cannot be opened
+ *		- (3) some file cannot be added to the catalog
+ */
+int main(int argc, char* argv[]) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	ADD = parser.addOption("-a", "--add", "ADD", "OSP file, or directory containing OSP files, to add or refresh in the catalog (empty: none)", "");
+	END = parser.addOption("-e", "--end", "END", "End of the time span to look up, as YYYY-MM-DDThh:mm:ss or WEEK:TOW in GPS time (empty: no end)", "");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data", false);
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	RECEIVER = parser.addOption("-r", "--receiver", "RECEIVER", "Text contained in the receiver identification of the files to look up (empty: any)", "");
+	START = parser.addOption("-s", "--start", "START", "Start of the time span to look up, as YYYY-MM-DDThh:mm:ss or WEEK:TOW in GPS time (empty: no start)", "");
+	/// 3- Setups the default values for operators in the command line
+	CATALOG = parser.addOperator("ARCHIVE.CAT");
+	/// 4- Parses arguments in the command line extracting options and operators
+	double start = -1e12, end = 1e12;	//the time span to look up
+	try {
+		parser.parseArgs(argc, argv);
+		if (!parser.getStrOpt(START).empty() && !ArchiveCatalog::gpsTimeVal(parser.getStrOpt(START), start))
+			throw string("Wrong format for START");
+		if (!parser.getStrOpt(END).empty() && !ArchiveCatalog::gpsTimeVal(parser.getStrOpt(END), end))
+			throw string("Wrong format for END");
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	log.info(parser.showOpeValues());
+	if (parser.getBoolOpt(HELP)) {	//help info has been requested
+		parser.usage("Updates and looks up the catalog of an archive of OSP files", CMDLINE);
+		return 0;
+	}
+	/// 5- Sets logging level stated in option
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	/// 6- Opens the catalog, for update if files to add are given
+	ArchiveCatalog catalog;
+	string catName = parser.getOperator(CATALOG);
+	bool adding = !parser.getStrOpt(ADD).empty();
+	if (!catalog.open(catName, adding)) {
+		log.severe("Cannot open catalog " + catName);
+		return 2;
+	}
+	/// 7- Adds or refreshes the given files, if any
+	if (adding) {
+		vector<string> files;
+		listOSP(parser.getStrOpt(ADD), files);
+		int nFailed = 0;
+		for (vector<string>::iterator it = files.begin(); it != files.end(); it++)
+			if (catalog.addOSP(*it, &log) == NULL) nFailed++;
+		log.info("Files cataloged: " + to_string((long long) (files.size() - nFailed)) + ". Entries in catalog: " + to_string((long long) catalog.size()));
+		return nFailed == 0 ? 0 : 3;
+	}
+	/// 8- Looks up the catalog and prints the entries found
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	vector<const CatalogEntry*> found = catalog.lookup(start, end, parser.getStrOpt(RECEIVER));
+	double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - t0).count();
+	for (vector<const CatalogEntry*>::iterator it = found.begin(); it != found.end(); it++) printEntry(*it);
+	log.info("Files found: " + to_string((long long) found.size()) + " of " + to_string((long long) catalog.size())
+		+ " in " + to_string((long double) ms) + " ms");
+	return 0;
+}
+
+/**listOSP
+ * fills the file list with the given file or, if it is a directory, the OSP files in it.
+ *
+ *@param input the input file or directory
+ *@param files the list where file names are added
+ */
+void listOSP(string input, vector<string>& files) {
+	struct stat st;
+	if (stat(input.c_str(), &st) != 0) {
+		files.push_back(input);	//to report it cannot be cataloged
+		return;
+	}
+	if (!S_ISDIR(st.st_mode)) {
+		files.push_back(input);
+		return;
+	}
+	FileList::listDir(input, "OSP", files);
+}
+
+/**printEntry
+ * prints to stdout the data of a catalog entry, one item per line.
+ *
+ *@param e the catalog entry
+ */
+void printEntry(const CatalogEntry* e) {
+	printf("%s\n", e->path);
+	printf("\tReceiver:%s\n", e->receiver);
+	printf("\tFrom:%s;To:%s;Epochs:%u;Messages:%u\n", ArchiveCatalog::gpsTimeTXT(e->start).c_str(),
+		ArchiveCatalog::gpsTimeTXT(e->end).c_str(), e->epochs, e->messages);
+	printf("\tMIDs:");
+	for (int i = 0; i < 256; i++) if (e->midCount[i] > 0) printf(" %d:%u", i, e->midCount[i]);
+	printf("\n");
+	if (e->outputs[0] != 0) printf("\tOutputs:%s\n", e->outputs);
+}
@@ -0,0 +1,201 @@
+/** @file OSPRollup.cpp
+ * Contains the command line program to build or query the per minute rollup sidecar of an OSP file.
+ *<p>Usage:
+ *<p>OSPRollup.exe {options} [OSPfileName]
+ *<p>Options are:
+ *	- -c or --closed : The OSP file is complete: its last minute is also stored. Default value CLOSED=FALSE
+ *	- -e END or --end=END : End of the span to query, as YYYY-MM-DDThh:mm:ss or WEEK:TOW in GPS time (empty: no end). Default value END is empty
+ *	- -h or --help : Show usage data. Default value HELP=FALSE
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -o ROLLUP or --rollup=ROLLUP : Rollup sidecar file (empty: the OSP file name with the .rollup suffix). Default value ROLLUP is empty
+ *	- -q or --query : Print the rows in the sidecar for the span stated, instead of updating it. Default value QUERY=FALSE
+ *	- -s START or --start=START : Start of the span to query, as YYYY-MM-DDThh:mm:ss or WEEK:TOW in GPS time (empty: no start). Default value START is empty
+ *Default value for operator is: DATA.OSP
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+#include "Utilities.h"
+//from this project
+#include "MinuteRollup.h"
+#include "ArchiveCatalog.h"
+//standard
+#include <stdio.h>
+#include <limits.h>
+#include <chrono>
+
+using namespace std;
+
+//@cond DUMMY
+///The command line format
+const string CMDLINE = "OSPRollup.exe {options} [OSPfileName]";
+///The current program version
+const string MYVER = " V1.0";
+///The size of the buffer for the input file
+const size_t IOBUFSIZE = 1048576;
+///The parser object to store options and operators passed in the command line
+ArgParser parser;
+//Metavariables for options
+int CLOSED, END, HELP, LOGLEVEL, QUERY, ROLLUP, START;
+//Metavariables for operators
+int OSPF;
+//functions in this file
+int buildRollup(FILE* inFile, MinuteRollup& rollup, Logger* plog);
+void printRows(const vector<RollupRow>& rows);
+//@endcond
+
+/**main
+ * gets the command line arguments, sets parameters accordingly, and updates or queries the rollup sidecar of an
+ * OSP file.
+ *<p>
+ * When updating, the OSP file messages are read in a single streaming pass, computing for each minute: epochs,
+ * satellites tracked, mean C/N0, navigation solutions and fixes, and mean clock drift. The rows of complete minutes
+ * are appended to the sidecar. Processing starts where the previous update of the sidecar from the same OSP file
+ * ended, so a growing file, like one being written by RXtoOSP, can be updated periodically processing only the data
+ * added. If the OSP file has shrunk or has been replaced since, the sidecar is rebuilt from its beginning. RXtoOSP can
+ * also update the sidecar itself while capturing.
+ *<p>
+ * When querying, the rows for the minutes in the span stated are printed to stdout, one per line, reading only the
+ * sidecar blocks in the span.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning:
+ *		- (0) no errors have been detected
+ *		- (1) an error has been detected in arguments
+ *		- (2) error when opening the input file
+ *		- (3) error when opening, reading or writing the sidecar file
+ */
+int main(int argc, char* argv[]) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	CLOSED = parser.addOption("-c", "--closed", "CLOSED", "The OSP file is complete: its last minute is also stored", false);
+	END = parser.addOption("-e", "--end", "END", "End of the span to query, as YYYY-MM-DDThh:mm:ss or WEEK:TOW in GPS time (empty: no end)", "");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data", false);
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	ROLLUP = parser.addOption("-o", "--rollup", "ROLLUP", "Rollup sidecar file (empty: the OSP file name with the .rollup suffix)", "");
+	QUERY = parser.addOption("-q", "--query", "QUERY", "Print the rows in the sidecar for the span stated, instead of updating it", false);
+	START = parser.addOption("-s", "--start", "START", "Start of the span to query, as YYYY-MM-DDThh:mm:ss or WEEK:TOW in GPS time (empty: no start)", "");
+	/// 3- Setups the default values for operators in the command line
+	OSPF = parser.addOperator("DATA.OSP");
+	/// 4- Parses arguments in the command line extracting options and operators
+	double start = 0.0, end = (double) INT32_MAX * 60.0;	//the span to query, in GPS seconds
+	try {
+		parser.parseArgs(argc, argv);
+		if (!parser.getStrOpt(START).empty() && !ArchiveCatalog::gpsTimeVal(parser.getStrOpt(START), start))
+			throw string("Wrong format for START");
+		if (!parser.getStrOpt(END).empty() && !ArchiveCatalog::gpsTimeVal(parser.getStrOpt(END), end))
+			throw string("Wrong format for END");
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	log.info(parser.showOpeValues());
+	if (parser.getBoolOpt(HELP)) {	//help info has been requested
+		parser.usage("Builds or queries the per minute rollup sidecar of an OSP file", CMDLINE);
+		return 0;
+	}
+	/// 5- Sets logging level stated in option
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	string fileName = parser.getOperator(OSPF);
+	string rollupName = parser.getStrOpt(ROLLUP);
+	if (rollupName.empty()) rollupName = fileName + ".rollup";
+	/// 6- If a query is requested, prints the rows in the span
+	if (parser.getBoolOpt(QUERY)) {
+		vector<RollupRow> rows;
+		if (!MinuteRollup::readRows(rollupName, (int32_t) (start / 60.0), (int32_t) (end / 60.0), rows)) {
+			log.severe("Cannot read rollup sidecar " + rollupName);
+			return 3;
+		}
+		printRows(rows);
+		log.info("Rows read: " + to_string((long long) rows.size()));
+		return 0;
+	}
+	/// 7- Opens the sidecar and the OSP file, positioned where the previous update ended
+	MinuteRollup rollup;
+	if (!rollup.open(rollupName, fileName, 1440, &log)) {
+		log.severe("Cannot open rollup sidecar " + rollupName);
+		return 3;
+	}
+	FILE* inFile;
+	if ((inFile = fopen(fileName.c_str(), "rb")) == NULL) {
+		log.severe("Cannot open file " + fileName);
+		return 2;
+	}
+	setvbuf(inFile, NULL, _IOFBF, IOBUFSIZE);
+	if (fseeko(inFile, (off_t) rollup.resumeOffset(), SEEK_SET) != 0) {
+		log.warning("Cannot resume at offset " + to_string((long long) rollup.resumeOffset()) + ". Restarting");
+		rollup.restart();
+		rewind(inFile);
+	}
+	/// 8- Computes the rollups in one pass and appends them to the sidecar
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	int n = buildRollup(inFile, rollup, &log);
+	fclose(inFile);
+	bool stored = rollup.close(parser.getBoolOpt(CLOSED)) && n >= 0;
+	double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+	log.info("Messages processed: " + to_string((long long) n) + ". Minutes stored: " + to_string((long long) rollup.rowsStored())
+		+ " in " + to_string((long double) secs) + " s");
+	return stored ? 0 : 3;
+}
+
+/**buildRollup
+ * reads the OSP messages from the current position of the input file to its end, or to the last complete record,
+ * and adds them to the rollup. A partial record at the end is logged and left for the next update.
+ *
+ *@param inFile the OSP file
+ *@param rollup the rollup where messages are added
+ *@param plog the pointer to the Logger
+ *@return the number of messages processed, or -1 if a sidecar write error happened
+ */
+int buildRollup(FILE* inFile, MinuteRollup& rollup, Logger* plog) {
+	unsigned char paylen[2];
+	static unsigned char payload[65536];
+	int n = 0;
+	while (fread(paylen, 2, 1, inFile) == 1) {
+		unsigned int len = (paylen[0] << 8) | paylen[1];
+		if (fread(payload, 1, len, inFile) != len) {
+			//a partial record at the end of a growing file: it will be processed in the next update
+			plog->fine("Partial record of " + to_string((long long) len) + " bytes at the end of input. Left for the next update");
+			break;
+		}
+		if (!rollup.add(payload, len)) {
+			plog->severe("Cannot write the rollup sidecar");
+			return -1;
+		}
+		n++;
+	}
+	return n;
+}
+
+/**printRows
+ * prints to stdout the given rollup rows, one per line, after a line with the column names.
+ *
+ *@param rows the rows to print
+ */
+void printRows(const vector<RollupRow>& rows) {
+	printf("minute;epochs;svs;solutions;fixes;cn0;drift\n");
+	for (vector<RollupRow>::const_iterator it = rows.begin(); it != rows.end(); it++)
+		printf("%s;%u;%u;%u;%u;%.1f;%.1f\n", ArchiveCatalog::gpsTimeTXT(it->minute * 60.0).substr(0, 16).c_str(),
+			it->epochs, it->svs, it->solutions, it->fixes, it->meanCN0, it->meanDrift);
+}
@@ -0,0 +1,301 @@
+/** @file OSPconcat.cpp
+ * Contains the command line program to join OSP files, like the ones split by rotations or restarts of a capture,
+ * keeping records complete and epochs in time order.
+ *<p>Usage:
+ *<p>OSPconcat {options} [OSPinputs]
+ *<p>Options are:
+ *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -o OUTPUT or --output=OUTPUT : Output OSP file. Default value OUTPUT = CONCAT.OSP
+ *Default value for operator is: DATA.OSP . It is a comma separated list of the OSP files to join.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+#include "Utilities.h"
+//from this project
+#include "ArchiveCatalog.h"
+//standard and Linux
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <algorithm>
+
+using namespace std;
+
+//@cond DUMMY
+///The command line format
+const string CMDLINE = "OSPconcat {options} [OSPinputs]";
+///The current program version
+const string MYVER = " V1.0";
+///Seconds in a GPS week
+const double WEEKSECS = 604800.0;
+///The size of the buffer used when the kernel cannot copy file ranges
+const size_t COPYBUFSIZE = 1048576;
+///The parser object to store options and operators passed in the command line
+ArgParser parser;
+//Metavariables for options
+int HELP, LOGLEVEL, OUTPUT;
+//Metavariables for operators
+int OSPIN;
+
+///An input file and the span of its complete records and epochs
+struct InputPart {
+	string name;
+	off_t validEnd;		//the end of the last epoch: the last MID 7 record
+	off_t recordsEnd;	//the end of the last complete record
+	off_t size;			//the file size
+	double first;		//the time of the first epoch (MID 7)
+	double last;		//the time of the last epoch (MID 7)
+	long long epochs;	//number of epochs
+	bool operator<(const InputPart& p) const {return first < p.first;}
+};
+//functions in this file
+bool scanPart(InputPart& part, Logger* plog);
+bool copyPart(const InputPart& part, int outFd, Logger* plog);
+//@endcond
+
+/**main
+ * gets the command line arguments, sets parameters accordingly, and joins the OSP files given into one.
+ *<p>
+ * Each input file is scanned walking its records, mapped in memory, to find the time of its first and last epochs
+ * (MID 7) and the end of its last epoch. Each file is copied up to the end of its last MID 7: a partial record at the
+ * end of a file, as left by a capture interrupted while writing, and the records of an epoch not closed by its MID 7
+ * are not copied. Files without epochs are not copied. A record of length zero followed by data other than zeros is
+ * reported as a corruption, and the join is not done.
+ *<p>
+ * The output file cannot be one of the inputs.
+ *<p>
+ * Inputs are joined in the order of their first epoch, whatever the order given. If the time span of an input
+ * overlaps the span of the previous one, the join is rejected, as epochs would be out of order.
+ *<p>
+ * Record contents are copied with copy_file_range, so the kernel copies data without passing them through user
+ * space, and filesystems supporting it (like XFS or Btrfs) can share the data blocks instead of copying them. When the
+ * kernel cannot copy between the files, data are copied through a buffer.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning:
+ *		- (0) no errors have been detected
+ *		- (1) an error has been detected in arguments, or the output file is also an input
+ *		- (2) error when opening or reading input files, a corrupted record in them, or there are no epochs in them
+ *		- (3) error when creating or writing the output file
+ *		- (4) the time spans of the input files overlap
+ */
+int main(int argc, char* argv[]) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	OUTPUT = parser.addOption("-o", "--output", "OUTPUT", "Output OSP file", "CONCAT.OSP");
+	/// 3- Setups the default values for operators in the command line
+	OSPIN = parser.addOperator("DATA.OSP");
+	/// 4- Parses arguments in the command line extracting options and operators
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	log.info(parser.showOpeValues());
+	if (parser.getBoolOpt(HELP)) {	//help info has been requested
+		parser.usage("Joins OSP files (a comma separated list) keeping records complete and epochs in time order", CMDLINE);
+		return 0;
+	}
+	/// 5- Sets logging level stated in option
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	/// 6- Checks that the output file is not an input, as it is truncated when created
+	vector<string> names = getTokens(parser.getOperator(OSPIN), ',');
+	string outName = parser.getStrOpt(OUTPUT);
+	struct stat outSt, inSt;
+	if (stat(outName.c_str(), &outSt) == 0)
+		for (vector<string>::iterator it = names.begin(); it != names.end(); it++)
+			if (stat(it->c_str(), &inSt) == 0 && inSt.st_dev == outSt.st_dev && inSt.st_ino == outSt.st_ino) {
+				log.severe("Output file " + outName + " is also the input " + *it);
+				return 1;
+			}
+	/// 7- Scans the input files to find their epochs span and the end of their last epoch
+	vector<InputPart> parts;
+	for (vector<string>::iterator it = names.begin(); it != names.end(); it++) {
+		InputPart part;
+		part.name = *it;
+		if (!scanPart(part, &log)) return 2;
+		if (part.epochs == 0) {
+			log.warning("No epochs in " + part.name + ". Not copied");
+			continue;
+		}
+		if (part.recordsEnd != part.size)
+			log.warning("Partial record at the end of " + part.name + ". Trimmed " + to_string((long long) (part.size - part.recordsEnd)) + " bytes");
+		if (part.validEnd != part.recordsEnd)
+			log.warning("Records after the last epoch of " + part.name + ". Trimmed " + to_string((long long) (part.recordsEnd - part.validEnd)) + " bytes");
+		parts.push_back(part);
+	}
+	if (parts.empty()) {
+		log.severe("No epochs in input files");
+		return 2;
+	}
+	/// 8- Sorts inputs by their first epoch, rejecting overlapping spans
+	stable_sort(parts.begin(), parts.end());
+	for (size_t i = 0; i < parts.size(); i++) {
+		log.info(parts[i].name + ": " + to_string(parts[i].epochs) + " epochs from " + ArchiveCatalog::gpsTimeTXT(parts[i].first)
+			+ " to " + ArchiveCatalog::gpsTimeTXT(parts[i].last));
+		if (i > 0 && parts[i].first <= parts[i - 1].last) {
+			log.severe("Time span of " + parts[i].name + " overlaps the span of " + parts[i - 1].name);
+			return 4;
+		}
+	}
+	/// 9- Copies the records of each input, up to its last epoch, to the output file
+	int outFd = open(outName.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	if (outFd < 0) {
+		log.severe("Cannot create file " + outName);
+		return 3;
+	}
+	long long total = 0;
+	for (vector<InputPart>::iterator it = parts.begin(); it != parts.end(); it++) {
+		if (!copyPart(*it, outFd, &log)) {
+			close(outFd);
+			log.severe("Cannot write file " + outName);
+			return 3;
+		}
+		total += it->validEnd;
+	}
+	if (close(outFd) != 0) {
+		log.severe("Cannot write file " + outName);
+		return 3;
+	}
+	log.info("Files joined: " + to_string((long long) parts.size()) + ". Bytes: " + to_string(total) + " into " + outName);
+	return 0;
+}
+
+/**scanPart
+ * walks the records of the given input file to find its first and last epochs, the end of its last epoch, and the end
+ * of its last complete record. The file is mapped in memory: only record lengths and MID 7 payloads are accessed.
+ * A record of length zero is accepted only at the start of a tail filled with zeros, as left by a capture interrupted
+ * after space was allocated.
+ *
+ *@param part the input file, where scan results are set
+ *@param plog the pointer to the Logger
+ *@return true if the file has been scanned, false if it cannot be opened or mapped, or it has a corrupted record
+ */
+bool scanPart(InputPart& part, Logger* plog) {
+	part.validEnd = part.recordsEnd = part.size = 0;
+	part.first = part.last = 0.0;
+	part.epochs = 0;
+	int fd = open(part.name.c_str(), O_RDONLY);
+	struct stat st;
+	if (fd < 0 || fstat(fd, &st) != 0) {
+		plog->severe("Cannot open file " + part.name);
+		if (fd >= 0) close(fd);
+		return false;
+	}
+	part.size = st.st_size;
+	if (part.size == 0) {
+		close(fd);
+		return true;
+	}
+	const unsigned char* data = (const unsigned char*) mmap(NULL, part.size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED) {
+		plog->severe("Cannot map file " + part.name);
+		return false;
+	}
+	madvise((void*) data, part.size, MADV_SEQUENTIAL);
+	off_t pos = 0;
+	bool corrupted = false;
+	while (pos + 2 <= part.size) {
+		off_t len = (data[pos] << 8) | data[pos + 1];
+		if (len == 0) {		//valid only at the start of a zero filled tail
+			for (off_t i = pos; i < part.size && !corrupted; i++) corrupted = data[i] != 0;
+			break;
+		}
+		if (pos + 2 + len > part.size) break;	//a partial record
+		const unsigned char* payload = data + pos + 2;
+		if (payload[0] == 7 && len >= 7) {	//MID 7: extended week and TOW
+			double t = ((payload[1] << 8) | payload[2]) * WEEKSECS
+				+ (((unsigned int) payload[3] << 24) | (payload[4] << 16) | (payload[5] << 8) | payload[6]) / 100.0;
+			if (part.epochs == 0) part.first = t;
+			part.last = t;
+			part.epochs++;
+			part.validEnd = pos + 2 + len;
+		}
+		pos += 2 + len;
+	}
+	part.recordsEnd = pos;
+	munmap((void*) data, part.size);
+	if (corrupted) plog->severe("Corrupted record (length 0) at offset " + to_string((long long) pos) + " of " + part.name);
+	return !corrupted;
+}
+
+/**copyPart
+ * appends the complete records of the given input file to the output file. Data are copied by the kernel with
+ * copy_file_range, or through a buffer if the kernel cannot copy between these files.
+ *
+ *@param part the input file
+ *@param outFd the descriptor of the output file
+ *@param plog the pointer to the Logger
+ *@return true if data have been copied, false otherwise
+ */
+bool copyPart(const InputPart& part, int outFd, Logger* plog) {
+	int inFd = open(part.name.c_str(), O_RDONLY);
+	if (inFd < 0) {
+		plog->severe("Cannot open file " + part.name);
+		return false;
+	}
+	off_t remaining = part.validEnd;
+	bool kernelCopy = true;
+	while (remaining > 0 && kernelCopy) {
+		ssize_t n = copy_file_range(inFd, NULL, outFd, NULL, (size_t) remaining, 0);
+		if (n > 0) remaining -= n;
+		else if (n < 0 && errno == EINTR) continue;
+		else if (n < 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP)) kernelCopy = false;
+		else {
+			close(inFd);
+			return false;
+		}
+	}
+	if (remaining > 0) {	//the kernel cannot copy: copy through a buffer from the current positions
+		plog->fine("Buffered copy of " + part.name);
+		vector<char> buf(COPYBUFSIZE);
+		while (remaining > 0) {
+			ssize_t n = read(inFd, buf.data(), (size_t) min((off_t) COPYBUFSIZE, remaining));
+			if (n < 0 && errno == EINTR) continue;
+			if (n <= 0) break;
+			for (ssize_t done = 0; done < n; ) {
+				ssize_t w = write(outFd, buf.data() + done, n - done);
+				if (w < 0 && errno == EINTR) continue;
+				if (w <= 0) {
+					close(inFd);
+					return false;
+				}
+				done += w;
+			}
+			remaining -= n;
+		}
+	}
+	close(inFd);
+	return remaining == 0;
+}
@@ -0,0 +1,322 @@
+/** @file OSPdiff.cpp
+ * Contains the command line program to compare two OSP files at the epoch and satellite level.
+ *<p>Usage:
+ *<p>OSPdiff.exe {options} [OSPfileA] [OSPfileB]
+ *<p>Options are:
+ *	- -b BIASTOL or --biastol=BIASTOL : Tolerance for clock bias differences, in ns. Default value BIASTOL = 100
+ *	- -c CN0TOL or --cn0tol=CN0TOL : Tolerance for mean C/N0 differences, in dB-Hz. Default value CN0TOL = 3
+ *	- -d DRIFTTOL or --drifttol=DRIFTTOL : Tolerance for clock drift differences, in Hz. Default value DRIFTTOL = 10
+ *	- -e EPOCHTOL or --epochtol=EPOCHTOL : Maximum time difference between epochs to be aligned, in seconds. Default value EPOCHTOL = 0.05
+ *	- -f FREQTOL or --freqtol=FREQTOL : Tolerance for carrier frequency differences, in Hz. Default value FREQTOL = 5
+ *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -o OUTPUT or --output=OUTPUT : File where differences are printed (empty: stdout). Default value OUTPUT is empty
+ *	- -p PSRTOL or --psrtol=PSRTOL : Tolerance for pseudorange differences, in meters. Default value PSRTOL = 10
+ *	- -t PHASETOL or --phasetol=PHASETOL : Tolerance for carrier phase differences, in cycles. Default value PHASETOL = 1
+ *Default values for operators are: A.OSP B.OSP
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+#include "OSPMessage.h"
+//from this project
+#include "ArchiveCatalog.h"
+//standard
+#include <stdio.h>
+#include <math.h>
+#include <chrono>
+
+using namespace std;
+
+//@cond DUMMY
+///The command line format
+const string CMDLINE = "OSPdiff.exe {options} [OSPfileA] [OSPfileB]";
+///The current program version
+const string MYVER = " V1.0";
+///The size of the buffer for each input file
+const size_t IOBUFSIZE = 1048576;
+///Seconds in a GPS week
+const double WEEKSECS = 604800.0;
+///The parser object to store options and operators passed in the command line
+ArgParser parser;
+//Metavariables for options
+int BIASTOL, CN0TOL, DRIFTTOL, EPOCHTOL, FREQTOL, HELP, LOGLEVEL, OUTPUT, PSRTOL, PHASETOL;
+//Metavariables for operators
+int OSPA, OSPB;
+
+///The measurements of a satellite in an epoch (from MID 28)
+struct SatMeas {
+	bool present;
+	double psr;		//pseudorange in m
+	double cph;		//carrier phase in cycles
+	double cfr;		//carrier frequency in Hz
+	double cn0;		//mean C/N0 in dB-Hz
+};
+///The data of an epoch: clock data from the MID 7 closing it, and measurements from the MID 28 preceding it
+struct OSPEpoch {
+	double time;		//GPS seconds from the GPS epoch
+	double drift;		//clock drift in Hz
+	double bias;		//clock bias in ns
+	int nSats;			//number of satellites with measurements
+	unsigned char svs[256];	//the satellites with measurements, to clear them
+	SatMeas sat[256];	//measurements indexed by satellite
+};
+///The differences found
+struct DiffCount {
+	long long matched, onlyA, onlyB, satOnlyA, satOnlyB, deltas;
+};
+///The tolerances for the values compared
+double tolPsr, tolCph, tolCfr, tolCn0, tolDrift, tolBias;
+//functions in this file
+bool nextEpoch(FILE* inFile, OSPEpoch& epoch);
+void compareEpochs(const OSPEpoch& a, const OSPEpoch& b, FILE* out, DiffCount& count);
+void printDelta(FILE* out, double time, int sv, const char* field, double a, double b, double tol, DiffCount& count);
+//@endcond
+
+/**main
+ * gets the command line arguments, sets parameters accordingly, and prints the differences between two OSP files at
+ * the epoch and satellite level.
+ *<p>
+ * Both files are read in a single streaming pass, epoch by epoch. An epoch is made of the MID 28 measurements
+ * received before the MID 7 closing it, which gives the epoch time and clock data. Epochs in both files are aligned
+ * by time with a merge join: epochs whose time differs less than the tolerance stated are compared, and the others are
+ * reported as present in one file only. Within aligned epochs, measurements are matched by satellite in fixed arrays,
+ * reporting satellites present in one file only, and pseudorange, carrier phase, carrier frequency, C/N0, clock drift
+ * and bias differences above the tolerances stated.
+ *<p>
+ * Running time is linear in the size of the files, and memory used does not depend on it.
+ *<p>
+ * Each difference is printed in a line with fields separated by semicolons: type (EPOCH, SAT or DELTA), epoch time,
+ * satellite, and the file where it is present or the name of the value, the values in each file, and their difference.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning:
+ *		- (0) no differences have been found
+ *		- (1) an error has been detected in arguments
+ *		- (2) error when opening the input or output files
+ *		- (3) differences have been found
+ */
+int main(int argc, char* argv[]) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	BIASTOL = parser.addOption("-b", "--biastol", "BIASTOL", "Tolerance for clock bias differences, in ns", "100");
+	CN0TOL = parser.addOption("-c", "--cn0tol", "CN0TOL", "Tolerance for mean C/N0 differences, in dB-Hz", "3");
+	DRIFTTOL = parser.addOption("-d", "--drifttol", "DRIFTTOL", "Tolerance for clock drift differences, in Hz", "10");
+	EPOCHTOL = parser.addOption("-e", "--epochtol", "EPOCHTOL", "Maximum time difference between epochs to be aligned, in seconds", "0.05");
+	FREQTOL = parser.addOption("-f", "--freqtol", "FREQTOL", "Tolerance for carrier frequency differences, in Hz", "5");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	OUTPUT = parser.addOption("-o", "--output", "OUTPUT", "File where differences are printed (empty: stdout)", "");
+	PSRTOL = parser.addOption("-p", "--psrtol", "PSRTOL", "Tolerance for pseudorange differences, in meters", "10");
+	PHASETOL = parser.addOption("-t", "--phasetol", "PHASETOL", "Tolerance for carrier phase differences, in cycles", "1");
+	/// 3- Setups the default values for operators in the command line
+	OSPA = parser.addOperator("A.OSP");
+	OSPB = parser.addOperator("B.OSP");
+	/// 4- Parses arguments in the command line extracting options and operators
+	double tolEpoch;
+	try {
+		parser.parseArgs(argc, argv);
+		tolBias = stod(parser.getStrOpt(BIASTOL));
+		tolCn0 = stod(parser.getStrOpt(CN0TOL));
+		tolDrift = stod(parser.getStrOpt(DRIFTTOL));
+		tolEpoch = stod(parser.getStrOpt(EPOCHTOL));
+		tolCfr = stod(parser.getStrOpt(FREQTOL));
+		tolPsr = stod(parser.getStrOpt(PSRTOL));
+		tolCph = stod(parser.getStrOpt(PHASETOL));
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}  catch (exception& e) {
+		parser.usage("Argument error: wrong tolerance value", CMDLINE);
+		log.severe("Wrong tolerance value");
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	log.info(parser.showOpeValues());
+	if (parser.getBoolOpt(HELP)) {	//help info has been requested
+		parser.usage("Compares two OSP files at the epoch and satellite level", CMDLINE);
+		return 0;
+	}
+	/// 5- Sets logging level stated in option
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	/// 6- Opens the input files and the output one
+	FILE* inA;
+	FILE* inB;
+	FILE* out = stdout;
+	if ((inA = fopen(parser.getOperator(OSPA).c_str(), "rb")) == NULL) {
+		log.severe("Cannot open file " + parser.getOperator(OSPA));
+		return 2;
+	}
+	if ((inB = fopen(parser.getOperator(OSPB).c_str(), "rb")) == NULL) {
+		log.severe("Cannot open file " + parser.getOperator(OSPB));
+		fclose(inA);
+		return 2;
+	}
+	setvbuf(inA, NULL, _IOFBF, IOBUFSIZE);
+	setvbuf(inB, NULL, _IOFBF, IOBUFSIZE);
+	if (!parser.getStrOpt(OUTPUT).empty() && (out = fopen(parser.getStrOpt(OUTPUT).c_str(), "w")) == NULL) {
+		log.severe("Cannot create file " + parser.getStrOpt(OUTPUT));
+		fclose(inA);
+		fclose(inB);
+		return 2;
+	}
+	/// 7- Aligns epochs in both files with a merge join on their time, comparing the aligned ones
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	static OSPEpoch epA, epB;
+	epA.nSats = epB.nSats = 0;
+	DiffCount count = {0, 0, 0, 0, 0, 0};
+	fprintf(out, "type;time;sv;field;A;B;delta\n");
+	bool moreA = nextEpoch(inA, epA);
+	bool moreB = nextEpoch(inB, epB);
+	while (moreA || moreB) {
+		if (moreA && moreB && fabs(epA.time - epB.time) <= tolEpoch) {
+			compareEpochs(epA, epB, out, count);
+			count.matched++;
+			moreA = nextEpoch(inA, epA);
+			moreB = nextEpoch(inB, epB);
+		} else if (moreA && (!moreB || epA.time < epB.time)) {
+			fprintf(out, "EPOCH;%s;;A;;;\n", ArchiveCatalog::gpsTimeTXT(epA.time).c_str());
+			count.onlyA++;
+			moreA = nextEpoch(inA, epA);
+		} else {
+			fprintf(out, "EPOCH;%s;;B;;;\n", ArchiveCatalog::gpsTimeTXT(epB.time).c_str());
+			count.onlyB++;
+			moreB = nextEpoch(inB, epB);
+		}
+	}
+	fclose(inA);
+	fclose(inB);
+	if (out != stdout) fclose(out);
+	else fflush(out);
+	/// 8- Logs the summary of differences
+	double secs = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+	log.info("Epochs aligned: " + to_string(count.matched) + ". Only in A: " + to_string(count.onlyA)
+		+ ". Only in B: " + to_string(count.onlyB) + ". Satellites only in A: " + to_string(count.satOnlyA)
+		+ ". Satellites only in B: " + to_string(count.satOnlyB) + ". Deltas above tolerance: " + to_string(count.deltas)
+		+ ". Time: " + to_string((long double) secs) + " s");
+	return (count.onlyA + count.onlyB + count.satOnlyA + count.satOnlyB + count.deltas) == 0 ? 0 : 3;
+}
+
+/**nextEpoch
+ * reads from the input file the data of the next epoch: the MID 28 measurements up to the MID 7 closing it.
+ * Measurements not followed by a MID 7 before the end of file, and any partial record at the end, are ignored.
+ *
+ *@param inFile the OSP file
+ *@param epoch where the epoch data are returned. Satellites of the previous epoch stored in it are cleared
+ *@return true if an epoch has been read, false if the end of file has been reached
+ */
+bool nextEpoch(FILE* inFile, OSPEpoch& epoch) {
+	OSPMessage message;
+	for (int i = 0; i < epoch.nSats; i++) epoch.sat[epoch.svs[i]].present = false;
+	epoch.nSats = 0;
+	while (message.fill(inFile)) {
+		switch (message.get()) {
+		case 7: {	//MID 7, clock status data: closes the epoch
+			if (message.payloadLen() < 20) break;
+			int week = message.getUShort();
+			epoch.time = week * WEEKSECS + message.getUInt() / 100.0;
+			message.get();		//satellites used
+			epoch.drift = message.getUInt();
+			epoch.bias = message.getUInt();
+			return true;
+		}
+		case 28: {	//MID 28, navigation library measurement data
+			if (message.payloadLen() < 48) break;
+			message.get();		//channel
+			message.getUInt();	//time tag
+			int sv = message.get();
+			SatMeas& sat = epoch.sat[sv];
+			if (!sat.present) {
+				sat.present = true;
+				epoch.svs[epoch.nSats++] = (unsigned char) sv;
+			}
+			message.getDouble();	//GPS software time
+			sat.psr = message.getDouble();
+			sat.cfr = message.getFloat();
+			sat.cph = message.getDouble();
+			message.getUShort();	//time in track
+			message.get();		//sync flags
+			sat.cn0 = 0;
+			for (int i = 0; i < 10; i++) sat.cn0 += message.get();
+			sat.cn0 /= 10;
+			break;
+		}
+		default:
+			break;
+		}
+	}
+	return false;
+}
+
+/**compareEpochs
+ * prints the differences between two aligned epochs: satellites present in only one of them, and values whose
+ * difference is above the tolerance.
+ *
+ *@param a the epoch from file A
+ *@param b the epoch from file B
+ *@param out the output file
+ *@param count the counters of differences to update
+ */
+void compareEpochs(const OSPEpoch& a, const OSPEpoch& b, FILE* out, DiffCount& count) {
+	printDelta(out, a.time, -1, "DRIFT", a.drift, b.drift, tolDrift, count);
+	printDelta(out, a.time, -1, "BIAS", a.bias, b.bias, tolBias, count);
+	for (int i = 0; i < a.nSats; i++) {
+		int sv = a.svs[i];
+		const SatMeas& ma = a.sat[sv];
+		const SatMeas& mb = b.sat[sv];
+		if (!mb.present) {
+			fprintf(out, "SAT;%s;%d;A;;;\n", ArchiveCatalog::gpsTimeTXT(a.time).c_str(), sv);
+			count.satOnlyA++;
+			continue;
+		}
+		printDelta(out, a.time, sv, "PSR", ma.psr, mb.psr, tolPsr, count);
+		printDelta(out, a.time, sv, "PHASE", ma.cph, mb.cph, tolCph, count);
+		printDelta(out, a.time, sv, "FREQ", ma.cfr, mb.cfr, tolCfr, count);
+		printDelta(out, a.time, sv, "CN0", ma.cn0, mb.cn0, tolCn0, count);
+	}
+	for (int i = 0; i < b.nSats; i++) {
+		int sv = b.svs[i];
+		if (a.sat[sv].present) continue;
+		fprintf(out, "SAT;%s;%d;B;;;\n", ArchiveCatalog::gpsTimeTXT(a.time).c_str(), sv);
+		count.satOnlyB++;
+	}
+}
+
+/**printDelta
+ * prints the difference between two values if it is above the tolerance.
+ *
+ *@param out the output file
+ *@param time the epoch time
+ *@param sv the satellite, or -1 for epoch values
+ *@param field the name of the value
+ *@param a the value in file A
+ *@param b the value in file B
+ *@param tol the tolerance
+ *@param count the counters of differences to update
+ */
+void printDelta(FILE* out, double time, int sv, const char* field, double a, double b, double tol, DiffCount& count) {
+	if (fabs(a - b) <= tol) return;
+	if (sv < 0) fprintf(out, "DELTA;%s;;%s;%.3f;%.3f;%.3f\n", ArchiveCatalog::gpsTimeTXT(time).c_str(), field, a, b, a - b);
+	else fprintf(out, "DELTA;%s;%d;%s;%.3f;%.3f;%.3f\n", ArchiveCatalog::gpsTimeTXT(time).c_str(), sv, field, a, b, a - b);
+	count.deltas++;
+}
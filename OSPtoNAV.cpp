@@ -0,0 +1,501 @@
+/** @file OSPtoNAV.cpp
+ * Contains the command line program to generate merged RINEX navigation files from the ephemerides contained in
+ * many OSP files.
+ *<p>Usage:
+ *<p>OSPtoNAV.exe {options} [OSPinputs]
+ *<p>Options are:
+ *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -j JOBS or --jobs=JOBS : Number of threads decoding input files (0 = number of cores). Default value JOBS = 0
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -o OBSERVER or --observer=OBSERVER : Observer name. Default value OBSERVER = OBSERVER
+ *	- -p PGM or --program=PGM : Program used to generate RINEX file. Default value OSPtoNAV
+ *	- -q RUNBY or --runby=RUNBY : Who runs the RINEX file generator. Default value RUNBY = RUNBY
+ *	- -r RINEX or --rinex=RINEX : RINEX file name prefix. Default value RINEX = NAVM
+ *	- -s SYSLST or --selsys=SYSLST : Systems in addition to GPS (R) to be included in the navigation files. Default value an empty list
+ *	- -v VER or --ver=VER : RINEX version to generate (V210, V304). Default value VER = V210
+ *	- -y AGENCY or --agency=AGENCY : Agency name. Default value AGENCY = AGENCY
+ *Default value for operator is: DATA.OSP . It can be an OSP file, a directory containing OSP files, or a comma separated list of them.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+#include "OSPMessage.h"
+#include "Utilities.h"
+#include "GNSSdataFromOSP.h"
+#include "RinexData.h"
+//from this project
+#include "ResultCache.h"
+#include "FileList.h"
+//standard
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+using namespace std;
+
+//@cond DUMMY
+///Program name
+const string THISPRG = "OSPtoNAV";
+///The command line format
+const string CMDLINE = THISPRG + ".exe {options} [OSPinputs]";
+///The current program version
+const string MYVER = " V1.0";
+///The receiver name
+const string RECEIVER_NAME = "SiRF";
+///The parser object to store options and operators passed in the command line
+ArgParser parser;
+//Metavariables for options
+int AGENCY, HELP, JOBS, LOGLEVEL, OBSERVER, PGM, RINEX, RUNBY, SELSYS, VER;
+//Metavariables for operators
+int OSPIN;
+
+///Seconds in a GPS week
+const double WEEKSECS = 604800.0;
+///Bytes of a subframe in MID 15: 10 words of 24 bits, without parity
+const int SFRBYTES = 30;
+
+///The identification of an ephemeris: system and satellite, and time of ephemeris (GPS seconds) and IODE, or the hash
+///of the message contents when these data are not decoded
+struct EphKey {
+	uint64_t satId;	//system in bits 56-63, satellite in bits 48-55, IODE in bits 0-15
+	uint64_t tId;	//time of ephemeris in seconds, or contents hash
+	bool operator==(const EphKey& k) const {return satId == k.satId && tId == k.tId;}
+};
+struct EphKeyHash {
+	size_t operator()(const EphKey& k) const {return (size_t) (k.satId * 0x9E3779B97F4A7C15ULL ^ k.tId);}
+};
+///The concurrent set of ephemerides found, split in shards with their own lock to reduce contention
+const int NSHARDS = 64;
+struct EphSet {
+	mutex mtx[NSHARDS];
+	unordered_set<EphKey, EphKeyHash> keys[NSHARDS];
+	bool insert(const EphKey& k) {
+		size_t s = EphKeyHash()(k) % NSHARDS;
+		lock_guard<mutex> lock(mtx[s]);
+		return keys[s].insert(k).second;
+	}
+};
+EphSet ephSet;
+///An ephemeris to be merged: its system, time for sorting, satellite, and the OSP message containing it
+struct NavRecord {
+	char sys;
+	double time;
+	int sat;
+	string payload;
+	bool operator<(const NavRecord& r) const {
+		if (sys != r.sys) return sys < r.sys;
+		if (time != r.time) return time < r.time;
+		return sat < r.sat;
+	}
+};
+///The earliest MID 7 seen, with the MID 6 preceding it, to set the merged stream header and time
+struct HeadMsgs {
+	string mid6;
+	string mid7;
+	double time;
+};
+//the input files and results
+vector<string> files;				//input file names
+atomic<int> nextFile(0);			//next file to be decoded
+vector<NavRecord> records;			//the ephemerides kept
+string headMID6, headMID7;			//the MID 6 and first MID 7 of the earliest file, to set the header and time
+double headTime = 0.0;				//time of headMID7
+atomic<long long> nFound(0);		//ephemerides found
+atomic<long long> nWrong(0);		//ephemerides with inconsistent subframes
+mutex resultMtx;
+mutex logMtx;
+//functions in this file
+void listInputs(string input);
+void decoder(bool glonass, Logger* plog);
+void decodeFile(int idx, bool glonass, vector<NavRecord>& found, HeadMsgs& head, Logger* plog);
+bool gpsEphKey(const unsigned char* sfr, int sv, int extWeek, EphKey& key, double& toe);
+void packSubframe(const unsigned char* words, unsigned char* sfr);
+unsigned int getBits(const unsigned char* buf, int pos, int len);
+void printNavFile(RinexData& rinex, RinexData::RINEXversion ver, char sysId, Logger* plog);
+//@endcond
+
+/**main
+ * gets the command line arguments, sets parameters accordingly, and generates merged RINEX navigation files from the
+ * ephemerides contained in the OSP files given.
+ *<p>
+ * Input files are decoded in parallel by a pool of threads. They extract GPS ephemerides from MID 15 messages and from
+ * MID 8 50bps subframes 1, 2 and 3 (converted to MID 15 format), and GLONASS ephemerides from MID 70 messages.
+ * Each ephemeris is identified by its system, satellite, time of ephemeris and IODE (GLONASS ones by their message
+ * contents), and it is kept only the first time it is found, using a concurrent hash set shared by all threads.
+ * Ephemerides with inconsistent IODE in their subframes are discarded.
+ *<p>
+ * The ephemerides kept are sorted by system, time and satellite, and written into a merged OSP stream that is
+ * processed by GNSSdataFromOSP to fill a RinexData object, which prints one navigation file per system (or a
+ * single mixed one for version 3.04).
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning:
+ *		- (0) no errors have been detected
+ *		- (1) an error has been detected in arguments
+ *		- (2) there are no OSP input files, or no ephemerides in them
+ *		- (3) error when creating the merged stream or the output files
+ */
+int main(int argc, char* argv[]) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	AGENCY = parser.addOption("-y", "--agency", "AGENCY", "Agency name", "AGENCY");
+	VER = parser.addOption("-v", "--ver", "VER", "RINEX version to generate (V210, V304)", "V210");
+	SELSYS = parser.addOption("-s", "--selsys", "SELSYS", "Systems in addition to GPS (R) to be included in the navigation files", "");
+	RINEX = parser.addOption("-r", "--rinex", "RINEX", "RINEX file name prefix", "NAVM");
+	RUNBY = parser.addOption("-q", "--runby", "RUNBY", "Who runs the RINEX file generation", "RUNBY");
+	PGM = parser.addOption("-p", "--program", "PGM", "Program used to generate RINEX file", (char *) (THISPRG+MYVER).c_str());
+	OBSERVER = parser.addOption("-o", "--observer", "OBSERVER", "Observer name", "OBSERVER");
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	JOBS = parser.addOption("-j", "--jobs", "JOBS", "Number of threads decoding input files (0 = number of cores)", "0");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	/// 3- Setups the default values for operators in the command line
+	OSPIN = parser.addOperator("DATA.OSP");
+	/// 4- Parses arguments in the command line extracting options and operators
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	log.info(parser.showOpeValues());
+	if (parser.getBoolOpt(HELP)) {	//help info has been requested
+		parser.usage("Generates merged RINEX navigation files from the ephemerides in OSP files (files, directories, or a comma separated list of them)", CMDLINE);
+		return 0;
+	}
+	/// 5- Sets logging level stated in option
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	int nJobs = stoi(parser.getStrOpt(JOBS));
+	if (nJobs <= 0) nJobs = (int) thread::hardware_concurrency();
+	if (nJobs <= 0) nJobs = 1;
+	string aStr = parser.getStrOpt(SELSYS);
+	vector<string> selSys = getTokens(aStr.empty()? string("G") : "G," + aStr, ',');
+	bool glonass = find(selSys.begin(), selSys.end(), string("R")) != selSys.end();
+	RinexData::RINEXversion rinexVer = parser.getStrOpt(VER).compare("V304") == 0? RinexData::V304 : RinexData::V210;
+	/// 6- Lists the input files
+	vector<string> inputs = getTokens(parser.getOperator(OSPIN), ',');
+	for (vector<string>::iterator it = inputs.begin(); it != inputs.end(); it++) listInputs(*it);
+	if (files.empty()) {
+		log.severe("No OSP files in " + parser.getOperator(OSPIN));
+		return 2;
+	}
+	/// 7- Runs the decoders, which collect the ephemerides not found before
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	vector<thread> pool;
+	for (int i = 0; i < nJobs; i++) pool.push_back(thread(decoder, glonass, &log));
+	for (size_t i = 0; i < pool.size(); i++) pool[i].join();
+	if (records.empty() || headMID7.empty()) {
+		log.severe("No ephemerides or time data found");
+		return 2;
+	}
+	/// 8- Sorts the ephemerides kept and writes them into a merged OSP stream, after the header and time messages
+	sort(records.begin(), records.end());
+	FILE* merged = tmpfile();
+	if (merged == NULL) {
+		log.severe("Cannot create the merged OSP stream");
+		return 3;
+	}
+	string heads[2] = {headMID6, headMID7};
+	for (int i = 0; i < 2; i++) {
+		if (heads[i].empty()) continue;
+		unsigned char len[2] = {(unsigned char) (heads[i].size() >> 8), (unsigned char) heads[i].size()};
+		fwrite(len, 2, 1, merged);
+		fwrite(heads[i].data(), heads[i].size(), 1, merged);
+	}
+	for (vector<NavRecord>::iterator it = records.begin(); it != records.end(); it++) {
+		unsigned char len[2] = {(unsigned char) (it->payload.size() >> 8), (unsigned char) it->payload.size()};
+		fwrite(len, 2, 1, merged);
+		fwrite(it->payload.data(), it->payload.size(), 1, merged);
+	}
+	if (fflush(merged) != 0) {
+		log.severe("Cannot write the merged OSP stream");
+		fclose(merged);
+		return 3;
+	}
+	rewind(merged);
+	/// 9- Extracts the navigation data from the merged stream and prints the navigation files
+	RinexData rinex(rinexVer, &log);
+	try {
+		rinex.setHdLnData(RinexData::RUNBY, parser.getStrOpt(PGM), parser.getStrOpt(RUNBY));
+		rinex.setHdLnData(RinexData::AGENCY, parser.getStrOpt(OBSERVER), parser.getStrOpt(AGENCY));
+	} catch (string error) {
+		log.severe(error);
+	}
+	GNSSdataFromOSP gnssAcq(RECEIVER_NAME, 0, false, merged, &log);
+	if (!gnssAcq.acqHeaderData(rinex)) log.warning("All, or some header data not acquired");
+	if (glonass) gnssAcq.acqGLOparams();
+	rewind(merged);
+	while (gnssAcq.acqEpochData(rinex, false, false));
+	fclose(merged);
+	if (rinexVer == RinexData::V304) printNavFile(rinex, rinexVer, 'M', &log);
+	else for (vector<string>::iterator it = selSys.begin(); it != selSys.end(); it++) printNavFile(rinex, rinexVer, it->at(0), &log);
+	/// 10- Logs the merge summary
+	double mergeTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	char textBuf[200];
+	sprintf(textBuf, "Files:%d Decoders:%d Ephemerides found:%lld kept:%d inconsistent:%lld Time:%.2fs", (int) files.size(),
+		nJobs, (long long) nFound, (int) records.size(), (long long) nWrong, mergeTime);
+	log.info(string(textBuf));
+	return 0;
+}
+
+//@cond DUMMY
+/**listInputs
+ * fills the input file list with the given file or, if it is a directory, the OSP files in it.
+ *
+ *@param input the input file or directory
+ */
+void listInputs(string input) {
+	struct stat st;
+	if (stat(input.c_str(), &st) != 0) return;
+	if (!S_ISDIR(st.st_mode)) {
+		files.push_back(input);
+		return;
+	}
+	FileList::listDir(input, "OSP", files);
+}
+
+/**decoder
+ * is the body of decoding threads: decodes input files until all of them have been taken, and adds the ephemerides
+ * kept and the earliest MID 7 found in its files to the results.
+ *
+ *@param glonass true if GLONASS ephemerides shall be collected
+ *@param plog the pointer to the logger
+ */
+void decoder(bool glonass, Logger* plog) {
+	vector<NavRecord> found;
+	HeadMsgs head;
+	head.time = 0.0;
+	int idx;
+	while ((idx = nextFile++) < (int) files.size()) decodeFile(idx, glonass, found, head, plog);
+	lock_guard<mutex> lock(resultMtx);
+	records.insert(records.end(), found.begin(), found.end());
+	if (!head.mid7.empty() && (headMID7.empty() || head.time < headTime)) {
+		headMID7 = head.mid7;
+		headTime = head.time;
+		if (!head.mid6.empty()) headMID6 = head.mid6;
+	}
+}
+
+/**decodeFile
+ * decodes the ephemerides in the given input file, keeping the ones not found before in any file.
+ * GPS ephemerides come from MID 15, or from MID 8 subframes 1, 2 and 3 of a satellite, which are converted to a MID 15
+ * message when the three have been received with the same IODE. GLONASS ones come from MID 70.
+ *
+ *@param idx the index of the input file
+ *@param glonass true if GLONASS ephemerides shall be collected
+ *@param found the vector where ephemerides kept are added
+ *@param head the earliest MID 7 found by the calling thread, updated with the ones in this file
+ *@param plog the pointer to the logger
+ */
+void decodeFile(int idx, bool glonass, vector<NavRecord>& found, HeadMsgs& head, Logger* plog) {
+	FILE* inFile = fopen(files[idx].c_str(), "rb");
+	if (inFile == NULL) {
+		lock_guard<mutex> lock(logMtx);
+		plog->warning("Cannot open file " + files[idx]);
+		return;
+	}
+	setvbuf(inFile, NULL, _IOFBF, 1 << 20);
+	unsigned char paylen[2];
+	static thread_local unsigned char payload[65536];
+	static thread_local unsigned char sfr50[256][3][SFRBYTES];	//MID 8 subframes 1 to 3 by satellite
+	static thread_local unsigned char sfrMask[256];				//subframes received by satellite
+	memset(sfrMask, 0, sizeof sfrMask);
+	int extWeek = -1;		//the extended week of the last MID 7
+	double lastTime = 0.0;	//the time of the last MID 7
+	string mid6;
+	NavRecord rec;
+	EphKey key;
+	while (fread(paylen, 2, 1, inFile) == 1) {
+		unsigned int len = (paylen[0] << 8) | paylen[1];
+		if (len == 0 || fread(payload, 1, len, inFile) != len) break;
+		switch (payload[0]) {
+		case 6:		//MID 6: kept for the merged stream header
+			if (mid6.empty()) mid6.assign((const char*) payload, len);
+			break;
+		case 7:		//MID 7: extended week and TOW
+			if (len < 7) break;
+			extWeek = (payload[1] << 8) | payload[2];
+			lastTime = extWeek * WEEKSECS + getBits(payload + 3, 0, 32) / 100.0;
+			if (head.mid7.empty() || lastTime < head.time) {
+				head.mid7.assign((const char*) payload, len);
+				head.time = lastTime;
+				if (!mid6.empty()) head.mid6 = mid6;
+			}
+			break;
+		case 15:	//MID 15: GPS ephemeris, compact subframes 1, 2 and 3
+			if (len < 2 + 3 * SFRBYTES || extWeek < 0) break;
+			nFound++;
+			if (!gpsEphKey(payload + 2, payload[1], extWeek, key, rec.time)) {
+				nWrong++;
+				break;
+			}
+			if (!ephSet.insert(key)) break;
+			rec.sys = 'G';
+			rec.sat = payload[1];
+			rec.payload.assign((const char*) payload, 2 + 3 * SFRBYTES);
+			found.push_back(rec);
+			break;
+		case 8: {	//MID 8: GPS 50bps subframe, 10 words with parity
+			if (len < 43 || extWeek < 0) break;
+			int sv = payload[2];
+			unsigned char sfr[SFRBYTES];
+			packSubframe(payload + 3, sfr);
+			int sfrId = getBits(sfr, 43, 3);	//from the HOW
+			if (sfrId < 1 || sfrId > 3) break;
+			memcpy(sfr50[sv][sfrId - 1], sfr, SFRBYTES);
+			sfrMask[sv] |= 1 << (sfrId - 1);
+			if (sfrMask[sv] != 0x07) break;
+			nFound++;
+			if (!gpsEphKey(sfr50[sv][0], sv, extWeek, key, rec.time)) break;	//subframes of different IODE: wait for more
+			sfrMask[sv] = 0;
+			if (!ephSet.insert(key)) break;
+			rec.sys = 'G';
+			rec.sat = sv;
+			rec.payload.assign(1, (char) 15);
+			rec.payload += (char) sv;
+			rec.payload.append((const char*) sfr50[sv][0], 3 * SFRBYTES);
+			found.push_back(rec);
+			break;
+		}
+		case 70: {	//MID 70: GLONASS data, identified by its contents
+			if (!glonass || len < 3) break;
+			nFound++;
+			Hash64 h;
+			h.update(payload, len);
+			key.satId = ((uint64_t) 'R' << 56) | ((uint64_t) payload[1] << 48);
+			key.tId = h.digest();
+			if (!ephSet.insert(key)) break;
+			rec.sys = 'R';
+			rec.sat = payload[1];
+			rec.time = lastTime;
+			rec.payload.assign((const char*) payload, len);
+			found.push_back(rec);
+			break;
+		}
+		default:
+			break;
+		}
+	}
+	fclose(inFile);
+}
+
+/**gpsEphKey
+ * computes the identification of the GPS ephemeris in the given compact subframes 1, 2 and 3 (10 words of 24 bits
+ * each, without parity), verifying that IODC and IODE in them are consistent.
+ *
+ *@param sfr the subframes 1, 2 and 3 data
+ *@param sv the satellite PRN
+ *@param extWeek the extended GPS week when the ephemeris was received, to solve the week number roll over
+ *@param key where the identification is returned
+ *@param toe where the time of ephemeris, in GPS seconds, is returned
+ *@return true if the subframes are consistent, false otherwise
+ */
+bool gpsEphKey(const unsigned char* sfr, int sv, int extWeek, EphKey& key, double& toe) {
+	unsigned int iodc = getBits(sfr, 168, 8);	//IODC 8 LSB in subframe 1 word 8
+	unsigned int iode2 = getBits(sfr + SFRBYTES, 48, 8);	//IODE in subframe 2 word 3
+	unsigned int iode3 = getBits(sfr + 2 * SFRBYTES, 216, 8);	//IODE in subframe 3 word 10
+	if (iodc != iode2 || iode2 != iode3) return false;
+	int week = getBits(sfr, 48, 10);	//week modulo 1024 in subframe 1 word 3
+	week += ((extWeek - week + 512) / 1024) * 1024;
+	unsigned int toeSecs = getBits(sfr + SFRBYTES, 216, 16) * 16;	//toe in subframe 2 word 10
+	toe = week * WEEKSECS + toeSecs;
+	key.satId = ((uint64_t) 'G' << 56) | ((uint64_t) sv << 48) | iode2;
+	key.tId = (uint64_t) toe;
+	return true;
+}
+
+/**packSubframe
+ * packs the data bits of a MID 8 subframe into the compact format used in MID 15: 10 words of 24 bits.
+ * MID 8 words have 30 bits: 24 data bits and 6 parity bits, preceded by bits D29 and D30 of the previous word. When D30
+ * of the previous word is set, data bits are transmitted inverted.
+ *
+ *@param words the 10 words of the MID 8 message, 4 bytes each
+ *@param sfr where the 30 bytes of the compact subframe are returned
+ */
+void packSubframe(const unsigned char* words, unsigned char* sfr) {
+	for (int i = 0; i < 10; i++) {
+		unsigned int w = getBits(words + 4 * i, 0, 32);
+		unsigned int data = (w >> 6) & 0xFFFFFF;
+		if (w & 0x40000000) data ^= 0xFFFFFF;
+		sfr[3 * i] = (unsigned char) (data >> 16);
+		sfr[3 * i + 1] = (unsigned char) (data >> 8);
+		sfr[3 * i + 2] = (unsigned char) data;
+	}
+}
+
+/**getBits
+ * gives the value of the given bits in a buffer, counting bits from the most significant one of the first byte.
+ *
+ *@param buf the buffer
+ *@param pos the position of the first bit
+ *@param len the number of bits (up to 32)
+ *@return the value
+ */
+unsigned int getBits(const unsigned char* buf, int pos, int len) {
+	unsigned long long v = 0;
+	for (int i = pos / 8; i <= (pos + len - 1) / 8; i++) v = (v << 8) | buf[i];
+	int shift = 7 - (pos + len - 1) % 8;
+	return (unsigned int) ((v >> shift) & ((1ULL << len) - 1));
+}
+//@endcond
+
+/**printNavFile
+ * prints a RINEX navigation file with the navigation data stored in the given RinexData object, for the given system
+ * (or all systems, for version 3.04 files).
+ *
+ *@param rinex is the RinexData object containing navigation data for the file to be printed
+ *@param ver is the RINEX version of the file to be generated
+ *@param sysId is the identification of the satellite system data to be printed
+ *@param plog a pointer to the Logger object where logging messages will be printed
+ */
+void printNavFile(RinexData& rinex, RinexData::RINEXversion ver, char sysId, Logger* plog) {
+	string outFileName;
+	switch (sysId) {
+	case 'G': outFileName = rinex.getNavFileName(parser.getStrOpt(RINEX), "N"); break;
+	case 'R': outFileName = rinex.getNavFileName(parser.getStrOpt(RINEX), "G"); break;
+	case 'M': outFileName = rinex.getNavFileName(parser.getStrOpt(RINEX)); break;
+	default:
+		plog->warning("Cannot print navigation file for system " + string(1, sysId));
+		return;
+	}
+	FILE* navFile;
+	if ((navFile = fopen(outFileName.c_str(), "w")) == NULL) {
+		plog->warning("Cannot create file " + outFileName);
+		return;
+	}
+	try {
+		if (ver == RinexData::V210) rinex.setFilter(vector<string>(1, string(1, sysId)), vector<string>());
+		rinex.printNavHeader(navFile);
+		rinex.printNavEpochs(navFile);
+	} catch (string error) {
+		plog->severe(error);
+	}
+	fclose(navFile);
+	plog->info("Navigation file generated: " + outFileName);
+}
@@ -5,24 +5,30 @@
  *<p>Options are:
  *	- -a or --aend : Append end-of-file comment lines to Rinex file. Default value FALSE
  *	- -b or --bias : Apply receiver clock bias to measurements and time. Default value TRUE
+ *	- -C CACHE or --cache=CACHE : Directory of the conversion result cache (empty: no cache). Default value CACHE is empty
  *	- -c or --glo50bps : Use MID8 GLONASS 50bps data to generate GLONASS navigation file, instead of MID70. Default value FALSE
  *	- -d or --gps50bps : Use MID8 GPS 50bps data to generate nav file, instead of MID15. Default value FALSE
  *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
  *	- -i MINSV or --minsv=MINSV : Minimun satellites in a fix to acquire observations. Default value MINSV = 4
  *	- -j ANTN or --antnum=ANTN : Receiver antenna number. Default value ANTN = Antenna#
+ *	- -K CATALOG or --catalog=CATALOG : Archive catalog file to record the outputs in (empty: no catalog). Not available on Windows. Default value CATALOG is empty
  *	- -k ANTT or --antype=ANTT : Receiver antenna type. Default value ANTT = AntennaType
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
  *	- -m MRKNAM or --mrkname=MRKNAM : Marker name. Default value MRKNAM = MRKNAM
  *	- -n or --nav : Generate RINEX navigation file. Default value FALSE
  *	- -o OBSERVER or --observer=OBSERVER : Observer name. Default value OBSERVER = OBSERVER
+ *	- -P or --profile : Report at exit memory used per subsystem and process peak RSS. Default value FALSE
  *	- -p PGM or --program=PGM : Program used to generate RINEX file. Default value OSPtoRINEX
  *	- -q RUNBY or --runby=RUNBY : Who runs the RINEX file generator. Default value RUNBY = RUNBY
  *	- -r RINEX or --rinex=RINEX : RINEX file name prefix. Default value RINEX = PNT1
  *	- -s SYSLST or --selsys=SYSLST : List of additional systems to GPS (R or S or R,S) to be included in the RINEX files. Default value an empty list
  *	- -u MRKNUM or --mrknum=MRKNUM : Marker number. Default value MRKNUM = MRKNUM
  *	- -v VER or --ver=VER : RINEX version to generate (V210, V304). Default value VER = V210
+ *	- -w WORKERS or --workers=WORKERS : Number of input files decoded at the same time (0 = number of cores). Default value WORKERS = 0
+ *	- -x TRACE or --trace=TRACE : Chrome trace-event file for the processing stages timeline (empty: no trace). Default value TRACE is empty
  *	- -y AGENCY or --agency=AGENCY : Agency name. Default value AGENCY = AGENCY
- *Default value for operator is: DATA.OSP 
+ *	- -z WRITER or --writer=WRITER : Output writer settings: buffer size, preallocation extent size, DIRECT for direct I/O (a comma separated list, empty: defaults). Default value WRITER is empty
+ *Default value for operator is: DATA.OSP . It can be a comma separated list of OSP files, like the hourly files of a day.
  *<p>
  *Copyright 2015, 2021 by Francisco Cancillo & Luis Cancillo
  *<p>
@@ -43,6 +49,12 @@
  *<p>				|Added capability to generate GLONASS navigation files
  *<p>				|Added capability to generate multiple navigation files in V2.10
  *<p>V2.1	|2/2018	|Reviewed to run on Linux
+ *<p>V2.2	|10/2026	|Added conversion result cache
+ *<p>				|Added processing stages trace
+ *<p>				|Added memory profile per subsystem
+ *<p>				|Added archive catalog update
+ *<p>				|Added multiple input files
+ *<p>				|Added output writer with preallocation
  */
 
 //from CommonClasses
@@ -51,6 +63,21 @@
 #include "Utilities.h"
 #include "GNSSdataFromOSP.h"
 #include "RinexData.h"
+#include "OSPMessage.h"
+//from this project
+#include "ResultCache.h"
+#include "TraceLog.h"
+#include "MemProfile.h"
+#include "OutputWriter.h"
+#if !defined(_WIN32) && !defined(WIN32) && !defined(_WIN64) && !defined(WIN64)
+#include "ArchiveCatalog.h"
+#define ARCHIVECAT	///<archive catalog update is available
+#endif
+//standard
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
 
 
 using namespace std;
@@ -61,22 +88,54 @@ const string COMPDATE = __DATE__;
 ///Program name
 const string THISPRG = "OSPtoRINEX";
 ///The command line format
-const string CMDLINE = THISPRG + ".exe {options} [OSPfilename]";
+const string CMDLINE = THISPRG + ".exe {options} [OSPfilename{,OSPfilename}]";
 ///Current program version
-const string MYVER = " V2.1 ";
+const string MYVER = " V2.2 ";
 ///A common message
 const string FILENOK = "Cannot open or create file ";
 ///The receiver name
 const string RECEIVER_NAME = "SiRF";
+///The size of the buffers for input and output files
+const size_t IOBUFSIZE = 65536;
 //The parser object to store options and operators passed in the comman line
 ArgParser parser;
 //Metavariables for options
-int AGENCY, APPEND, ANTN, ANTT, APBIAS, MID8G, MID8R, HELP, LOGLEVEL, NAVI, MINSV, MRKNAM, MRKNUM, OBSERVER, PGM, RINEX, RUNBY, SELSYS, TOFO, VER;
+int AGENCY, APPEND, ANTN, ANTT, APBIAS, CACHE, CATALOG, MID8G, MID8R, HELP, LOGLEVEL, NAVI, MINSV, MRKNAM, MRKNUM, OBSERVER, PGM, PROFILE, RINEX, RUNBY, SELSYS, TOFO, TRACE, VER, WORKERS, WRITER;
 //Metavariables for operators
 int OSPF;
+//The conversion result cache
+ResultCache cache;
+//The RINEX files generated
+vector<string> rinexFiles;
+//If an output file could not be written completely
+bool writeFailed = false;
+///An input file of a multiple input conversion, and the observation epochs decoded from it
+struct InputSession {
+	string name;		//the OSP file name
+	double start;		//the time of its first MID 7, in GPS seconds
+	double end;			//the time of its last MID 7, in GPS seconds
+	FILE* obsBuffer;	//temporary file where the RINEX header and epochs decoded are printed
+	long headerEnd;		//the position in obsBuffer where the epochs start
+	string obsFileName;	//the RINEX observation file name for the data in this input
+	int epochs;			//number of epochs decoded
+	bool operator<(const InputSession& s) const {return start < s.start;}
+};
+vector<InputSession> sessions;
+atomic<int> nextSession(0);
 //functions in this file
 int generateRINEX(FILE*, Logger*);
+int generateMultiRINEX(vector<string>&, Logger*);
+bool setupRinex(RinexData&, vector<string>&, Logger*);
+bool epochSpan(string, double&, double&);
+void decodeSessions();
+void decodeNavigation(RinexData*, bool, bool*, Logger*);
+bool buildNavStream(FILE*);
+string headerLabel(const char*);
+void writeMergedHeader(OutputWriter&);
 void prinfNavFile(RinexData &, RinexData::RINEXversion, char, Logger*);
+FILE* openOutput(OutputWriter&, string);
+bool closeOutput(OutputWriter&, Logger*);
+int exitStatus(int);
 //@endcond 
 /**main
  * gets the command line arguments, sets parameters accordingly and triggers the data acquisition to generate RINEX files.
@@ -92,19 +151,40 @@ void prinfNavFile(RinexData &, RinexData::RINEXversion, char, Logger*);
  *		- (0) no errors have been detected
  *		- (1) an error has been detected in arguments
  *		- (2) error when opening the input file
- *		- (3) error when creating output files or no epoch data exist
+ *		- (3) error when creating or writing output files, or no epoch data exist
+ *		- (4) the time spans of the input files overlap
+ *<p>
+ * When several input files are given, they are sorted by the time of their first epoch and decoded concurrently, each one
+ * into its own epoch buffer. A single observation file is generated, with the header of the earliest input, followed by
+ * the epochs of each input in time order. Inputs without epochs are skipped, and inputs with overlapping time spans
+ * are rejected. The navigation file, if requested, contains the ephemerides of all inputs.
+ *<p>
+ * When a cache directory is given, the outputs of a previous conversion of the same input file with the same options
+ * are reused, if they exist in the cache. Otherwise the outputs generated are stored in the cache.
+ *<p>
+ * Memory allocated is accounted per subsystem (header data, epoch data, navigation data, logging and I/O buffers).
+ * When profile is requested, a report with the memory used by each subsystem and the process peak RSS is printed at exit,
+ * whatever the exit status.
+ *<p>
+ * When an archive catalog is given, the RINEX files generated are recorded in it as generated from the input file
+ * (see OSPCatalog).
  */
 int main(int argc, char* argv[]) {
 	/**The main process sequence follows:*/
 	/// 1- Defines and sets the error logger object
+	MemTag prevTag = MemProfile::setTag(MEM_LOGGING);
 	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + COMPDATE + string(" START"));
+	MemProfile::setTag(prevTag);
 	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	WRITER = parser.addOption("-z", "--writer", "WRITER", "Output writer settings: buffer size, preallocation extent size, DIRECT for direct I/O (a comma separated list, empty: defaults)", "");
 	AGENCY = parser.addOption("-y", "--agency", "AGENCY", "Agency name", "AGENCY");
+	WORKERS = parser.addOption("-w", "--workers", "WORKERS", "Number of input files decoded at the same time (0 = number of cores)", "0");
 	VER = parser.addOption("-v", "--ver", "VER", "RINEX version to generate (V210, V304)", "V210");
 	MRKNUM = parser.addOption("-u", "--mrknum", "MRKNUM", "Marker number", "MRKNUM");
 	SELSYS = parser.addOption("-s", "--selsys", "SELSYS", "Systems from input in addition to GPS (R,S or R or S)", "");
 	RINEX = parser.addOption("-r", "--rinex", "RINEX", "RINEX file name prefix", "PNT1");
 	RUNBY = parser.addOption("-q", "--runby", "RUNBY", "Who runs the RINEX file generation", "RUNBY");
+	PROFILE = parser.addOption("-P", "--profile", "PROFILE", "Report at exit memory used per subsystem and process peak RSS", false);
 	PGM = parser.addOption("-p", "--program", "PGM", "Program used to generate RINEX file", (char *) (THISPRG+MYVER).c_str());
 	OBSERVER = parser.addOption("-o", "--observer", "OBSERVER", "Observer name", "OBSERVER");
 	NAVI = parser.addOption("-n", "--nRINEX", "NAVI", "Generate RINEX navigation file", false);
@@ -115,6 +195,9 @@ int main(int argc, char* argv[]) {
 	MINSV = parser.addOption("-i", "--minsv", "MINSV", "Minimun satellites in a fix to acquire observations", "4");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
 	MID8G = parser.addOption("-d", "--gps50bps", "MID8G", "Use MID8 GPS 50bps data to generate nav file", false);
+	CACHE = parser.addOption("-C", "--cache", "CACHE", "Directory of the conversion result cache (empty: no cache)", "");
+	CATALOG = parser.addOption("-K", "--catalog", "CATALOG", "Archive catalog file to record the outputs in (empty: no catalog)", "");
+	TRACE = parser.addOption("-x", "--trace", "TRACE", "Chrome trace-event file for the processing stages timeline (empty: no trace)", "");
 	MID8R = parser.addOption("-c", "--glo50bps", "MID8R", "Use MID8 GLONASS 50bps data to generate nav file", false);
 	APBIAS = parser.addOption("-b", "--bias", "APBIAS", "Apply receiver clock bias to measurements (and time)", true);
 	APPEND = parser.addOption("-a", "--aend", "APPEND", "Append end-of-file comment lines to Rinex file", false);
@@ -125,31 +208,88 @@ int main(int argc, char* argv[]) {
 		parser.parseArgs(argc, argv);
 	}  catch (string error) {
 		parser.usage("Argument error: " + error, CMDLINE);
-		log.severe(error);
-		return 1;
+		MEMLOG(log.severe(error));
+		return exitStatus(1);
 	}
-	log.info(parser.showOptValues());
-	log.info(parser.showOpeValues());
+	MEMLOG(log.info(parser.showOptValues()));
+	MEMLOG(log.info(parser.showOpeValues()));
 	if (parser.getBoolOpt(HELP)) {
 		//help info has been requested
-		parser.usage("Generates RINEX files from an OSP data file containing SiRF IV receiver messages", CMDLINE);
-		return 0;
+		parser.usage("Generates RINEX files from OSP data files (one, or a comma separated list) containing SiRF IV receiver messages", CMDLINE);
+		return exitStatus(0);
 	}
 	/// 5- Sets logging level stated in option
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
-	/// 6- Opens the OSP binary file
-	FILE* inFile;
+	if (!OutputWriter::configure(parser.getStrOpt(WRITER))) {
+		MEMLOG(log.severe("Incorrect output writer settings " + parser.getStrOpt(WRITER)));
+		return exitStatus(1);
+	}
+	/// 6- If a result cache is used, reuses the outputs of a previous conversion with the same input and options
 	string fileName = parser.getOperator (OSPF);
-	if ((inFile = fopen(fileName.c_str(), "rb")) == NULL) {
-		log.severe(FILENOK + fileName);
-		return 2;
+	vector<string> inputs = getTokens(fileName, ',');
+	bool keyed = cache.open(parser.getStrOpt(CACHE), THISPRG + MYVER);
+	for (vector<string>::iterator it = inputs.begin(); keyed && it != inputs.end(); it++) keyed = cache.addInput(*it);
+	if (keyed) {
+		int keyOpts[] = {AGENCY, ANTN, ANTT, MINSV, MRKNAM, MRKNUM, OBSERVER, PGM, RINEX, RUNBY, SELSYS, VER};
+		const char* keyNames[] = {"AGENCY", "ANTN", "ANTT", "MINSV", "MRKNAM", "MRKNUM", "OBSERVER", "PGM", "RINEX", "RUNBY", "SELSYS", "VER"};
+		for (int i = 0; i < 12; i++) cache.addOption(keyNames[i], parser.getStrOpt(keyOpts[i]));
+		int keyFlags[] = {APPEND, APBIAS, MID8G, MID8R, NAVI};
+		const char* flagNames[] = {"APPEND", "APBIAS", "MID8G", "MID8R", "NAVI"};
+		for (int i = 0; i < 5; i++) cache.addFlag(flagNames[i], parser.getBoolOpt(keyFlags[i]));
+		if (cache.restore(&log)) {
+			MEMLOG(log.info("Outputs reused from cache entry " + cache.key()));
+#ifdef ARCHIVECAT
+			for (vector<string>::iterator it = inputs.begin(); it != inputs.end(); it++)
+				ArchiveCatalog::record(parser.getStrOpt(CATALOG), *it, cache.outputFiles(), &log);
+#endif
+			return exitStatus(0);
+		}
 	}
-	/// 7- Calls generateRINEX to generate RINEX files extracting data from messages in the binary OSP file
-	int n = generateRINEX(inFile, &log);
-	log.info("End of RINEX generation. Epochs read: " + to_string((long long) n));
-	fclose(inFile);
-	return n>0? 0:3;
+	int n;
+	TraceLog::open(parser.getStrOpt(TRACE));
+	if (inputs.size() > 1) {
+		/// 7- If several input files are given, calls generateMultiRINEX to decode them concurrently and merge their data
+		n = generateMultiRINEX(inputs, &log);
+		if (n == -1) return exitStatus(2);
+		if (n == -2) return exitStatus(4);
+	} else {
+		/// 8- Otherwise opens the OSP binary file and calls generateRINEX to generate RINEX files extracting data from it
+		FILE* inFile;
+		IOBuffer inBuffer(IOBUFSIZE);
+		if ((inFile = fopen(fileName.c_str(), "rb")) == NULL) {
+			MEMLOG(log.severe(FILENOK + fileName));
+			return exitStatus(2);
+		}
+		inBuffer.attach(inFile);
+		n = generateRINEX(inFile, &log);
+		fclose(inFile);
+	}
+	MEMLOG(log.info("End of RINEX generation. Epochs read: " + to_string((long long) n)));
+	if (TraceLog::close()) MEMLOG(log.info("Processing trace written to " + parser.getStrOpt(TRACE)));
+	/// 9- Stores the outputs in the result cache, and records them in the archive catalog, if used and all outputs
+	/// have been written
+	if (writeFailed) n = 0;
+	if (n > 0) {
+		cache.store(&log);
+#ifdef ARCHIVECAT
+		for (vector<string>::iterator it = inputs.begin(); it != inputs.end(); it++)
+			ArchiveCatalog::record(parser.getStrOpt(CATALOG), *it, rinexFiles, &log);
+#endif
+	}
+	/// 10- Reports memory used per subsystem, if requested (see exitStatus, used on every exit)
+	return exitStatus(n>0? 0:3);
 }
+
+/**exitStatus reports the memory used per subsystem, if requested, before exiting with the given status.
+ *
+ *@param status the exit status
+ *@return the given exit status
+ */
+int exitStatus(int status) {
+	if (parser.getBoolOpt(PROFILE)) MemProfile::report(stdout);
+	return status;
+}
+
 /**generateRINEX iterates over the input OSP file processing GNSS receiver messages to extract RINEX data and print them.
  *
  *@param inFile is the FILE containing the binary OSP messages
@@ -161,67 +301,53 @@ int generateRINEX(FILE* inFile, Logger* plog) {
 	int epochCount;		//to count the number of epochs processed
 	string outFileName;	//the output file name for RINEX files
 	FILE* obsFile;		//the file where RINEX observation data will be printed
+	OutputWriter obsWriter;	//the writer of obsFile
 	vector<string> selSys;	//the selected systems
-	vector<string> selObs;	//the empty selected observations
-	vector<string> observables = getTokens("C1C,L1C,D1C,S1C", ',');	//the defined observables in OSP
-	bool glonassSel = false;		//if GLONASS data (observation or navigation) are requested or not
 	bool prtNav = parser.getBoolOpt(NAVI);	//if navigation file will be printed or not
 	/// 1- Setups the RinexData object members with data given in command line options
-	string aStr = parser.getStrOpt(SELSYS);	//the selected systems
-	if (aStr.empty()) aStr = "G";
-	else aStr = "G," + aStr;
-	selSys = getTokens(aStr, ',');
-	aStr = parser.getStrOpt(VER);
+	MemScope headerScope(MEM_HEADER);
 	RinexData::RINEXversion rinexVer = RinexData::V210;		//default version is 2.10
-	if (aStr.compare("V304") == 0) rinexVer = RinexData::V304;
+	if (parser.getStrOpt(VER).compare("V304") == 0) rinexVer = RinexData::V304;
 	RinexData rinex(rinexVer, plog);
-	try {
-		rinex.setHdLnData(RinexData::RUNBY, parser.getStrOpt(PGM), parser.getStrOpt(RUNBY));
-		rinex.setHdLnData(RinexData::MRKNAME, parser.getStrOpt(MRKNAM));
-		rinex.setHdLnData(RinexData::MRKNUMBER, parser.getStrOpt(MRKNUM));
-		rinex.setHdLnData(RinexData::ANTTYPE, parser.getStrOpt(ANTN), parser.getStrOpt(ANTT));
-		rinex.setHdLnData(RinexData::ANTHEN, (double) 0.0, (double) 0.0, (double) 0.0);
-		rinex.setHdLnData(RinexData::AGENCY, parser.getStrOpt(OBSERVER), parser.getStrOpt(AGENCY));
-        //rinex.setHdLnData(RinexData::TOFO, string("GPS"));
-		rinex.setHdLnData(RinexData::TOFO, 'G');
-		rinex.setHdLnData(RinexData::WVLEN, (int) 1, (int) 0);
-		for (vector<string>::iterator it = selSys.begin(); it != selSys.end(); it++) {
-			rinex.setHdLnData(RinexData::TOBS, it->at(0), observables);
-			if (it->at(0) == 'R') glonassSel = true;
-		}
-		if (!rinex.setFilter(selSys, selObs)) plog->warning("Error in selected systems. Erroneous data ignored");
-	} catch (string error) {
-			plog->severe(error);
-	}
+	bool glonassSel = setupRinex(rinex, selSys, plog);	//if GLONASS data (observation or navigation) are requested or not
 	/// 2- Setups the GNSSdataFromOSP object used to extract message data from the OSP file
 	GNSSdataFromOSP gnssAcq(RECEIVER_NAME, stoi(parser.getStrOpt(MINSV)), parser.getBoolOpt(APBIAS), inFile, plog);
 	/// 3- Starts data acquisition extracting RINEX header data located in the binary file
 	if(!gnssAcq.acqHeaderData(rinex)) {
-		plog->warning("All, or some header data not acquired");
+		MEMLOG(plog->warning("All, or some header data not acquired"));
 	};
 	if (glonassSel) gnssAcq.acqGLOparams();
 	/// 4- For the observation RINEX file, generate the filename in standard format, create it, print header,
 	outFileName = rinex.getObsFileName(parser.getStrOpt(RINEX));
-	if ((obsFile = fopen(outFileName.c_str(), "w")) == NULL) {
-		plog->severe(FILENOK + outFileName);
+	cache.release(outFileName);
+	if ((obsFile = openOutput(obsWriter, outFileName)) == NULL) {
+		MEMLOG(plog->severe(FILENOK + outFileName));
 		return 0;
 	}
 	try {
 		rinex.printObsHeader(obsFile);
 	/// and iterate over the binary OSP file extracting epoch by epoch data and printing them
+		MemScope epochScope(MEM_EPOCH);
 		epochCount = 0;
 		rewind(inFile);
+		uint64_t tr = TraceLog::mark();	//start time of the stage being traced
 		while (gnssAcq.acqEpochData(rinex, parser.getBoolOpt(MID8G), parser.getBoolOpt(MID8R))) {
+			tr = TraceLog::span(TR_DECODE, tr);
 			rinex.printObsEpoch(obsFile);
+			tr = TraceLog::span(TR_FORMAT, tr);
 			epochCount++;
 		}
 		if (parser.getBoolOpt(APPEND)) rinex.printObsEOF(obsFile);
 	} catch (string error) {
-		plog->severe(error);
+		MEMLOG(plog->severe(error));
+	}
+	if (closeOutput(obsWriter, plog)) {
+		cache.addOutput(outFileName);
+		rinexFiles.push_back(outFileName);
 	}
-	fclose(obsFile);
 	/// 5- If navigation RINEX file requested, generate the filename in standard format, create it, print header,
 	if (prtNav) {
+		MemScope navScope(MEM_NAVIGATION);
 		if (rinexVer == RinexData::V304) {
 			prinfNavFile(rinex, rinexVer, 'M', plog);
 		}
@@ -234,6 +360,325 @@ int generateRINEX(FILE* inFile, Logger* plog) {
 	return epochCount;
 }
 
+/**setupRinex sets in the given RinexData object the header data and filter given in command line options.
+ *
+ *@param rinex the RinexData object to setup
+ *@param selSys where the systems selected are returned
+ *@param plog point to the Logger
+ *@return true if GLONASS data are requested, false otherwise
+ */
+bool setupRinex(RinexData& rinex, vector<string>& selSys, Logger* plog) {
+	vector<string> selObs;	//the empty selected observations
+	vector<string> observables = getTokens("C1C,L1C,D1C,S1C", ',');	//the defined observables in OSP
+	bool glonassSel = false;
+	string aStr = parser.getStrOpt(SELSYS);	//the selected systems
+	if (aStr.empty()) aStr = "G";
+	else aStr = "G," + aStr;
+	selSys = getTokens(aStr, ',');
+	try {
+		rinex.setHdLnData(RinexData::RUNBY, parser.getStrOpt(PGM), parser.getStrOpt(RUNBY));
+		rinex.setHdLnData(RinexData::MRKNAME, parser.getStrOpt(MRKNAM));
+		rinex.setHdLnData(RinexData::MRKNUMBER, parser.getStrOpt(MRKNUM));
+		rinex.setHdLnData(RinexData::ANTTYPE, parser.getStrOpt(ANTN), parser.getStrOpt(ANTT));
+		rinex.setHdLnData(RinexData::ANTHEN, (double) 0.0, (double) 0.0, (double) 0.0);
+		rinex.setHdLnData(RinexData::AGENCY, parser.getStrOpt(OBSERVER), parser.getStrOpt(AGENCY));
+        //rinex.setHdLnData(RinexData::TOFO, string("GPS"));
+		rinex.setHdLnData(RinexData::TOFO, 'G');
+		rinex.setHdLnData(RinexData::WVLEN, (int) 1, (int) 0);
+		for (vector<string>::iterator it = selSys.begin(); it != selSys.end(); it++) {
+			rinex.setHdLnData(RinexData::TOBS, it->at(0), observables);
+			if (it->at(0) == 'R') glonassSel = true;
+		}
+		if (!rinex.setFilter(selSys, selObs)) MEMLOG(plog->warning("Error in selected systems. Erroneous data ignored"));
+	} catch (string error) {
+			MEMLOG(plog->severe(error));
+	}
+	return glonassSel;
+}
+
+/**generateMultiRINEX generates a single set of RINEX files from the data in several OSP files.
+ *<p>
+ * Inputs are sorted by the time of their first epoch (MID 7), and decoded concurrently by a pool of workers, each input
+ * into its own epoch buffer. The observation file is made of the header of the earliest input, with the time of the
+ * last observation taken from the latest input, followed by the epochs in the buffers of each input, in time order. Inputs without epochs are skipped. Inputs shall not overlap in time,
+ * like the files of consecutive sessions: if the span of an input overlaps the span of the previous one, the
+ * conversion is rejected, as epochs would be out of order.
+ * If the navigation file is requested, the ephemeris and time messages of all inputs are merged, in time order, into a
+ * stream decoded at the same time by another thread.
+ *
+ *@param inputs the names of the OSP files
+ *@param plog point to the Logger
+ *@return the number of epochs read, -1 if an input file cannot be opened, or -2 if input time spans overlap
+ */
+int generateMultiRINEX(vector<string>& inputs, Logger* plog) {
+	/**The generateMultiRINEX process sequence follows:*/
+	/// 1- Sorts inputs having epochs by the time of their first epoch, rejecting overlapping spans
+	for (vector<string>::iterator it = inputs.begin(); it != inputs.end(); it++) {
+		InputSession session;
+		session.name = *it;
+		session.obsBuffer = NULL;
+		session.headerEnd = 0;
+		session.epochs = 0;
+		if (!epochSpan(*it, session.start, session.end)) {
+			MEMLOG(plog->severe(FILENOK + *it));
+			return -1;
+		}
+		if (session.start == 0.0) {
+			MEMLOG(plog->warning("No epochs in " + *it + ". Skipped"));
+			continue;
+		}
+		sessions.push_back(session);
+	}
+	if (sessions.empty()) {
+		MEMLOG(plog->severe("No epochs in input files"));
+		return 0;
+	}
+	stable_sort(sessions.begin(), sessions.end());
+	for (size_t i = 1; i < sessions.size(); i++)
+		if (sessions[i].start <= sessions[i - 1].end) {
+			MEMLOG(plog->severe("Time span of " + sessions[i].name + " overlaps the span of " + sessions[i - 1].name));
+			sessions.clear();
+			return -2;
+		}
+	/// 2- If the navigation file is requested, starts a thread to merge and decode the navigation data of all inputs
+	vector<string> selSys;
+	RinexData::RINEXversion rinexVer = RinexData::V210;
+	if (parser.getStrOpt(VER).compare("V304") == 0) rinexVer = RinexData::V304;
+	MemTag prevTag = MemProfile::setTag(MEM_LOGGING);
+	Logger navLog("LogFile.txt", "Navigation ", string());	//the navigation thread has its own logger
+	MemProfile::setTag(prevTag);
+	navLog.setLevel(parser.getStrOpt(LOGLEVEL));
+	RinexData navRinex(rinexVer, &navLog);
+	bool glonassSel = setupRinex(navRinex, selSys, &navLog);
+	bool prtNav = parser.getBoolOpt(NAVI);
+	bool navOk = false;
+	thread navDecoder;
+	if (prtNav) navDecoder = thread(decodeNavigation, &navRinex, glonassSel, &navOk, &navLog);
+	/// 3- Decodes the inputs into their epoch buffers using a pool of workers
+	int nWorkers = stoi(parser.getStrOpt(WORKERS));
+	if (nWorkers <= 0) nWorkers = (int) thread::hardware_concurrency();
+	if (nWorkers <= 0) nWorkers = 1;
+	if (nWorkers > (int) sessions.size()) nWorkers = (int) sessions.size();
+	vector<thread> pool;
+	for (int i = 0; i < nWorkers; i++) pool.push_back(thread(decodeSessions));
+	for (size_t i = 0; i < pool.size(); i++) pool[i].join();
+	/// 4- Creates the observation file and copies to it the merged header and the epochs of all inputs
+	int epochCount = 0;
+	string outFileName = sessions[0].obsFileName;
+	OutputWriter obsWriter;
+	cache.release(outFileName);
+	if (sessions[0].obsBuffer == NULL || openOutput(obsWriter, outFileName) == NULL) {
+		MEMLOG(plog->severe(FILENOK + outFileName));
+	} else {
+		vector<char> buf(IOBUFSIZE);
+		writeMergedHeader(obsWriter);
+		for (vector<InputSession>::iterator it = sessions.begin(); it != sessions.end(); it++) {
+			if (it->obsBuffer == NULL) continue;
+			fseek(it->obsBuffer, it->headerEnd, SEEK_SET);
+			size_t n;
+			while ((n = fread(&buf[0], 1, buf.size(), it->obsBuffer)) > 0) obsWriter.write(&buf[0], n);
+			epochCount += it->epochs;
+			MEMLOG(plog->fine(it->name + ": " + to_string((long long) it->epochs) + " epochs"));
+		}
+		if (closeOutput(obsWriter, plog)) {
+			cache.addOutput(outFileName);
+			rinexFiles.push_back(outFileName);
+		}
+	}
+	for (vector<InputSession>::iterator it = sessions.begin(); it != sessions.end(); it++)
+		if (it->obsBuffer != NULL) fclose(it->obsBuffer);
+	/// 5- If navigation RINEX file requested, waits for the navigation data and prints them
+	if (prtNav) navDecoder.join();
+	if (prtNav && !navOk) MEMLOG(plog->warning("Cannot merge navigation data. Navigation file not generated"));
+	if (prtNav && navOk) {
+		MemScope navScope(MEM_NAVIGATION);
+		if (rinexVer == RinexData::V304) {
+			prinfNavFile(navRinex, rinexVer, 'M', plog);
+		}
+		else {
+			for (vector<string>::iterator it = selSys.begin(); it != selSys.end(); it++) {
+				prinfNavFile(navRinex, rinexVer, it->at(0), plog);
+			}
+		}
+	}
+	return epochCount;
+}
+
+/**epochSpan gives the time of the first and last epochs (MID 7) in the given OSP file.
+ *
+ *@param fileName the OSP file name
+ *@param first where the time of the first epoch is returned, in GPS seconds, or 0 if there are no epochs
+ *@param last where the time of the last epoch is returned, in GPS seconds, or 0 if there are no epochs
+ *@return true if the file has been read, false if it cannot be opened
+ */
+bool epochSpan(string fileName, double& first, double& last) {
+	first = last = 0.0;
+	FILE* inFile = fopen(fileName.c_str(), "rb");
+	if (inFile == NULL) return false;
+	setvbuf(inFile, NULL, _IOFBF, IOBUFSIZE);
+	OSPMessage message;
+	while (message.fill(inFile)) {
+		if (message.get() == 7 && message.payloadLen() >= 7) {
+			last = message.getUShort() * 604800.0;
+			last += message.getUInt() / 100.0;
+			if (first == 0.0) first = last;
+		}
+	}
+	fclose(inFile);
+	return true;
+}
+
+/**decodeSessions is the body of the workers decoding inputs: takes inputs until all of them have been taken, and
+ * decodes each one printing the RINEX header and the epochs in its epoch buffer.
+ * Each worker has its own RinexData and GNSSdataFromOSP objects, and logs messages tagged with the input name.
+ */
+void decodeSessions() {
+	int idx;
+	while ((idx = nextSession++) < (int) sessions.size()) {
+		InputSession& session = sessions[idx];
+		MemTag prevTag = MemProfile::setTag(MEM_LOGGING);
+		Logger wlog("LogFile.txt", session.name + " ", string());
+		MemProfile::setTag(prevTag);
+		wlog.setLevel(parser.getStrOpt(LOGLEVEL));
+		FILE* inFile;
+		IOBuffer inBuffer(IOBUFSIZE);
+		if ((inFile = fopen(session.name.c_str(), "rb")) == NULL) {
+			MEMLOG(wlog.severe(FILENOK + session.name));
+			continue;
+		}
+		inBuffer.attach(inFile);
+		if ((session.obsBuffer = tmpfile()) == NULL) {
+			MEMLOG(wlog.severe("Cannot create epoch buffer"));
+			fclose(inFile);
+			continue;
+		}
+		vector<string> selSys;
+		RinexData::RINEXversion rinexVer = RinexData::V210;
+		if (parser.getStrOpt(VER).compare("V304") == 0) rinexVer = RinexData::V304;
+		MemScope headerScope(MEM_HEADER);
+		RinexData rinex(rinexVer, &wlog);
+		bool glonassSel = setupRinex(rinex, selSys, &wlog);
+		GNSSdataFromOSP gnssAcq(RECEIVER_NAME, stoi(parser.getStrOpt(MINSV)), parser.getBoolOpt(APBIAS), inFile, &wlog);
+		if(!gnssAcq.acqHeaderData(rinex)) MEMLOG(wlog.warning("All, or some header data not acquired"));
+		if (glonassSel) gnssAcq.acqGLOparams();
+		session.obsFileName = rinex.getObsFileName(parser.getStrOpt(RINEX));
+		try {
+			rinex.printObsHeader(session.obsBuffer);
+			session.headerEnd = ftell(session.obsBuffer);
+			MemScope epochScope(MEM_EPOCH);
+			rewind(inFile);
+			uint64_t tr = TraceLog::mark();	//start time of the stage being traced
+			while (gnssAcq.acqEpochData(rinex, parser.getBoolOpt(MID8G), parser.getBoolOpt(MID8R))) {
+				tr = TraceLog::span(TR_DECODE, tr);
+				rinex.printObsEpoch(session.obsBuffer);
+				tr = TraceLog::span(TR_FORMAT, tr);
+				session.epochs++;
+			}
+			if (parser.getBoolOpt(APPEND) && (idx == (int) sessions.size() - 1)) rinex.printObsEOF(session.obsBuffer);
+		} catch (string error) {
+			MEMLOG(wlog.severe(error));
+		}
+		fclose(inFile);
+	}
+}
+
+/**decodeNavigation is the body of the thread extracting navigation data: builds the merged navigation stream of all
+ * inputs and decodes it into the given RinexData object.
+ *
+ *@param navRinex the RinexData object where navigation data are stored
+ *@param glonassSel true if GLONASS data are requested
+ *@param navOk where it is returned true if navigation data have been decoded, false otherwise
+ *@param navLog point to the Logger of the thread
+ */
+void decodeNavigation(RinexData* navRinex, bool glonassSel, bool* navOk, Logger* navLog) {
+	MemScope navScope(MEM_NAVIGATION);
+	FILE* navStream = tmpfile();
+	if (navStream == NULL) return;
+	if (buildNavStream(navStream)) {
+		GNSSdataFromOSP navAcq(RECEIVER_NAME, stoi(parser.getStrOpt(MINSV)), parser.getBoolOpt(APBIAS), navStream, navLog);
+		navAcq.acqHeaderData(*navRinex);
+		if (glonassSel) navAcq.acqGLOparams();
+		rewind(navStream);
+		while (navAcq.acqEpochData(*navRinex, parser.getBoolOpt(MID8G), parser.getBoolOpt(MID8R)));
+		*navOk = true;
+	}
+	fclose(navStream);
+}
+
+/**buildNavStream writes in the given stream the messages of all inputs needed to extract navigation data: the MID 6 and
+ * first MID 7 of the earliest input, and the MID 7, MID 8, MID 15 and MID 70 messages of all inputs, in time order.
+ *
+ *@param navStream the stream where messages are written
+ *@return true if the stream has been written, false otherwise
+ */
+bool buildNavStream(FILE* navStream) {
+	OSPMessage message;
+	unsigned char payload[65536];
+	for (vector<InputSession>::iterator it = sessions.begin(); it != sessions.end(); it++) {
+		FILE* inFile = fopen(it->name.c_str(), "rb");
+		if (inFile == NULL) return false;
+		IOBuffer inBuffer(IOBUFSIZE);
+		inBuffer.attach(inFile);
+		while (message.fill(inFile)) {
+			unsigned int len = message.payloadLen();
+			if (len == 0) continue;		//no MID to check
+			for (unsigned int i = 0; i < len; i++) payload[i] = (unsigned char) message.get();
+			bool needed = payload[0] == 7 || payload[0] == 8 || payload[0] == 15 || payload[0] == 70
+				|| (payload[0] == 6 && it == sessions.begin());
+			if (!needed) continue;
+			unsigned char paylen[2] = {(unsigned char) (len >> 8), (unsigned char) len};
+			fwrite(paylen, 2, 1, navStream);
+			fwrite(payload, 1, len, navStream);
+		}
+		fclose(inFile);
+	}
+	if (fflush(navStream) != 0) return false;
+	rewind(navStream);
+	return true;
+}
+
+/**headerLabel gives the label of the given RINEX header line: the text in columns 61 to 80 without trailing blanks.
+ *
+ *@param line the header line
+ *@return the label of the line, or empty if it has no label
+ */
+string headerLabel(const char* line) {
+	string label = strlen(line) > 60? string(line + 60) : string();
+	size_t end = label.find_last_not_of(" \r\n");
+	return end == string::npos? string() : label.substr(0, end + 1);
+}
+
+/**writeMergedHeader writes the header of the observation file merging several inputs: the header of the earliest one,
+ * with the TIME OF LAST OBS line taken from the header of the latest one. The # OF SATELLITES and PRN / # OF OBS lines
+ * are not written, as they would count the observations in the earliest input only, and they are optional.
+ *
+ *@param obsWriter the writer of the observation file
+ */
+void writeMergedHeader(OutputWriter& obsWriter) {
+	char line[256];
+	//get the TIME OF LAST OBS line of the latest input having an epoch buffer
+	string lastObs;
+	for (vector<InputSession>::reverse_iterator it = sessions.rbegin(); it != sessions.rend(); it++) {
+		if (it->obsBuffer == NULL) continue;
+		fseek(it->obsBuffer, 0, SEEK_SET);
+		while (ftell(it->obsBuffer) < it->headerEnd && fgets(line, sizeof line, it->obsBuffer) != NULL)
+			if (headerLabel(line).compare("TIME OF LAST OBS") == 0) lastObs = string(line);
+		break;
+	}
+	//copy the header of the earliest input, replacing or removing lines not valid for the merged data
+	InputSession& first = sessions[0];
+	fseek(first.obsBuffer, 0, SEEK_SET);
+	while (ftell(first.obsBuffer) < first.headerEnd && fgets(line, sizeof line, first.obsBuffer) != NULL) {
+		string label = headerLabel(line);
+		if (label.compare("# OF SATELLITES") == 0 || label.compare("PRN / # OF OBS") == 0) continue;
+		if (label.compare("TIME OF LAST OBS") == 0) {
+			if (!lastObs.empty()) obsWriter.write(lastObs.c_str(), lastObs.size());
+			continue;
+		}
+		obsWriter.write(line, strlen(line));
+	}
+}
+
 /**prinfNavFile prints a RINEX navigation file from the navigation data stored stored in the given RinexData object.
  *File format will be according the given version, and for the given satellite system if version to be generated is 2.10.
  *
@@ -245,6 +690,7 @@ int generateRINEX(FILE* inFile, Logger* plog) {
 
 void prinfNavFile(RinexData &rinex, RinexData::RINEXversion ver, char sysId, Logger* plog) {
 	FILE* navFile;		//the file where RINEX navigation data will be printed
+	OutputWriter navWriter;	//the writer of navFile
 	string outFileName;	//the output file name for RINEX files
 	string fnameSfx;
 	switch (ver) {
@@ -254,7 +700,7 @@ void prinfNavFile(RinexData &rinex, RinexData::RINEXversion ver, char sysId, Log
 		case 'R': fnameSfx = "G"; break;
 		case 'S': fnameSfx = "H"; break;
 		default:
-			plog->warning("Cannot print RINEX V2.10 navigation file for system " + string(1, sysId));
+			MEMLOG(plog->warning("Cannot print RINEX V2.10 navigation file for system " + string(1, sysId)));
 			return;
 		}
 		outFileName = rinex.getNavFileName(parser.getStrOpt(RINEX), fnameSfx);
@@ -263,8 +709,9 @@ void prinfNavFile(RinexData &rinex, RinexData::RINEXversion ver, char sysId, Log
 		outFileName = rinex.getNavFileName(parser.getStrOpt(RINEX));
 		break;
 	}
-	if ((navFile = fopen(outFileName.c_str(), "w")) == NULL) {
-		plog->warning(FILENOK + outFileName);
+	cache.release(outFileName);
+	if ((navFile = openOutput(navWriter, outFileName)) == NULL) {
+		MEMLOG(plog->warning(FILENOK + outFileName));
 		return;
 	}
 	try {
@@ -272,7 +719,41 @@ void prinfNavFile(RinexData &rinex, RinexData::RINEXversion ver, char sysId, Log
 		rinex.printNavHeader(navFile);
 		rinex.printNavEpochs(navFile);
 	} catch (string error) {
-		plog->severe(error);
+		MEMLOG(plog->severe(error));
+	}
+	if (closeOutput(navWriter, plog)) {
+		cache.addOutput(outFileName);
+		rinexFiles.push_back(outFileName);
+	}
+}
+
+/**openOutput
+ * creates the given output file using the given writer. Its buffer is charged to the MEM_IO subsystem.
+ *
+ *@param writer the writer to be used
+ *@param fileName the name of the file to create
+ *@return the stream to print data into the file, or NULL if it cannot be created
+ */
+FILE* openOutput(OutputWriter& writer, string fileName) {
+	MemScope ioScope(MEM_IO);
+	if (!writer.open(fileName, "w")) return NULL;
+	return writer.stream();
+}
+
+/**closeOutput
+ * closes the file written by the given writer, logging its write throughput.
+ * If the file could not be written completely, it is stated in writeFailed.
+ *
+ *@param writer the writer of the file
+ *@param plog a pointer to the Logger object where logging messages will be printed
+ *@return true if the file has been written completely, false otherwise
+ */
+bool closeOutput(OutputWriter& writer, Logger* plog) {
+	if (writer.close()) {
+		MEMLOG(plog->info(writer.report()));
+		return true;
 	}
-	fclose(navFile);
+	MEMLOG(plog->severe("Write error in " + writer.report()));
+	writeFailed = true;
+	return false;
 }
@@ -4,9 +4,13 @@
  *<p>Usage:
  *<p>OSPtoRTK {options} [OSPfileName]
  *<p>Options are:
+ *	- -C CACHE or --cache=CACHE : Directory of the conversion result cache (empty: no cache). Default value CACHE is empty
  *	- -h or --help : Show usage data. Default value HELP=FALSE
+ *	- -K CATALOG or --catalog=CATALOG : Archive catalog file to record the output in (empty: no catalog). Not available on Windows. Default value CATALOG is empty
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
  *	- -m MINSV or --minsv=MINSV : Minimum satellites in a fix to acquire solution data. Default value MINSV = 4
+ *	- -x TRACE or --trace=TRACE : Chrome trace-event file for the processing stages timeline (empty: no trace). Default value TRACE is empty
+ *	- -z WRITER or --writer=WRITER : Output writer settings: buffer size, preallocation extent size, DIRECT for direct I/O (a comma separated list, empty: defaults). Default value WRITER is empty
  * Default values for operators are: DATA.OSP 
  *<p>
  *Copyright 2015, 2021 by Francisco Cancillo & Luis Cancillo
@@ -25,6 +29,10 @@
  *<p>V1.0	|2/2015	|First release
  *<p>V1.1	|2/2016	|Minor improvements for logging messages
  *<p>V1.2	|2/2018	|Reviewed to run on Linux
+ *<p>V1.3	|10/2026	|Added conversion result cache
+ *<p>				|Added processing stages trace
+ *<p>				|Added archive catalog update
+ *<p>				|Added output writer with preallocation
  */
 
 //from CommonClasses
@@ -33,19 +41,29 @@
 #include "RTKobservation.h"
 #include "GNSSdataFromOSP.h"
 #include "OSPMessage.h"
+//from this project
+#include "ResultCache.h"
+#include "TraceLog.h"
+#include "OutputWriter.h"
+#if !defined(_WIN32) && !defined(WIN32) && !defined(_WIN64) && !defined(WIN64)
+#include "ArchiveCatalog.h"
+#define ARCHIVECAT	///<archive catalog update is available
+#endif
 
 using namespace std;
 
 //@cond DUMMY
+///Program name
+const string THISPRG = "OSPtoRTK";
 ///The command line format
-const string CMDLINE = "OSPtoRTK {options} [OSPfileName]";
-const string MYVER = " V1.2";
+const string CMDLINE = THISPRG + " {options} [OSPfileName]";
+const string MYVER = " V1.3";
 ///The receiver name
 const string RECEIVER_NAME = "SiRF";
 ///The parser object to store options and operators passed in the comman line
 ArgParser parser;
 //Metavariables for options
-int HELP, LOGLEVEL, MINSV;
+int CACHE, CATALOG, HELP, LOGLEVEL, MINSV, TRACE, WRITER;
 //Metavariables for operators
 int OSPF;
 //@endcond 
@@ -63,7 +81,12 @@ void generateRTKobs(FILE*, FILE*, string, string, Logger*);
  *		- (0) no errors have been detected
  *		- (1) an error has been detected in arguments
  *		- (2) error when opening the input file
- *		- (3) error when creating output files, or no epoch data exist
+ *		- (3) error when creating or writing output files, or no epoch data exist
+ *<p>
+ * When a cache directory is given, the output of a previous conversion of the same input file with the same options
+ * is reused, if it exists in the cache. Otherwise the output generated is stored in the cache.
+ *<p>
+ * When an archive catalog is given, the output file is recorded in it as generated from the input file (see OSPCatalog).
  */
 int main(int argc, char** argv) {
 	/**The main process sequence follows:*/
@@ -73,6 +96,10 @@ int main(int argc, char** argv) {
 	MINSV = parser.addOption("-m", "--minsv", "MINSV", "Minimun satellites in a fix to acquire observations", "4");
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data", false);
+	CACHE = parser.addOption("-C", "--cache", "CACHE", "Directory of the conversion result cache (empty: no cache)", "");
+	CATALOG = parser.addOption("-K", "--catalog", "CATALOG", "Archive catalog file to record the output in (empty: no catalog)", "");
+	TRACE = parser.addOption("-x", "--trace", "TRACE", "Chrome trace-event file for the processing stages timeline (empty: no trace)", "");
+	WRITER = parser.addOption("-z", "--writer", "WRITER", "Output writer settings: buffer size, preallocation extent size, DIRECT for direct I/O (a comma separated list, empty: defaults)", "");
 	/// 3- Setups the default values for operators in the command line
 	OSPF = parser.addOperator("DATA.OSP");
 	/// 4- Parses arguments in the command line extracting options and operators
@@ -91,24 +118,55 @@ int main(int argc, char** argv) {
 	}
 	/// 5- Sets logging level stated in option
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
-	/// 6- Opens the OSP binary file
-	FILE* inFile;
+	if (!OutputWriter::configure(parser.getStrOpt(WRITER))) {
+		log.severe("Incorrect output writer settings " + parser.getStrOpt(WRITER));
+		return 1;
+	}
+	/// 6- If a result cache is used, reuses the output of a previous conversion with the same input and options
 	string fileName = parser.getOperator (OSPF);
+	string rtkFileName = fileName + ".pos";
+	ResultCache cache;
+	if (cache.open(parser.getStrOpt(CACHE), THISPRG + MYVER) && cache.addInput(fileName)) {
+		cache.addOption("MINSV", parser.getStrOpt(MINSV));
+		cache.addOption("RTKFILE", rtkFileName);
+		if (cache.restore(&log)) {
+			log.info("Output reused from cache entry " + cache.key());
+#ifdef ARCHIVECAT
+			ArchiveCatalog::record(parser.getStrOpt(CATALOG), fileName, vector<string>(1, rtkFileName), &log);
+#endif
+			return 0;
+		}
+		cache.release(rtkFileName);
+	}
+	/// 7- Opens the OSP binary file
+	FILE* inFile;
 	if ((inFile = fopen(fileName.c_str(), "rb")) == NULL) {
 		log.severe("Cannot open file " + fileName);
 		return 2;
 	}
-	/// 7- Creates the output RTK file
-	string rtkFileName = fileName + ".pos";
-	FILE* rtkFile;
-	if ((rtkFile = fopen(rtkFileName.c_str(), "w")) == NULL) {
+	/// 8- Creates the output RTK file
+	OutputWriter rtkFile;
+	if (!rtkFile.open(rtkFileName, "w") || rtkFile.stream() == NULL) {
 		log.severe("Cannot create file " + rtkFileName);
 		return 3;
 	}
-	/// 8- Generates RTK file calling generateRTKobs to extract data from messages in the binary OSP file and print them
-	generateRTKobs(inFile, rtkFile, fileName, string(argv[0]) + MYVER, &log);
+	/// 9- Generates RTK file calling generateRTKobs to extract data from messages in the binary OSP file and print them
+	TraceLog::open(parser.getStrOpt(TRACE));
+	generateRTKobs(inFile, rtkFile.stream(), fileName, string(argv[0]) + MYVER, &log);
     fclose(inFile);
-    fclose(rtkFile);
+	bool written = rtkFile.close();
+	log.info(rtkFile.report());
+	if (TraceLog::close()) log.info("Processing trace written to " + parser.getStrOpt(TRACE));
+	if (!written) {		//the output is not complete: it is not cached nor cataloged
+		log.severe("Cannot write file " + rtkFileName);
+		return 3;
+	}
+	/// 10- Stores the output in the result cache, and records it in the archive catalog, if used
+	cache.addOutput(rtkFileName);
+	cache.store(&log);
+#ifdef ARCHIVECAT
+	ArchiveCatalog::record(parser.getStrOpt(CATALOG), fileName, vector<string>(1, rtkFileName), &log);
+#endif
 	return 0;
 }
 
@@ -137,8 +195,11 @@ void generateRTKobs(FILE* inFile, FILE* rtkFile, string inFileName, string prgNa
 	rtko.printHeader(rtkFile);
 	rewind(inFile);
 	/// 6- Iterates over the binary OSP file extracting epoch by epoch solution data and printing them
+	uint64_t tr = TraceLog::mark();	//start time of the stage being traced
 	while (gnssAcq.acqEpochData(rtko)) {
+		tr = TraceLog::span(TR_DECODE, tr);
 		rtko.printSolution(rtkFile);
+		tr = TraceLog::span(TR_FORMAT, tr);
 		nEpochs++;
 	}
 	plog->info("End of data extraction. Epochs read: " + to_string((long long) nEpochs));
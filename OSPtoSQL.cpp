@@ -0,0 +1,528 @@
+/** @file OSPtoSQL.cpp
+ * Contains the command line program to export data decoded from OSP binary files into a SQLite database.
+ *<p>Usage:
+ *<p>OSPtoSQL.exe {options} [OSPinput]
+ *<p>Options are:
+ *	- -d DBFILE or --database=DBFILE : SQLite database file where data are exported. Default value DBFILE = OSP.db
+ *	- -h or --help : Show usage data. Default value HELP=FALSE
+ *	- -j JOBS or --jobs=JOBS : Number of threads decoding input files (0 = number of cores). Default value JOBS = 1
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *Default value for operator is: DATA.OSP . It can be an OSP file or a directory containing OSP files.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+#include "OSPMessage.h"
+#include "Utilities.h"
+
+#include "FileList.h"
+//external
+#include <sqlite3.h>
+//standard
+#include <stdio.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+//@cond DUMMY
+///The command line format
+const string CMDLINE = "OSPtoSQL.exe {options} [OSPinput]";
+///The current program version
+const string MYVER = " V1.0";
+///The parser object to store options and operators passed in the command line
+ArgParser parser;
+//Metavariables for options
+int DBFILE, HELP, JOBS, LOGLEVEL;
+//Metavariables for operators
+int OSPIN;
+
+///Tables where decoded data are exported
+enum SqlTable {TB_SOLUTION = 0, TB_CLOCK, TB_MEASUREMENT, TB_EPHEMERIS, NTABLES};
+///Definition of a table: name, columns after file and seq, their types (I integer, R real, B blob), and index columns
+struct TableDef {
+	const char* name;
+	const char* columns;
+	const char* types;
+	const char* index;
+};
+const TableDef tableDefs[NTABLES] = {
+	{"solution", "week,tow,x,y,z,vx,vy,vz,mode1,hdop,mode2,svs", "IRIIIRRRIRII", "week,tow"},	//MID 2
+	{"clock", "week,tow,svs,drift,bias,est", "IRIIII", "week,tow"},							//MID 7
+	{"measurement", "channel,ttag,sv,tsw,psr,cfr,cph,trk,sync,cn0,dri", "IIIRRRRIIRI", "sv,tsw"},	//MID 28
+	{"ephemeris", "mid,sv,data", "IIB", "mid,sv"}												//MID 15 and 70
+};
+///Maximum number of numeric columns in a table
+#define MAXCOLS 12
+///The table of the row sent after the last row of a file, to record it as exported. Its first value is the messages count
+const int FILEEND = NTABLES;
+///A row to be inserted: the table, the input file and message sequence, numeric columns values, and blob column value
+struct SqlRow {
+	int table;
+	int file;
+	int seq;
+	double val[MAXCOLS];
+	string blob;
+};
+typedef vector<SqlRow> RowBatch;
+///Rows in each batch passed from decoders to the writer
+const size_t BATCHROWS = 4096;
+///Maximum number of batches queued for the writer
+const size_t MAXBATCHES = 64;
+///Rows inserted in each database transaction
+const long long TXROWS = 500000;
+//the input files data
+vector<string> files;				//input file names
+vector<long long> fileIds;			//their identifier in the database, or -1 if they were already exported
+atomic<int> nextFile(0);			//next file to be decoded
+//the queue of row batches from decoders to writer
+deque<RowBatch*> batches;
+mutex queueMtx;
+condition_variable notEmptyCv, notFullCv;
+int activeDecoders = 0;
+atomic<bool> aborted(false);		//set when the writer fails
+mutex logMtx;
+//functions in this file
+void listInputs(string input);
+bool execSQL(sqlite3* db, string sql, Logger* plog);
+bool createTables(sqlite3* db, Logger* plog);
+bool registerFiles(sqlite3* db, Logger* plog);
+void decoder(Logger* plog);
+void decodeFile(int idx, Logger* plog);
+void pushBatch(RowBatch* batch);
+long long writeRows(sqlite3* db, Logger* plog);
+//@endcond
+
+/**main
+ * gets the command line arguments, set parameters accordingly and exports data decoded from the OSP files given into
+ * a SQLite database.
+ *<p>
+ * The tables exported are: solution (MID 2), clock (MID 7), measurement (MID 28), and ephemeris (MID 15 and MID 70,
+ * with the raw payload as a blob). All rows include the identifier of the input file, in table file, and the
+ * sequence number of the message in it. Input files already exported are skipped, so new files can be appended to
+ * an existing database.
+ * A file is recorded as exported, setting its number of messages, in the transaction that inserts its last rows.
+ * Rows of files whose export did not end, due to an error or an interruption, are deleted at start, and these
+ * files are exported again.
+ *<p>
+ * Input files are decoded by a pool of threads feeding batches of rows to a single writer, which inserts them using
+ * prepared statements, in large transactions, with the database in WAL mode. Indexes are dropped before loading and
+ * created at the end.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning:
+ *		- (0) no errors have been detected
+ *		- (1) an error has been detected in arguments
+ *		- (2) there are no OSP input files
+ *		- (3) the database cannot be opened or set up
+ *		- (4) error has occurred when writing into the database
+ */
+int main(int argc, char** argv) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	JOBS = parser.addOption("-j", "--jobs", "JOBS", "Number of threads decoding input files (0 = number of cores)", "1");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data", false);
+	DBFILE = parser.addOption("-d", "--database", "DBFILE", "SQLite database file where data are exported", "OSP.db");
+	/// 3- Setups the default values for operators in the command line
+	OSPIN = parser.addOperator("DATA.OSP");
+	/// 4- Parses arguments in the command line extracting options and operators
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	log.info(parser.showOpeValues());
+	if (parser.getBoolOpt(HELP)) {	//help info has been requested
+		parser.usage("Exports data decoded from OSP files (an OSP file or a directory) into a SQLite database", CMDLINE);
+		return 0;
+	}
+	/// 5- Sets logging level stated in option
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	int nJobs = stoi(parser.getStrOpt(JOBS));
+	if (nJobs <= 0) nJobs = (int) thread::hardware_concurrency();
+	if (nJobs <= 0) nJobs = 1;
+	/// 6- Lists the input files
+	listInputs(parser.getOperator(OSPIN));
+	if (files.empty()) {
+		log.severe("No OSP files to export in " + parser.getOperator(OSPIN));
+		return 2;
+	}
+	/// 7- Opens the database, sets it up for bulk loading, and registers the input files
+	sqlite3* db;
+	string dbName = parser.getStrOpt(DBFILE);
+	if (sqlite3_open(dbName.c_str(), &db) != SQLITE_OK) {
+		log.severe("Cannot open database " + dbName + ": " + sqlite3_errmsg(db));
+		sqlite3_close(db);
+		return 3;
+	}
+	if (!execSQL(db, "PRAGMA journal_mode=WAL; PRAGMA synchronous=NORMAL; PRAGMA temp_store=MEMORY; PRAGMA cache_size=-65536;", &log)
+		|| !createTables(db, &log) || !registerFiles(db, &log)) {
+		sqlite3_close(db);
+		return 3;
+	}
+	/// 8- Runs the decoders, and writes the rows they produce until all files are decoded
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	activeDecoders = nJobs;
+	vector<thread> pool;
+	for (int i = 0; i < nJobs; i++) pool.push_back(thread(decoder, &log));
+	long long nRows = writeRows(db, &log);
+	for (size_t i = 0; i < pool.size(); i++) pool[i].join();
+	/// 9- Creates indexes
+	int result = 0;
+	if (nRows < 0) result = 4;
+	else {
+		bool done = true;
+		for (int t = 0; done && t < NTABLES; t++)
+			done = execSQL(db, string("CREATE INDEX IF NOT EXISTS ") + tableDefs[t].name + "_idx ON " + tableDefs[t].name
+				+ "(" + tableDefs[t].index + ")", &log);
+		if (!done) {
+			log.severe("Cannot create indexes: " + string(sqlite3_errmsg(db)));
+			result = 4;
+		}
+	}
+	double loadTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	sqlite3_close(db);
+	/// 10- Logs the export summary
+	char textBuf[200];
+	sprintf(textBuf, "Files:%d Decoders:%d Rows:%lld Time:%.1fs Rows/s:%.0f", (int) files.size(), nJobs,
+		nRows < 0? 0 : nRows, loadTime, nRows > 0 && loadTime > 0? nRows / loadTime : 0.0);
+	log.info(string(textBuf));
+	return result;
+}
+
+//@cond DUMMY
+/**listInputs
+ * fills the input file list with the given file or, if it is a directory, the OSP files in it.
+ *
+ *@param input the input file or directory
+ */
+void listInputs(string input) {
+	struct stat st;
+	if (stat(input.c_str(), &st) != 0) return;
+	if (!S_ISDIR(st.st_mode)) {
+		files.push_back(input);
+		return;
+	}
+	FileList::listDir(input, "OSP", files);
+}
+
+/**execSQL
+ * executes the given SQL statements, logging errors.
+ *
+ *@param db the database
+ *@param sql the statements
+ *@param plog the pointer to the logger
+ *@return true if statements have been executed, false otherwise
+ */
+bool execSQL(sqlite3* db, string sql, Logger* plog) {
+	char* errMsg = NULL;
+	if (sqlite3_exec(db, sql.c_str(), NULL, NULL, &errMsg) == SQLITE_OK) return true;
+	plog->severe("SQL error in " + sql + ": " + (errMsg == NULL? string("unknown") : string(errMsg)));
+	sqlite3_free(errMsg);
+	return false;
+}
+
+/**createTables
+ * creates the export tables, if they do not exist, and drops their indexes to be created after loading.
+ *
+ *@param db the database
+ *@param plog the pointer to the logger
+ *@return true if tables are ready, false otherwise
+ */
+bool createTables(sqlite3* db, Logger* plog) {
+	//messages is NULL while the export of the file has not ended
+	string sql = "CREATE TABLE IF NOT EXISTS file(id INTEGER PRIMARY KEY, name TEXT UNIQUE, messages INTEGER);";
+	for (int t = 0; t < NTABLES; t++) {
+		vector<string> cols = getTokens(tableDefs[t].columns, ',');
+		sql += string("CREATE TABLE IF NOT EXISTS ") + tableDefs[t].name + "(file INTEGER, seq INTEGER";
+		for (size_t c = 0; c < cols.size(); c++) {
+			switch (tableDefs[t].types[c]) {
+			case 'I': sql += ", " + cols[c] + " INTEGER"; break;
+			case 'R': sql += ", " + cols[c] + " REAL"; break;
+			default: sql += ", " + cols[c] + " BLOB"; break;
+			}
+		}
+		sql += string(");DROP INDEX IF EXISTS ") + tableDefs[t].name + "_idx;";
+	}
+	return execSQL(db, sql, plog);
+}
+
+/**registerFiles
+ * registers the input files in the file table, getting their identifiers. Files already registered with their number
+ * of messages were exported before, and are skipped. Files registered without it are the ones whose export did not
+ * end: their rows are deleted and they are registered again, to be exported.
+ *
+ *@param db the database
+ *@param plog the pointer to the logger
+ *@return true if files have been registered, false if a database error happened
+ */
+bool registerFiles(sqlite3* db, Logger* plog) {
+	sqlite3_stmt* stmt;
+	if (sqlite3_prepare_v2(db, "SELECT COUNT(*) FROM file WHERE messages IS NULL", -1, &stmt, NULL) != SQLITE_OK) {
+		plog->severe("Cannot register input files: " + string(sqlite3_errmsg(db)));
+		return false;
+	}
+	long long nIncomplete = sqlite3_step(stmt) == SQLITE_ROW? sqlite3_column_int64(stmt, 0) : 0;
+	sqlite3_finalize(stmt);
+	if (sqlite3_prepare_v2(db, "INSERT OR IGNORE INTO file(name, messages) VALUES(?, NULL)", -1, &stmt, NULL) != SQLITE_OK) {
+		plog->severe("Cannot register input files: " + string(sqlite3_errmsg(db)));
+		return false;
+	}
+	bool done = execSQL(db, "BEGIN", plog);
+	if (done && nIncomplete > 0) {
+		//purge the rows of files not completely exported
+		string sql;
+		for (int t = 0; t < NTABLES; t++)
+			sql += string("DELETE FROM ") + tableDefs[t].name + " WHERE file IN (SELECT id FROM file WHERE messages IS NULL);";
+		done = execSQL(db, sql + "DELETE FROM file WHERE messages IS NULL;", plog);
+		if (done) plog->warning("Rows of incomplete exports deleted. Files: " + to_string((long long) nIncomplete));
+	}
+	for (size_t i = 0; done && i < files.size(); i++) {
+		sqlite3_bind_text(stmt, 1, files[i].c_str(), -1, SQLITE_TRANSIENT);
+		done = sqlite3_step(stmt) == SQLITE_DONE;
+		sqlite3_reset(stmt);
+		if (done && sqlite3_changes(db) == 0) {
+			plog->info("Already exported, skipped: " + files[i]);
+			fileIds.push_back(-1);
+		} else fileIds.push_back((long long) sqlite3_last_insert_rowid(db));
+	}
+	sqlite3_finalize(stmt);
+	done = done && execSQL(db, "COMMIT", plog);
+	if (!done) plog->severe("Cannot register input files: " + string(sqlite3_errmsg(db)));
+	return done;
+}
+
+/**decoder
+ * is the body of decoding threads: decodes input files until all of them have been taken.
+ *
+ *@param plog the pointer to the logger
+ */
+void decoder(Logger* plog) {
+	int idx;
+	while (!aborted && (idx = nextFile++) < (int) files.size()) {
+		if (fileIds[idx] >= 0) decodeFile(idx, plog);
+	}
+	{
+		lock_guard<mutex> lock(queueMtx);
+		activeDecoders--;
+	}
+	notEmptyCv.notify_one();
+}
+
+/**decodeFile
+ * decodes the messages in the given input file, passing to the writer batches with the rows to insert.
+ * When the whole file has been decoded, a FILEEND row with the number of messages is added after its last row.
+ *
+ *@param idx the index of the input file
+ *@param plog the pointer to the logger
+ */
+void decodeFile(int idx, Logger* plog) {
+	FILE* inFile = fopen(files[idx].c_str(), "rb");
+	if (inFile == NULL) {
+		lock_guard<mutex> lock(logMtx);
+		plog->warning("Cannot open file " + files[idx]);
+		return;
+	}
+	OSPMessage message;
+	RowBatch* batch = new RowBatch();
+	batch->reserve(BATCHROWS);
+	SqlRow row;
+	row.file = (int) fileIds[idx];
+	int seq = 0;
+	while (!aborted && message.fill(inFile)) {
+		row.seq = seq++;
+		row.blob.clear();
+		double* v = row.val;
+		int mid = message.get();
+		switch (mid) {
+		case 2:		//MID 2, solution data
+			row.table = TB_SOLUTION;
+			v[2] = message.getInt();			//X, Y, Z in meters
+			v[3] = message.getInt();
+			v[4] = message.getInt();
+			v[5] = message.getShort() / 8.0;	//vX, vY, vZ in m/s
+			v[6] = message.getShort() / 8.0;
+			v[7] = message.getShort() / 8.0;
+			v[8] = message.get();				//mode 1
+			v[9] = message.get() / 5.0;		//HDOP
+			v[10] = message.get();			//mode 2
+			v[0] = message.getUShort();		//week
+			v[1] = message.getUInt() / 100.0;	//TOW in seconds
+			v[11] = message.get();			//satellites used
+			break;
+		case 7:		//MID 7, clock status data
+			row.table = TB_CLOCK;
+			v[0] = message.getUShort();		//extended week
+			v[1] = message.getUInt() / 100.0;	//TOW in seconds
+			v[2] = message.get();				//satellites used
+			v[3] = message.getUInt();			//drift in Hz
+			v[4] = message.getUInt();			//bias in ns
+			v[5] = message.getUInt();			//estimated GPS time in ms
+			break;
+		case 28:	//MID 28, navigation library measurement data
+			row.table = TB_MEASUREMENT;
+			v[0] = message.get();				//channel
+			v[1] = message.getUInt();			//time tag in ms
+			v[2] = message.get();				//satellite
+			v[3] = message.getDouble();		//GPS software time in s
+			v[4] = message.getDouble();		//pseudorange in m
+			v[5] = message.getFloat();		//carrier frequency in Hz
+			v[6] = message.getDouble();		//carrier phase in cycles
+			v[7] = message.getUShort();		//time in track in ms
+			v[8] = message.get();				//sync flags
+			v[9] = 0;
+			for (int i = 0; i < 10; i++) v[9] += message.get();
+			v[9] /= 10;						//mean C/N0 in dB-Hz
+			v[10] = message.getUShort();		//delta range interval in ms
+			break;
+		case 15:	//MID 15, ephemeris data
+		case 70:	//MID 70, GLONASS ephemeris or almanac. SID instead of satellite
+			row.table = TB_EPHEMERIS;
+			v[0] = mid;
+			v[1] = message.get();
+			for (unsigned int i = 2; i < message.payloadLen(); i++) row.blob += (char) message.get();
+			break;
+		default:
+			continue;
+		}
+		batch->push_back(row);
+		if (batch->size() == BATCHROWS) {
+			pushBatch(batch);
+			batch = new RowBatch();
+			batch->reserve(BATCHROWS);
+		}
+	}
+	if (!aborted) {
+		row.table = FILEEND;
+		row.val[0] = seq;
+		batch->push_back(row);
+	}
+	if (batch->empty()) delete batch;
+	else pushBatch(batch);
+	fclose(inFile);
+	lock_guard<mutex> lock(logMtx);
+	plog->fine("Decoded " + files[idx] + " messages:" + to_string((long long) seq));
+}
+
+/**pushBatch
+ * places a batch of rows in the writer queue, waiting while it is full.
+ *
+ *@param batch the batch of rows
+ */
+void pushBatch(RowBatch* batch) {
+	{
+		unique_lock<mutex> lock(queueMtx);
+		notFullCv.wait(lock, [] {return batches.size() < MAXBATCHES || aborted;});
+		batches.push_back(batch);
+	}
+	notEmptyCv.notify_one();
+}
+
+/**writeRows
+ * inserts in the database the rows in batches queued by decoders, until all decoders end.
+ * Rows are inserted using a prepared statement per table, and committed each TXROWS rows.
+ * A FILEEND row sets the number of messages of its file in the same transaction, recording it as exported.
+ * When an error happens, decoders are aborted and remaining batches discarded.
+ *
+ *@param db the database
+ *@param plog the pointer to the logger
+ *@return the number of rows inserted, or -1 if a database error happened
+ */
+long long writeRows(sqlite3* db, Logger* plog) {
+	sqlite3_stmt* stmts[NTABLES + 1];
+	bool done = true;
+	for (int t = 0; t < NTABLES; t++) {
+		string sql = string("INSERT INTO ") + tableDefs[t].name + " VALUES(?, ?";
+		for (size_t c = 0; tableDefs[t].types[c] != 0; c++) sql += ", ?";
+		sql += ")";
+		stmts[t] = NULL;
+		done = done && sqlite3_prepare_v2(db, sql.c_str(), -1, &stmts[t], NULL) == SQLITE_OK;
+	}
+	stmts[FILEEND] = NULL;
+	done = done && sqlite3_prepare_v2(db, "UPDATE file SET messages=? WHERE id=?", -1, &stmts[FILEEND], NULL) == SQLITE_OK;
+	if (!done) plog->severe("Cannot prepare insert statements: " + string(sqlite3_errmsg(db)));
+	done = done && execSQL(db, "BEGIN", plog);
+	if (!done) aborted = true;
+	long long nRows = 0;
+	long long txRows = 0;
+	while (true) {
+		RowBatch* batch;
+		{
+			unique_lock<mutex> lock(queueMtx);
+			notEmptyCv.wait(lock, [] {return !batches.empty() || activeDecoders == 0;});
+			if (batches.empty()) break;
+			batch = batches.front();
+			batches.pop_front();
+		}
+		notFullCv.notify_one();
+		long long batchRows = 0;
+		for (size_t r = 0; done && r < batch->size(); r++) {
+			SqlRow& row = (*batch)[r];
+			sqlite3_stmt* stmt = stmts[row.table];
+			if (row.table == FILEEND) {
+				sqlite3_bind_int64(stmt, 1, (sqlite3_int64) row.val[0]);
+				sqlite3_bind_int(stmt, 2, row.file);
+				done = sqlite3_step(stmt) == SQLITE_DONE;
+				sqlite3_reset(stmt);
+				continue;
+			}
+			const char* types = tableDefs[row.table].types;
+			sqlite3_bind_int(stmt, 1, row.file);
+			sqlite3_bind_int(stmt, 2, row.seq);
+			for (int c = 0; types[c] != 0; c++) {
+				switch (types[c]) {
+				case 'I': sqlite3_bind_int64(stmt, c + 3, (sqlite3_int64) row.val[c]); break;
+				case 'R': sqlite3_bind_double(stmt, c + 3, row.val[c]); break;
+				default: sqlite3_bind_blob(stmt, c + 3, row.blob.data(), (int) row.blob.size(), SQLITE_STATIC); break;
+				}
+			}
+			done = sqlite3_step(stmt) == SQLITE_DONE;
+			sqlite3_reset(stmt);
+			batchRows++;
+			if (++txRows == TXROWS) {
+				done = done && execSQL(db, "COMMIT", plog) && execSQL(db, "BEGIN", plog);
+				txRows = 0;
+			}
+		}
+		if (done) nRows += batchRows;
+		else if (!aborted) {
+			lock_guard<mutex> lock(logMtx);
+			plog->severe("Database write error: " + string(sqlite3_errmsg(db)));
+			aborted = true;
+		}
+		if (aborted) notFullCv.notify_all();
+		delete batch;
+	}
+	done = done && execSQL(db, "COMMIT", plog);
+	for (int t = 0; t <= FILEEND; t++) sqlite3_finalize(stmts[t]);
+	return done? nRows : -1;
+}
+//@endcond
@@ -4,8 +4,10 @@
  *Usage:
  *<p>OSPtoTXT.exe {options} [OSPfileName]
  *<p>Options are:
+ *	- -f or --follow : Follow the growing OSP file, printing messages as they are completed, until interrupted. Not available on Windows. Default value FOLLOW=FALSE
  *	- -h or --help : Show usage data. Default value HELP=FALSE
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -x TRACE or --trace=TRACE : Chrome trace-event file for the processing stages timeline (empty: no trace). Default value TRACE is empty
  *Default values for operators are: DATA.OSP 
  *<p>
  *Copyright 2015, 2021 by Francisco Cancillo & Luis Cancillo
@@ -24,6 +26,8 @@
  *<p>V1.0	|2/2015	|First release
  *<p>V1.1	|2/2016	|Minor changes to improve logging
  *<p>V1.2	|2/2018	|Reviewed to run on Linux
+ *<p>V1.3	|10/2026	|Added processing stages trace
+ *<p>				|Added follow mode
  */
 
 //from CommonClasses
@@ -31,6 +35,17 @@
 #include "Logger.h"
 #include "OSPMessage.h"
 #include "Utilities.h"
+#include "TraceLog.h"
+//Environment dependent: follow mode uses inotify
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <errno.h>
+#define FOLLOWMODE	///<follow mode is available
+#endif
 
 using namespace std;
 
@@ -38,16 +53,23 @@ using namespace std;
 ///The command line format
 const string CMDLINE = "OSPtoTXT.exe {options} [OSPfileName]";
 ///The current version of this program
-const string MYVER = " V1.2";
+const string MYVER = " V1.3";
 ///The parser object to store options and operators passed in the command line
 ArgParser parser;
 //Metavariables for options
-int HELP, LOGLEVEL;	//the metavariables for the command line options 
+int FOLLOW, HELP, LOGLEVEL, TRACE;	//the metavariables for the command line options 
 //Metavariables for operators
 int OSPF;		//metavariables for the command line operands
+#ifdef FOLLOWMODE
+int notifyFd = -1;						//the inotify descriptor watching the input file in follow mode
+volatile sig_atomic_t followEnd = 0;	//set when follow mode shall end
+off_t followSize = 0;					//the input file size at the last check in follow mode
+#endif
 //@endcond 
 //functions in this file
-int extractMsgs(FILE* , Logger*);
+int extractMsgs(FILE* , bool, Logger*);
+bool startFollow(string fileName, Logger* plog);
+bool waitRecord(FILE* inFile, Logger* plog);
 
 /**main
  * gets the command line arguments, set parameters accordingly and performs the data acquisition for printing them.
@@ -58,6 +80,11 @@ int extractMsgs(FILE* , Logger*);
  *  - Payload parameter values for relevant messages used to generate RINEX or RTK files (MIDs 2, 6, 7, 8, 11, 12, 15, 28, 50, 56, 64, 68, 75)
  *  - Payload bytes in hexadecimal, for MID 255
  * Output data are sent to the standard output (stdout file), which could be redirected.
+ *<p>
+ * In follow mode the input file can be growing, as when it is being written by RXtoOSP. Changes in the file are
+ * watched with inotify, and each record is printed as soon as it is complete, flushing stdout. Partial records
+ * at the end of the file are left unread until completed. Follow mode ends when the process is interrupted
+ * (SIGINT or SIGTERM), or the file is deleted or moved.
  *
  *@param argc the number of arguments passed from the command line
  *@param argv the array of arguments passed from the command line
@@ -65,6 +92,7 @@ int extractMsgs(FILE* , Logger*);
  *		- (0) no errors have been detected
  *		- (1) an error has been detected in arguments
  *		- (2) error when opening the input file
+ *		- (3) follow mode cannot be started
  */
 int main(int argc, char* argv[]) {
 	/**The main process sequence follows:*/
@@ -73,6 +101,8 @@ int main(int argc, char* argv[]) {
 	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data", false);
+	FOLLOW = parser.addOption("-f", "--follow", "FOLLOW", "Follow the growing OSP file, printing messages as they are completed, until interrupted", false);
+	TRACE = parser.addOption("-x", "--trace", "TRACE", "Chrome trace-event file for the processing stages timeline (empty: no trace)", "");
 	/// 3- Setups the default values for operators in the command line
 	OSPF = parser.addOperator("DATA.OSP");
 	/// 4- Parses arguments in the command line extracting options and operators
@@ -98,9 +128,17 @@ int main(int argc, char* argv[]) {
 		log.severe("Cannot open file " + fileName);
 		return 2;
 	}
-	/// 7- Call extractMsgs to extract messages from the binary OSP file and print contents
-	int n = extractMsgs(inFile, &log);
+	/// 7- If follow mode is requested, starts watching changes in the input file
+	bool follow = parser.getBoolOpt(FOLLOW);
+	if (follow && !startFollow(fileName, &log)) {
+		fclose(inFile);
+		return 3;
+	}
+	/// 8- Call extractMsgs to extract messages from the binary OSP file and print contents
+	TraceLog::open(parser.getStrOpt(TRACE));
+	int n = extractMsgs(inFile, follow, &log);
 	fclose(inFile);
+	if (TraceLog::close()) log.info("Processing trace written to " + parser.getStrOpt(TRACE));
 	log.info("End of data extraction. Messages read: " + to_string((long long) n));
 	return 0;
 }
@@ -110,15 +148,18 @@ int main(int argc, char* argv[]) {
  * The OSP binary file contain OSP messages (see SiRF IV ICD for details) 
  *
  * @param inFile the pointer to the OSP binary FILE to read
+ * @param follow true if the file is growing, and extraction shall wait for new records
  * @param plog the pointer to the Logger object
  * @return the number of messages read
  */
-int extractMsgs(FILE* inFile, Logger* plog) {
+int extractMsgs(FILE* inFile, bool follow, Logger* plog) {
 	OSPMessage message;
 	int mid;
 	int nMessages = 0;
+	uint64_t tr = TraceLog::mark();	//start time of the stage being traced
 	///For each input message, the following data are printed:
-	while (message.fill(inFile)) {
+	while ((!follow || waitRecord(inFile, plog)) && message.fill(inFile)) {
+		tr = TraceLog::span(TR_READ, tr);
 		nMessages++;
 		mid = message.get();
 		/// - for all messages, MID and payload length
@@ -228,7 +269,117 @@ int extractMsgs(FILE* inFile, Logger* plog) {
 			break;
 		}
 		printf("\n");
+		if (follow) fflush(stdout);
+		tr = TraceLog::span(TR_FORMAT, tr);
 	}
 	return nMessages;
 }
 
+#ifdef FOLLOWMODE
+//@cond DUMMY
+/**onSignal
+ * handles the signals ending follow mode.
+ */
+static void onSignal(int) {
+	followEnd = 1;
+}
+//@endcond
+
+/**startFollow
+ * starts watching changes in the input file with inotify, and sets the handlers of the signals ending follow mode.
+ *
+ *@param fileName the input file name
+ *@param plog the pointer to the Logger object
+ *@return true if follow mode has been started, false otherwise
+ */
+bool startFollow(string fileName, Logger* plog) {
+	notifyFd = inotify_init1(IN_CLOEXEC);
+	if (notifyFd < 0 || inotify_add_watch(notifyFd, fileName.c_str(), IN_MODIFY | IN_ATTRIB | IN_MOVE_SELF) < 0) {
+		plog->severe("Cannot watch changes in file " + fileName);
+		return false;
+	}
+	struct sigaction sa;
+	sa.sa_handler = onSignal;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = 0;	//no SA_RESTART: poll shall be interrupted
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	plog->info("Following changes in file " + fileName);
+	return true;
+}
+
+/**waitRecord
+ * waits until the input file contains a complete record (payload length and payload) after the current position.
+ * The position is not changed: the payload length is read at the current position without using the stream.
+ * The file size is only checked when the record is not complete in the size known, and while the record is not
+ * complete, the process sleeps waiting for inotify events.
+ *
+ *@param inFile the pointer to the OSP binary FILE being read
+ *@param plog the pointer to the Logger object
+ *@return true if a complete record is available, false if follow mode has ended
+ */
+bool waitRecord(FILE* inFile, Logger* plog) {
+	unsigned char lenBuf[2];
+	char events[4096];
+	struct stat st;
+	bool gone = false;		//the file has been deleted or moved
+	off_t pos = ftello(inFile);
+	if (pos < 0) return false;
+	off_t recSize = 0;		//the record size, once its payload length has been read
+	while (followEnd == 0) {
+		if (recSize == 0 && followSize - pos >= 2) {
+			if (pread(fileno(inFile), lenBuf, 2, pos) != 2) return false;
+			recSize = 2 + ((lenBuf[0] << 8) | lenBuf[1]);
+		}
+		if (recSize != 0 && followSize - pos >= recSize) {
+			clearerr(inFile);
+			return true;
+		}
+		if (fstat(fileno(inFile), &st) != 0) return false;
+		if (st.st_size != followSize) {
+			followSize = st.st_size;
+			continue;
+		}
+		if (gone || st.st_nlink == 0) break;	//while the file is open, deletion only changes its link count
+		struct pollfd pfd;
+		pfd.fd = notifyFd;
+		pfd.events = POLLIN;
+		if (poll(&pfd, 1, -1) < 0) {
+			if (errno == EINTR) continue;
+			return false;
+		}
+		ssize_t len = read(notifyFd, events, sizeof events);
+		for (ssize_t i = 0; i < len; ) {
+			struct inotify_event* ev = (struct inotify_event*) (events + i);
+			if (ev->mask & IN_MOVE_SELF) gone = true;
+			i += sizeof(struct inotify_event) + ev->len;
+		}
+	}
+	plog->info(followEnd == 0? "Followed file deleted or moved" : "Follow mode interrupted");
+	return false;
+}
+#else
+/**startFollow
+ * reports that follow mode is not available in this platform.
+ *
+ *@param fileName the input file name
+ *@param plog the pointer to the Logger object
+ *@return false
+ */
+bool startFollow(string fileName, Logger* plog) {
+	plog->severe("Follow mode is not available in this platform");
+	return false;
+}
+
+/**waitRecord
+ * is not used in this platform, where follow mode is not available.
+ *
+ *@param inFile the pointer to the OSP binary FILE being read
+ *@param plog the pointer to the Logger object
+ *@return false
+ */
+bool waitRecord(FILE* inFile, Logger* plog) {
+	return false;
+}
+#endif
+
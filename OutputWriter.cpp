@@ -0,0 +1,359 @@
+/** @file OutputWriter.cpp
+ * Contains the implementation of the OutputWriter class.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#include "OutputWriter.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "Utilities.h"
+
+#if defined(__linux__) && defined(__GLIBC__)
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#define FDWRITER	///<the file is written with its own descriptor, preallocation, and optional direct I/O
+#endif
+
+//@cond DUMMY
+//the alignment of buffers and writes for direct I/O
+static const size_t BLOCKSIZE = 4096;
+//the minimum buffer size
+static const size_t MINBUFSIZE = 4096;
+
+size_t OutputWriter::bufferSize = 1048576;
+uint64_t OutputWriter::extentSize = 16777216;
+bool OutputWriter::directIO = false;
+
+#ifdef FDWRITER
+//the write function of the stream given by stream
+static ssize_t cookieWrite(void* writer, const char* data, size_t len) {
+	return ((OutputWriter*) writer)->write(data, len) ? (ssize_t) len : 0;
+}
+#endif
+
+//the size in bytes stated in the given text: a number optionally followed by K, M or G. Returns 0 if not valid
+static uint64_t parseSize(string txt) {
+	char* end;
+	unsigned long long n = strtoull(txt.c_str(), &end, 10);
+	if (end == txt.c_str()) return 0;
+	if (*end == 'K' || *end == 'k') n <<= 10;
+	else if (*end == 'M' || *end == 'm') n <<= 20;
+	else if (*end == 'G' || *end == 'g') n <<= 30;
+	else if (*end != 0) return 0;
+	if (*end != 0 && *(end + 1) != 0) return 0;
+	return n;
+}
+//@endcond
+
+/**OutputWriter
+ * constructs a closed writer.
+ */
+OutputWriter::OutputWriter() {
+	fd = tailFd = -1;
+	file = NULL;
+	cookie = NULL;
+	memory = buffer = NULL;
+	bufLen = 0;
+	direct = failed = false;
+	fileOffset = size = written = allocated = nWrites = nExtents = 0;
+	writeSeconds = openSeconds = 0.0;
+}
+
+OutputWriter::~OutputWriter() {
+	if (isOpen()) close();
+	delete[] memory;
+}
+
+/**configure
+ * sets the buffer size, the preallocation extent size and the use of direct I/O for the writers opened later.
+ * The settings are given as a comma separated list: BUFFER,EXTENT,DIRECT. Sizes are in bytes, optionally followed
+ * by K, M or G, and an extent of 0 means no preallocation. Any item can be omitted (like ",64M" or "DIRECT"), keeping
+ * its default value: 1M buffer, 16M extents, no direct I/O.
+ *
+ *@param settings the list of settings, or empty to keep the defaults
+ *@return true if the settings are correct, false otherwise
+ */
+bool OutputWriter::configure(string settings) {
+	vector<string> items = getTokens(settings, ',');
+	for (size_t i = 0; i < items.size(); i++) {
+		if (items[i].empty()) continue;
+		if (items[i].compare("DIRECT") == 0) {
+			directIO = true;
+			continue;
+		}
+		uint64_t n = parseSize(items[i]);
+		if (i == 0 && n >= MINBUFSIZE) bufferSize = (size_t) ((n + BLOCKSIZE - 1) / BLOCKSIZE * BLOCKSIZE);
+		else if (i == 1 && (n > 0 || items[i].compare("0") == 0)) extentSize = n;
+		else return false;
+	}
+	return true;
+}
+
+/**open
+ * opens the given file to write data into it. The file is created, or truncated if it exists, unless the mode is for
+ * appending data ("a" or "ab").
+ *
+ *@param fileName the file name
+ *@param mode the stdio mode to open the file: "w", "wb", "a" or "ab"
+ *@return true if opened, false otherwise
+ */
+bool OutputWriter::open(string fileName, const char* mode) {
+	if (isOpen()) close();
+	this->fileName = fileName;
+	bool append = mode[0] == 'a';
+	bufLen = 0;
+	direct = failed = false;
+	fileOffset = size = written = allocated = nWrites = nExtents = 0;
+	writeSeconds = openSeconds = 0.0;
+	opened = chrono::steady_clock::now();
+	delete[] memory;
+	memory = new char[bufferSize + BLOCKSIZE];
+	buffer = memory + (BLOCKSIZE - (uintptr_t) memory % BLOCKSIZE) % BLOCKSIZE;
+#ifdef FDWRITER
+	int flags = O_WRONLY | O_CREAT | (append? 0 : O_TRUNC);
+	if (directIO && (fd = ::open(fileName.c_str(), flags | O_DIRECT, 0644)) >= 0) direct = true;
+	else if ((fd = ::open(fileName.c_str(), flags, 0644)) < 0) return false;
+	struct stat st;
+	//when appending, the space preallocated beyond the end of the file by a writer not closed is released
+	if (fstat(fd, &st) != 0 || (append && ftruncate(fd, st.st_size) != 0)) {
+		::close(fd);
+		fd = -1;
+		return false;
+	}
+	size = allocated = fileOffset = (uint64_t) st.st_size;
+	if (direct && (size % BLOCKSIZE != 0 || (tailFd = ::open(fileName.c_str(), O_WRONLY)) < 0)) {
+		//appending after a partial block, or no descriptor to write the last partial block: direct I/O is not used
+		fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+		direct = false;
+	}
+	return true;
+#else
+	if ((file = fopen(fileName.c_str(), mode)) == NULL) return false;
+	setvbuf(file, buffer, _IOFBF, bufferSize);
+	if (fseek(file, 0, SEEK_END) == 0 && ftell(file) > 0) fileOffset = (uint64_t) ftell(file);
+	return true;
+#endif
+}
+
+/**isOpen
+ * tells if the writer is open.
+ *
+ *@return true if open, false otherwise
+ */
+bool OutputWriter::isOpen() {
+	return fd >= 0 || file != NULL;
+}
+
+/**write
+ * writes the given data. They are copied into the buffer, and the buffer is written to the file when full.
+ *
+ *@param data the data to write
+ *@param len the number of bytes to write
+ *@return true if written, false if the writer is not open or an error has happened
+ */
+bool OutputWriter::write(const void* data, size_t len) {
+	if (failed || !isOpen()) return false;
+	written += len;
+#ifdef FDWRITER
+	const char* p = (const char*) data;
+	while (len > 0) {
+		size_t n = bufferSize - bufLen < len ? bufferSize - bufLen : len;
+		memcpy(buffer + bufLen, p, n);
+		bufLen += n;
+		p += n;
+		len -= n;
+		if (bufLen == bufferSize && !writeBuffer(false)) return false;
+	}
+	return true;
+#else
+	failed = fwrite(data, 1, len, file) != len;
+	return !failed;
+#endif
+}
+
+/**stream
+ * gives a stdio stream writing through this writer. It is valid until the writer is closed.
+ *
+ *@return the stream, or NULL if the writer is not open
+ */
+FILE* OutputWriter::stream() {
+#ifdef FDWRITER
+	if (cookie == NULL && fd >= 0) {
+		cookie_io_functions_t functions = {NULL, cookieWrite, NULL, NULL};
+		if ((cookie = fopencookie(this, "w", functions)) != NULL) setvbuf(cookie, NULL, _IONBF, 0);
+	}
+	return cookie;
+#else
+	return file;
+#endif
+}
+
+/**close
+ * writes the data in the buffer and closes the file, truncated to the size of the data written.
+ *
+ *@return true if all data have been written, false otherwise
+ */
+bool OutputWriter::close() {
+	if (!isOpen()) return false;
+	bool ok = true;
+	if (cookie != NULL) {
+		ok = fclose(cookie) == 0;
+		cookie = NULL;
+	}
+#ifdef FDWRITER
+	ok = writeBuffer(true) && ok;
+	ok = ftruncate(fd, (off_t) size) == 0 && ok;
+	ok = ::close(fd) == 0 && ok;
+	if (tailFd >= 0) ::close(tailFd);
+	fd = tailFd = -1;
+#else
+	if (fseek(file, 0, SEEK_END) == 0 && ftell(file) >= 0) written = (uint64_t) ftell(file) - fileOffset;	//includes data printed to the stream
+	ok = fclose(file) == 0 && ok;
+	file = NULL;
+	size = fileOffset + written;
+#endif
+	openSeconds = chrono::duration<double>(chrono::steady_clock::now() - opened).count();
+	return ok && !failed;
+}
+
+/**bytesWritten
+ * gives the number of bytes written since the writer was opened.
+ *
+ *@return the number of bytes written
+ */
+uint64_t OutputWriter::bytesWritten() {
+	return written;
+}
+
+/**report
+ * gives a text describing the write throughput of the last file written, to be logged when closed.
+ *
+ *@return the report text
+ */
+string OutputWriter::report() {
+	char txt[80];
+	string s = fileName + ": " + to_string((long long) written) + " bytes written";
+	if (nWrites > 0) {
+		snprintf(txt, sizeof txt, " in %llu writes taking %.3f s (%.1f MB/s)", (unsigned long long) nWrites, writeSeconds,
+			writeSeconds > 0? written / writeSeconds / 1048576.0 : 0.0);
+		s += txt;
+	}
+	snprintf(txt, sizeof txt, ". Open %.3f s (%.1f MB/s)", openSeconds, openSeconds > 0? written / openSeconds / 1048576.0 : 0.0);
+	s += txt;
+	if (nExtents > 0) s += ". Extents preallocated: " + to_string((long long) nExtents);
+	if (direct) s += ". Direct I/O";
+	return s;
+}
+
+/**flush
+ * writes the data in the buffer to the file, as needed when the file shall be readable up to the last data written
+ * (like periodically during a capture). With direct I/O the last partial block is written without direct I/O, and
+ * kept in the buffer to be written again when completed.
+ *
+ *@return true if written, false otherwise
+ */
+bool OutputWriter::flush() {
+	if (failed || !isOpen()) return false;
+#ifdef FDWRITER
+	return writeBuffer(true);
+#else
+	return fflush(file) == 0;
+#endif
+}
+
+//@cond DUMMY
+/**writeBuffer
+ * writes the data in the buffer to the file. With direct I/O only whole blocks are written, unless all data are
+ * requested: then the last partial block is written through the descriptor without direct I/O. Data in partial blocks
+ * are kept in the buffer.
+ *
+ *@param all true to write all data in the buffer, false to write only whole blocks with direct I/O
+ *@return true if written, false otherwise
+ */
+bool OutputWriter::writeBuffer(bool all) {
+#ifdef FDWRITER
+	if (failed) return false;
+	size_t len = direct ? bufLen / BLOCKSIZE * BLOCKSIZE : bufLen;	//bytes to write with fd
+	if (bufLen == 0 || (len == 0 && !all)) return true;
+	if (!preallocate(fileOffset + bufLen)) return false;
+	chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+	for (size_t done = 0; done < len; ) {
+		ssize_t n = pwrite(fd, buffer + done, len - done, (off_t) (fileOffset + done));
+		if (n < 0 && errno == EINTR) continue;
+		if (n < 0 && errno == EINVAL && direct) {	//direct I/O not supported by the filesystem: write through the cache
+			fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_DIRECT);
+			direct = false;
+			len = bufLen;
+			continue;
+		}
+		if (n <= 0) {
+			failed = true;
+			return false;
+		}
+		done += n;
+		nWrites++;
+	}
+	for (size_t done = len; all && done < bufLen; ) {	//the last partial block, with direct I/O
+		ssize_t n = pwrite(tailFd, buffer + done, bufLen - done, (off_t) (fileOffset + done));
+		if (n < 0 && errno == EINTR) continue;
+		if (n <= 0) {
+			failed = true;
+			return false;
+		}
+		done += n;
+		nWrites++;
+	}
+	writeSeconds += chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+	size_t data = all ? bufLen : len;	//data bytes written
+	if (fileOffset + data > size) size = fileOffset + data;
+	if (len < bufLen) memmove(buffer, buffer + len, bufLen - len);	//a partial block is kept to be written again
+	fileOffset += len;
+	bufLen -= len;
+	return true;
+#else
+	return fflush(file) == 0;
+#endif
+}
+
+/**preallocate
+ * preallocates space for the file up to the given end, in extents, without changing the file size.
+ *
+ *@param end the end of the data to be written
+ *@return true if the space is available or cannot be preallocated, false if there is no space
+ */
+bool OutputWriter::preallocate(uint64_t end) {
+#if defined(FDWRITER) && defined(FALLOC_FL_KEEP_SIZE)
+	if (extentSize == 0 || end <= allocated) return true;
+	uint64_t newEnd = (end + extentSize - 1) / extentSize * extentSize;
+	if (fallocate(fd, FALLOC_FL_KEEP_SIZE, (off_t) allocated, (off_t) (newEnd - allocated)) == 0) {
+		allocated = newEnd;
+		nExtents++;
+		return true;
+	}
+	if (errno == ENOSPC) {
+		failed = true;
+		return false;
+	}
+	allocated = UINT64_MAX;	//not supported by the filesystem: no more preallocation for this file
+#endif
+	return true;
+}
+//@endcond
@@ -0,0 +1,92 @@
+/** @file OutputWriter.h
+ * Contains the definition of the OutputWriter class, used by the tools to write their output files.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef OUTPUTWRITER_H
+#define OUTPUTWRITER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <chrono>
+#include <string>
+
+using namespace std;
+
+/**OutputWriter writes an output file through a large buffer, and measures the write throughput.
+ *<p>
+ * Data can be written with write, or with the stdio functions on the stream given by stream, for code printing data
+ * with fprintf or passing a FILE* to other classes. Both ways can be mixed, as the stream is not buffered itself.
+ * Data in the buffer can be written to the file at any time with flush, to keep the file readable during captures.
+ *<p>
+ * On Linux the file is written with its own descriptor:
+ * - Space for the file is preallocated in extents as it grows (fallocate keeping the file size), to reduce its
+ *   fragmentation and the metadata updates during long captures.
+ * - Optionally, the file is written with direct I/O (O_DIRECT) from a buffer aligned to the device blocks, to avoid
+ *   filling the page cache with bulk batch outputs. Only whole blocks are written with direct I/O: when data are
+ *   flushed, the last partial block is written through a second descriptor without direct I/O, so the file contains
+ *   only the data written, without padding, also while it is being written.
+ * - When the file is closed, it is truncated to the size of the data written, releasing the preallocated space not
+ *   used. The space preallocated for a file not closed (as when the process is killed) is released when it is
+ *   opened again to append data.
+ *<p>
+ * On other systems, the file is written through a stdio stream using a buffer of the same size.
+ *<p>
+ * The buffer size, the extent size, and the use of direct I/O are set for all writers with configure, usually from
+ * a command line option.
+ */
+class OutputWriter {
+public:
+	OutputWriter();
+	~OutputWriter();
+	static bool configure(string settings);
+	bool open(string fileName, const char* mode);
+	bool isOpen();
+	bool write(const void* data, size_t len);
+	FILE* stream();
+	bool flush();
+	bool close();
+	uint64_t bytesWritten();
+	string report();
+private:
+	static size_t bufferSize;		//the buffer size in bytes
+	static uint64_t extentSize;		//the preallocation extent size in bytes, 0 to not preallocate
+	static bool directIO;			//true to use direct I/O when available
+	string fileName;				//the file name
+	int fd;							//the file descriptor (Linux), or -1 if closed
+	int tailFd;						//the descriptor without direct I/O to write the last partial block, or -1
+	FILE* file;						//the stdio stream (other systems), or NULL if closed
+	FILE* cookie;					//the stream given by stream, or NULL if not requested
+	char* memory;					//the memory allocated for the buffer
+	char* buffer;					//the buffer, aligned to blocks
+	size_t bufLen;					//number of bytes in the buffer
+	bool direct;					//true if direct I/O is used
+	bool failed;					//true after an error
+	uint64_t fileOffset;			//the offset in the file where the buffer data go
+	uint64_t size;					//number of bytes in the file
+	uint64_t written;				//number of bytes written since opened
+	uint64_t allocated;				//the end of the space preallocated
+	uint64_t nWrites;				//number of write calls to the system
+	uint64_t nExtents;				//number of extents preallocated
+	double writeSeconds;			//time spent in write calls to the system
+	chrono::steady_clock::time_point opened;	//when the file was opened
+	double openSeconds;				//time from open to close
+	bool writeBuffer(bool all);
+	bool preallocate(uint64_t end);
+	OutputWriter(const OutputWriter&);				//not copyable
+	OutputWriter& operator=(const OutputWriter&);
+};
+#endif
@@ -1,13 +1,18 @@
 /** @file PacketToOSP.cpp
  * Contains the command line program to extract from a binary file containing SiRF receiver message packets their
- * payload data, and store them into an OSP binary file.
+ * payload data, and store them into an OSP binary file. NMEA sentences found among packets can be stored into a text file.
  *<p>
  *Usage:
  *<p>PacketToOSP.exe {options} [PacketsFilename]
  *<p>Options are:
+ *	- -C CACHE or --cache=CACHE : Directory of the conversion result cache (empty: no cache). Default value CACHE is empty
  *	- -f BFILE or --binfile=BFILE : OSP binary output file. Default value BFILE = DATA.OSP
  *	- -h or --help : Show usage data. Default value HELP=FALSE
+ *	- -K CATALOG or --catalog=CATALOG : Archive catalog file to record the output in (empty: no catalog). Not available on Windows. Default value CATALOG is empty
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -n NFILE or --nmea=NFILE : NMEA output file, for sentences found among packets (empty: NMEA skipped). Default value NFILE is empty
+ *	- -x TRACE or --trace=TRACE : Chrome trace-event file for the processing stages timeline (empty: no trace). Default value TRACE is empty
+ *	- -z WRITER or --writer=WRITER : Output writer settings: buffer size, preallocation extent size, DIRECT for direct I/O (a comma separated list, empty: defaults). Default value WRITER is empty
  *Default value for operator is: RXMESSAGES.PKT
  *
  *Copyright 2015, 2021 by Francisco Cancillo & Luis Cancillo
@@ -25,14 +30,28 @@
  *<p>------+-------+------------------
  *<p>V1.0	|2/2016	|First release
  *<p>V1.1	|2/2018	|Reviewed to run on Linux
+ *<p>V1.2	|10/2026	|Added conversion result cache
+ *<p>				|Added processing stages trace
+ *<p>				|Added NMEA sentences demultiplexing
+ *<p>				|Added archive catalog update
+ *<p>				|Added output writer with preallocation
  */
 
 //from CommonClasses
 #include "ArgParser.h"
 #include "Logger.h"
 #include "Utilities.h"
+//from this project
+#include "ResultCache.h"
+#include "TraceLog.h"
+#include "OutputWriter.h"
+#if !defined(_WIN32) && !defined(WIN32) && !defined(_WIN64) && !defined(WIN64)
+#include "ArchiveCatalog.h"
+#define ARCHIVECAT	///<archive catalog update is available
+#endif
 
 #include <stdio.h>
+#include <ctype.h>
 
 using namespace std;
 
@@ -41,10 +60,15 @@ using namespace std;
 #define START2 162	///<0xA2
 #define END1 176	//0XB0	OSP messages from/to receiver are followed by the end sequence of two bytes with values END1, END2
 #define END2 179	//0XB3
+#define NMEASTART '$'	///<NMEA sentences start with $ and end with *hh<CR><LF>, being hh the checksum in hex
+
+///Results of the input synchronization: EOF reached, OSP message start, NMEA sentence, or NMEA sentence with checksum error
+enum SynchResult {SYNEOF = 0, SYNOSP, SYNNMEA, SYNNMEAERR};
 
 ///Functions defined here
 int filterPkts(Logger* plog);
-bool synchOSPmsg(FILE* inFile);
+int synchMsg(FILE* inFile);
+bool checkNMEA();
 int readOSPmsg(FILE* inFile);
 
 ///The maximum size in bytes of any message payload
@@ -52,14 +76,20 @@ int readOSPmsg(FILE* inFile);
 unsigned char payloadBuf[MAXPAYLOADSIZE];	//buffer for the OSP message payload
 unsigned char payloadLnBuf[2];				//buffer for the OSP message payload length
 unsigned int payloadLength;					//the payload length in bytes of current message
+///The maximum size in bytes of a NMEA sentence accepted (standard sentences have up to 82)
+#define MAXNMEASIZE 256
+char nmeaBuf[MAXNMEASIZE];					//buffer for the NMEA sentence, including $ and <CR><LF>
+unsigned int nmeaLength;					//the length in bytes of the current NMEA sentence
 
+///Program name
+const string THISPRG = "PacketToOSP";
 ///The command line format
-const string CMDLINE = "PacketToOSP.exe {options} [PacketsFilename]";
-const string MYVER = " V1.1";
+const string CMDLINE = THISPRG + ".exe {options} [PacketsFilename]";
+const string MYVER = " V1.2";
 ///The parser object to store options and operators passed in the comman line
 ArgParser parser;
 //Metavariables for options
-int BFILE, HELP, LOGLEVEL;
+int BFILE, CACHE, CATALOG, HELP, LOGLEVEL, NFILE, TRACE, WRITER;
 //Metavariables for operators
 int PKTF;
 //@endcond 
@@ -73,6 +103,10 @@ int PKTF;
  *<p>
  * The binary OSP output files containt messages where head, check and tail have been removed, that is, the data for each
  * message consists of the two bytes of the payload length and the payload bytes.
+ *<p>
+ * Captures taken around receiver mode switches contain NMEA sentences interleaved with OSP packets. They are recognized
+ * in the same scan used to find packets, their checksum verified, and the correct ones can be written as they are to
+ * a NMEA text file.
  *
  *@param argc the number of arguments passed from the command line
  *@param argv the array of arguments passed from the command line
@@ -83,6 +117,11 @@ int PKTF;
  *		- (3) error has occurred when creating the binary output OSP file
  *		- (4) error has occurred when reading packet data
  *		- (5) error has occurred when writing data message data
+ *<p>
+ * When a cache directory is given, the output of a previous conversion of the same input file with the same options
+ * is reused, if it exists in the cache. Otherwise the output generated is stored in the cache.
+ *<p>
+ * When an archive catalog is given, the OSP output file is added to it (see OSPCatalog).
  */
 int main(int argc, char** argv) {
 	/**The main process sequence follows:*/
@@ -92,6 +131,11 @@ int main(int argc, char** argv) {
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
 	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data", false);
 	BFILE = parser.addOption("-f", "--binfile", "BFILE", "OSP binary output file", "DATA.OSP");
+	NFILE = parser.addOption("-n", "--nmea", "NFILE", "NMEA output file, for sentences found among packets (empty: NMEA skipped)", "");
+	CACHE = parser.addOption("-C", "--cache", "CACHE", "Directory of the conversion result cache (empty: no cache)", "");
+	CATALOG = parser.addOption("-K", "--catalog", "CATALOG", "Archive catalog file to record the output in (empty: no catalog)", "");
+	TRACE = parser.addOption("-x", "--trace", "TRACE", "Chrome trace-event file for the processing stages timeline (empty: no trace)", "");
+	WRITER = parser.addOption("-z", "--writer", "WRITER", "Output writer settings: buffer size, preallocation extent size, DIRECT for direct I/O (a comma separated list, empty: defaults)", "");
 	/// 3- Setups the default values for operators in the command line
 	PKTF = parser.addOperator("RXMESSAGES.PKT");
 	/// 4- Parses arguments in the command line extracting options and operators
@@ -110,45 +154,110 @@ int main(int argc, char** argv) {
 	}
 	/// 5- Sets logging level stated in option
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
-	/// 6- Filter input binary receiver packets generating output OSP messages
-	return filterPkts(&log);
+	if (!OutputWriter::configure(parser.getStrOpt(WRITER))) {
+		log.severe("Incorrect output writer settings " + parser.getStrOpt(WRITER));
+		return 1;
+	}
+	/// 6- If a result cache is used, reuses the output of a previous conversion with the same input and options
+	ResultCache cache;
+	if (cache.open(parser.getStrOpt(CACHE), THISPRG + MYVER) && cache.addInput(parser.getOperator(PKTF))) {
+		cache.addOption("BFILE", parser.getStrOpt(BFILE));
+		cache.addOption("NFILE", parser.getStrOpt(NFILE));
+		if (cache.restore(&log)) {
+			log.info("Output reused from cache entry " + cache.key());
+#ifdef ARCHIVECAT
+			ArchiveCatalog::record(parser.getStrOpt(CATALOG), parser.getStrOpt(BFILE), vector<string>(), &log);
+#endif
+			return 0;
+		}
+		cache.release(parser.getStrOpt(BFILE));
+		if (!parser.getStrOpt(NFILE).empty()) cache.release(parser.getStrOpt(NFILE));
+	}
+	/// 7- Filter input binary receiver packets generating output OSP messages
+	TraceLog::open(parser.getStrOpt(TRACE));
+	int result = filterPkts(&log);
+	if (TraceLog::close()) log.info("Processing trace written to " + parser.getStrOpt(TRACE));
+	/// 8- Stores the output in the result cache, and records it in the archive catalog, if used
+	if (result == 0) {
+		cache.addOutput(parser.getStrOpt(BFILE));
+		if (!parser.getStrOpt(NFILE).empty()) cache.addOutput(parser.getStrOpt(NFILE));
+		cache.store(&log);
+#ifdef ARCHIVECAT
+		ArchiveCatalog::record(parser.getStrOpt(CATALOG), parser.getStrOpt(BFILE), vector<string>(), &log);
+#endif
+	}
+	return result;
 }
 /**filterPkts
  * read receiver message packets from the input file, verify them and extract payload data binary which are written into the binary OSP file.
+ * NMEA sentences found among packets are verified and written into the NMEA file, if requested.
  * 
  *@param plog a pointer to a logger object
  *@return 0 if no error occurred when reading or writting, the related error code otherwise 
  */
 int filterPkts(Logger* plog) {
 	int anInt;
+	bool written;
 	string logMsg;
 	int nMsgWrite = 0;
 	int nPkt = 0;
-	/// 6.1- Opens the messages binary input file;
+	int nNMEA = 0;
+	int nNMEAerr = 0;
+	int synch;
+	/// 7.1- Opens the messages binary input file;
 	FILE* inFile;
 	string fileName = parser.getOperator(PKTF);
 	if ((inFile = fopen(fileName.c_str(), "rb")) == NULL) {
 		plog->severe("Cannot open file " + fileName);
 		return 2;
 	}
-	/// 6.2- Creates the output binary file
-	FILE *outFile;
+	/// 7.2- Creates the output binary file
+	OutputWriter outFile;
 	fileName = parser.getStrOpt(BFILE);
-	if ((outFile = fopen(fileName.c_str(), "wb")) == NULL) {
+	if (!outFile.open(fileName, "wb")) {
 		plog->severe("Cannot create the binary output file " + string(fileName));
 		return 3;
 	}
-	/// 6.3- Reads packets from the input stream until end of file happen 
-	while (synchOSPmsg(inFile)) {
+	OutputWriter nmeaFile;
+	fileName = parser.getStrOpt(NFILE);
+	if (!fileName.empty() && !nmeaFile.open(fileName, "wb")) {
+		plog->severe("Cannot create the NMEA output file " + string(fileName));
+		return 3;
+	}
+	/// 7.3- Reads packets and NMEA sentences from the input stream until end of file happen 
+	uint64_t tr = TraceLog::mark();	//start time of the stage being traced
+	while ((synch = synchMsg(inFile)) != SYNEOF) {
+		tr = TraceLog::span(TR_FRAME, tr);
+		if (synch == SYNNMEAERR) {
+			nNMEAerr++;
+			plog->warning("NMEA sentence " + string(nmeaBuf, nmeaLength - 2) + " Error in checksum");
+			continue;
+		}
+		if (synch == SYNNMEA) {	//NMEA sentence is correct. Write it to the NMEA file, if requested
+			nNMEA++;
+			if (!nmeaFile.isOpen()) continue;
+			written = nmeaFile.write(nmeaBuf, nmeaLength);
+			tr = TraceLog::span(TR_WRITE, tr);
+			if (!written) {
+				plog->severe("Write error in NMEA sentence " + to_string((long long) nNMEA));
+				fclose(inFile);
+				return 5;
+			}
+			plog->finest("NMEA sentence " + string(nmeaBuf, nmeaLength - 2));
+			continue;
+		}
 		nPkt++;
 		anInt = readOSPmsg(inFile);
+		tr = TraceLog::span(TR_DECODE, tr);
 		logMsg = "Packet " + to_string((long long) nPkt) + " OSP <" + to_string((long long) payloadBuf[0]) + "," + to_string((long long) payloadLength) + "> ";
 		switch (anInt) {
 		case 0:	//packet is correct. Update counters and write message to OSP file
 			nMsgWrite++;
-			if ((fwrite(payloadLnBuf, 1, 2, outFile) != 2) ||
-				(fwrite(payloadBuf, 1, payloadLength, outFile) != payloadLength)) {
+			written = outFile.write(payloadLnBuf, 2) && outFile.write(payloadBuf, payloadLength);
+			tr = TraceLog::span(TR_WRITE, tr);
+			if (!written) {
 				plog->severe(logMsg + "Write error in message " + to_string((long long) nMsgWrite));
+				fclose(inFile);
 				return 5;
 			}
 			plog->finest(logMsg + "to msg " + to_string((long long) nMsgWrite));
@@ -169,42 +278,92 @@ int filterPkts(Logger* plog) {
 			break;
 		}
 	}
-	plog->info("Packets read:" + to_string((long long) nPkt) + " Messages written:" + to_string((long long) nMsgWrite));
+	plog->info("Packets read:" + to_string((long long) nPkt) + " Messages written:" + to_string((long long) nMsgWrite)
+		+ " NMEA sentences " + (nmeaFile.isOpen()? "written:" : "skipped:") + to_string((long long) nNMEA)
+		+ " NMEA errors:" + to_string((long long) nNMEAerr));
+	fclose(inFile);
+	if (nmeaFile.isOpen() && !nmeaFile.close()) {
+		plog->severe("Write error when closing the NMEA output file");
+		return 5;
+	}
+	if (!outFile.close()) {
+		plog->severe("Write error when closing the binary output file");
+		return 5;
+	}
+	plog->info(outFile.report());
 	return 0;
 }
 
-/**synchroOSPmsg skips bytes from input until start of OSP message is reached.
- * Note that start of OSP message is preceded by the sequence of the two bytes START1 (A0) START2 (A2)
+/**synchMsg skips bytes from input until start of OSP message is reached, or a NMEA sentence has been read.
+ * Note that start of OSP message is preceded by the sequence of the two bytes START1 (A0) START2 (A2), and
+ * NMEA sentences are printable ASCII text starting with $ and ending with <CR><LF>.
+ * The NMEA sentence read, including $ and <CR><LF>, is placed in nmeaBuf and nmeaLength.
  *
- *@param inFile the input binary FILE containing OSP packets 
- *@return true if the sequence START1 START2 has been detected, false when EOF has been reached
+ *@param inFile the input binary FILE containing OSP packets and NMEA sentences
+ *@return SYNOSP if the sequence START1 START2 has been detected, SYNNMEA if a NMEA sentence has been read, SYNNMEAERR if
+ *	it has been read but the checksum is not correct, or SYNEOF when EOF has been reached
  */
-bool synchOSPmsg(FILE* inFile) {
-	unsigned int inData = 0;
-	//A state machine automata is used to skip bytes from input until START1 START2 appears
-	//States: 1=is waiting to START1; 2=is waiting for STAR2; 3=START1+START2 detected
+int synchMsg(FILE* inFile) {
+	int inData;
+	//A state machine automata is used to skip bytes from input until START1 START2 or a NMEA sentence appears
+	//States: 1=is waiting to START1 or $; 2=is waiting for STAR2; 3=START1+START2 detected; 4=reading NMEA sentence
 	int state = 1;
 	while (state!=3) {
-		if (fread(&inData, 1, 1, inFile) == 1) {
-			switch (state) {
-			case 1:
-				switch (inData) {
-				case START1:	state = 2; break;
-				case START2:	break;
-				default:		break;
+		if ((inData = getc(inFile)) == EOF) return SYNEOF;
+		if (state == 4) {
+			if (inData == '\n') {
+				nmeaBuf[nmeaLength++] = (char) inData;
+				return checkNMEA()? SYNNMEA : SYNNMEAERR;
+			}
+			if ((inData >= ' ' && inData <= '~' && inData != NMEASTART) || inData == '\r') {
+				if (nmeaLength < MAXNMEASIZE - 1) {
+					nmeaBuf[nmeaLength++] = (char) inData;
+					continue;
 				}
+			}
+			state = 1;	//not a NMEA sentence: the byte is checked as a possible message start
+		}
+		switch (state) {
+		case 1:
+			switch (inData) {
+			case START1:	state = 2; break;
+			case NMEASTART:
+				nmeaBuf[0] = (char) inData;
+				nmeaLength = 1;
+				state = 4;
 				break;
-			case 2:
-				switch (inData) {
-				case START1:	break;
-				case START2:	state = 3; break;
-				default:		state = 1; break;
-				}
+			default:		break;
+			}
+			break;
+		case 2:
+			switch (inData) {
+			case START1:	break;
+			case START2:	state = 3; break;
+			case NMEASTART:
+				nmeaBuf[0] = (char) inData;
+				nmeaLength = 1;
+				state = 4;
+				break;
+			default:		state = 1; break;
 			}
 		}
-		else return false;
 	}
-	return true;
+	return SYNOSP;
+}
+
+/**checkNMEA verifies the format and checksum of the NMEA sentence in nmeaBuf: $<data>*hh<CR><LF>, being hh the
+ * hexadecimal XOR of all data bytes between $ and *.
+ *
+ *@return true if the sentence is correct, false otherwise
+ */
+bool checkNMEA() {
+	unsigned int received;
+	if (nmeaLength < 7 || nmeaBuf[nmeaLength - 2] != '\r' || nmeaBuf[nmeaLength - 5] != '*') return false;
+	if (!isxdigit(nmeaBuf[nmeaLength - 4]) || !isxdigit(nmeaBuf[nmeaLength - 3])
+		|| sscanf(nmeaBuf + nmeaLength - 4, "%2x", &received) != 1) return false;
+	unsigned char computed = 0;
+	for (unsigned int i = 1; i < nmeaLength - 5; i++) computed ^= (unsigned char) nmeaBuf[i];
+	return computed == received;
 }
 
 /**readOSPmsg reads a OSP message from the input file and put ist payload data into a buffer.
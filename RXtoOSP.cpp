@@ -6,15 +6,26 @@
  *<p>Options are:
  *	- -a PAT or --patience=PAT : Maximum number of bytes to read when waiting for a packet start (0xA0 0xA3). Default value PAT = 2500
  *	- -b BAUD or --baud=BAUD : Set serial port baud rate. Default value BAUD = 57600
+ *	- -c or --autosync : Detect receiver protocol and baud rate, and switch it to OSP at BAUD, before capture. Default value AUTOSYNC=FALSE
  *	- -d DURATION or --duration=DURATION : Duration of acquisition period, in minutes. Default value DURATION = 5
  *	- -e or --ephemeris : Capture GPS ephemeris data (MID15). Default value EPHEM=TRUE
  *	- -f BFILE or --binfile=BFILE : OSP binary output file. Default value BFILE = 20150126_205513.OSP
  *	- -g or --GPS50bps : Capture GPS 50bps nav message (MID8). Default value G50BPS=FALSE
  *	- -h or --help : Show usage data. Default value HELP=FALSE
  *	- -i OBSINT or --interval=OBSINT : Observation interval (in seconds) for epoch data. Default value OBSINT = 5
+ *	- -K CATALOG or --catalog=CATALOG : Archive catalog file to record the output in (empty: no catalog). Not available on Windows. Default value CATALOG is empty
  *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -m MSGS or --msgs=MSGS : Messages to record: comma separated list of MID or MID/SID, those preceded by - are discarded (empty: all). Default value MSGS is empty
+ *	- -o OPROF or --oprofile=OPROF : Receiver output profile (rinex, rtk, nav-only, minimal; empty: enable all messages and disable unused ones). Default value OPROF is empty
+ *	- -n DECIM or --decim=DECIM : Per MID decimation: comma separated list of MID:N (keep 1 in N) or MID:Ts (keep 1 each T seconds). Default value DECIM is empty
  *	- -p COMPORT or --port=COMPORT : Serial port name where receiver is connected. Default value COMPORT = COM35 (Win) or /dev/ttyUSB0 (Linux)
+ *	- -r RAW or --raw=RAW : Raw stream tee file, where all bytes read from the port are recorded (empty: no tee). Default value RAW is empty
  *	- -s MID or --stop=MID : Stop epoch data acquisition when this MID (Message ID) arrives. Default value MID = 7
+ *	- -t TUNING or --tuning=TUNING : Serial read tuning profile (low-latency, low-wakeup; empty: none). Not available on Windows. Default value TUNING is empty
+ *	- -u ROLLUP or --rollup=ROLLUP : Per minute rollup sidecar updated while capturing (empty: no rollup). Not available on Windows. Default value ROLLUP is empty
+ *	- -w WDOG or --watchdog=WDOG : Stall watchdog T[:N]: resync the receiver when less than N (default 1) valid messages arrive in T seconds (empty: no watchdog). Default value WDOG is empty
+ *	- -x TRACE or --trace=TRACE : Chrome trace-event file for the processing stages timeline (empty: no trace). Default value TRACE is empty
+ *	- -z WRITER or --writer=WRITER : Output writer settings: buffer size, preallocation extent size, DIRECT for direct I/O (a comma separated list, empty: defaults). Default value WRITER is empty
  *
  *Copyright 2015, 2021 by Francisco Cancillo & Luis Cancillo
  *<p>
@@ -33,6 +44,17 @@
  *<p>V2.0	|2/2016	|Improve logging
  *<p>				|Add commands for SiRFV
  *<p>V2.1	|2/2018	|Reviewed to run on Linux
+ *<p>V2.2	|10/2026	|Added processing stages trace
+ *<p>				|OSP output written from a background thread
+ *<p>				|Added raw stream tee
+ *<p>				|Added MID/SID filters and per MID decimation
+ *<p>				|Added receiver output profiles
+ *<p>				|Added serial read tuning profiles
+ *<p>				|Added stall watchdog with receiver resync
+ *<p>				|Added receiver autosync
+ *<p>				|Added archive catalog update
+ *<p>				|Added per minute rollup sidecar update
+ *<p>				|Added output writer with preallocation
  */
 
 //from CommonClasses
@@ -45,19 +67,34 @@
 #define COMDEF "COM35"
 #else
 #include "SerialTxRxLnx.h"
+#include "SerialStream.h"
 #define COMDEF "/dev/ttyUSB0"
+#include "ArchiveCatalog.h"
+#include "MinuteRollup.h"
+#define DIRECTREAD	///<direct port reading with SerialStream is available
+#define ARCHIVECAT	///<archive catalog update is available
+#define ROLLUPS		///<rollup sidecar update is available
 #endif
+//from this project
+#include "AsyncWriter.h"
+#include "OutputWriter.h"
+#include "ReceiverSync.h"
+#include "TraceLog.h"
 //standard
 #include <stdio.h>
+#include <string.h>
+#include <chrono>
 using namespace std;
 //@cond DUMMY
 ///The command line format
 const string CMDLINE = "OSPDataLogger.exe {options}";
-const string MYVER = " V2.1";
+const string MYVER = " V2.2";
+///Minimum time between markers in the raw stream tee, in milliseconds
+const int RAWMARKPERIOD = 1000;
 ///The parser object to store options and operators passed in the comman line
 ArgParser parser;
 //Metavariables for options
-int BAUD, DURATION, BFILE, G50BPS, HELP, EPHEM, OBSINT, LOGLEVEL, COMPORT, MID, PAT;
+int AUTOSYNC, BAUD, CATALOG, DURATION, BFILE, G50BPS, HELP, EPHEM, OBSINT, LOGLEVEL, COMPORT, MID, MSGS, DECIM, OPROF, PAT, RAW, ROLLUP, TRACE, TUNING, WDOG, WRITER;
 
 struct MSGwrite {
 	int msgId;
@@ -73,9 +110,67 @@ struct MSGwrite {
 	}
 };
 vector <MSGwrite> lstWmsg;
+//Filter rules for messages to record: 0 no rule, RULEKEEP, or RULEDROP
+#define RULEKEEP 1
+#define RULEDROP 2
+unsigned char midRule[256];		//rules for MIDs
+unsigned char sidRule[65536];	//rules for MID/SID pairs, indexed by MID*256+SID
+bool keepListed = false;		//true if only listed messages are kept
+//Decimation by MID
+int decimN[256];				//keep 1 message each decimN, if >1
+long long decimT[256];			//keep 1 message each decimT milliseconds, if >0
+int decimCount[256];			//messages received since the last kept
+long long decimLast[256];		//time the last message was kept
+//Receiver output profiles: the messages needed by each downstream product
+struct OutputProfile {
+	const char* name;
+	const char* periodic;	//MIDs to be output periodically
+	bool navData;			//if navigation parameters and ephemeris shall be polled
+};
+const OutputProfile outProfiles[] = {
+	{"rinex", "2,7,28", true},
+	{"rtk", "2,7", false},
+	{"nav-only", "7", true},
+	{"minimal", "7", false}
+};
+const int NPROFILES = sizeof(outProfiles) / sizeof(outProfiles[0]);
+//State of MIDs in the output profile stated: 0 not expected, MIDPERIODIC, or MIDANSWER (answer to commands)
+#define MIDPERIODIC 1
+#define MIDANSWER 2
+bool profileSet = false;		//true if an output profile has been stated
+int profileIdx;					//the output profile stated
+unsigned char midProfile[256];	//the state of each MID in the profile
+long long midCount[256];		//histogram of MIDs received
+long long complyCount[256];		//histogram of MIDs received after the first epoch, checked against the profile
+///Full epochs to wait, after the first one, before checking that the receiver complies with the output profile
+const int COMPLYEPOCHS = 3;
+//Stall watchdog
+int wdogPeriod = 0;				//the watchdog window, in seconds, or 0 if no watchdog is set
+int wdogMinMsgs = 1;			//the minimum number of valid messages expected in each window
+///Maximum number of contiguous failed resyncs before giving up the acquisition
+const int MAXRESYNCS = 3;
+#ifdef ROLLUPS
+MinuteRollup rollup;			//the per minute rollup updated while capturing
+#endif
 //@endcond 
 //functions in this file
-int acquireBin(SerialTxRx, FILE*, int, int, int, Logger*);
+void setOutputProfile(string name, bool g50bps, bool ephem, int stopMID);
+void addProfileCmds(int obsIntl);
+bool checkCompliance(Logger* plog);
+void setMsgFilter(string msgList);
+void setDecimation(string decimList);
+bool passFilter(unsigned char* payload, unsigned int len);
+void setWatchdog(string wdog);
+void sendSetupCmds(SerialTxRx& port, Logger* plog);
+bool syncReceiver(SerialTxRx& port, int patience, Logger* plog);
+bool resumeReading(SerialTxRx&);
+void takeMessage(SerialTxRx&, SerialTxRx&);
+#ifdef DIRECTREAD
+bool resumeReading(SerialStream& stream);
+void takeMessage(SerialStream& stream, SerialTxRx& rxPort);
+#endif
+template <class Reader> int acquireBin(Reader&, SerialTxRx&, bool, AsyncWriter&, int, int, int, Logger*);
+int acquireStream(SerialTxRx&, bool, AsyncWriter&, int, int, int, int, Logger*);
 
 /**main
  * gets the command line arguments, set parameters accordingly and triggers the data acquisition from the receiver.
@@ -92,9 +187,36 @@ int acquireBin(SerialTxRx, FILE*, int, int, int, Logger*);
  * The binary OSP output files contain messages where head, check and tail have been removed, that is, the data for each
  * message consists of the two bytes of the payload length and the payload bytes.
  *<p>
+ * Instead of enabling all receiver messages and disabling unused ones, an output profile can be stated to enable only
+ * the messages needed by a downstream product: rinex (MIDs 2, 7, 28 and navigation data), rtk (MIDs 2, 7), nav-only
+ * (MID 7 and navigation data), or minimal (MID 7). The MID stated to stop epoch acquisition is always enabled.
+ * The histogram of MIDs received after the first epoch is checked after some epochs and at the end, to verify that the
+ * receiver complies. Messages in the first epoch are not checked, as they can be sent before the profile takes effect.
+ *<p>
+ * Messages to be recorded can be filtered by MID or MID/SID, and decimated by MID keeping one in N messages or
+ * one each T seconds. Filters are applied before writing, and do not change the messages sent by the receiver.
+ *<p>
+ * Optionally, all bytes read from the port, including the ones belonging to erroneous messages, can be recorded
+ * in a raw stream tee file, for later analysis or replay. Markers stating the stream offset and the reading time
+ * are written periodically into a file having the tee file name with the ".mrk" suffix.
+ *<p>
+ * Port reading can be tuned with a profile: low-latency, for live pipelines, or low-wakeup, to batch wakeups in
+ * battery powered loggers. The wakeups per second and the latency from byte arrival to message framing are logged.
+ *<p>
+ * A stall watchdog can be set to check the rate of valid messages received. When it drops below the threshold stated,
+ * or reading fails, the receiver is resynchronized as SynchroRX does (detecting its protocol and baud rate, and
+ * changing them to OSP at the capture baud rate), the receiver setup commands are sent again, and the capture
+ * resumes writing to the same OSP file.
+ *<p>
  * The SynchroRX command line provided in this project can be used to check and set the receiver state: baud rate,
- * accept/send OSP or NMEA messages, etc.
+ * accept/send OSP or NMEA messages, etc. Instead, the autosync option can be used to perform the same detection and
+ * switch to OSP on the port opened for the capture, avoiding its reopening.
  * Other utilities provided by receiver manufacturers exist that could perform this synchro task.
+ *<p>
+ * When an archive catalog is given, the output file is added to it at the end of the capture (see OSPCatalog).
+ *<p>
+ * When a rollup sidecar is given, the per minute aggregates of the messages recorded are appended to it as each
+ * minute completes, so dashboards can follow the capture without reading the OSP file (see OSPRollup).
  *
  *@param argc the number of arguments passed from the command line
  *@param argv the array of arguments passed from the command line
@@ -102,10 +224,12 @@ int acquireBin(SerialTxRx, FILE*, int, int, int, Logger*);
  *		- (0) no errors have been detected
  *		- (1) an error has been detected in arguments
  *		- (2) error when opening and setting the communication port
- *		- (3) the receiver is not sending OSP messages
+ *		- (3) the receiver is not sending OSP messages, or it cannot be switched to OSP when autosync is requested
  *		- (4) error has occurred when setting receiver
  *		- (5) error has occurred when creating the binary output OSP file
  *		- (6) error has occurred when writing data read from receiver
+ *		- (7) error reading data from receiver: patience exahusted or EOF, or receiver resync failed
+ *		- (8) error has occurred when reading directly the port or creating the raw stream tee files
  */
 
 int main(int argc, char** argv) {
@@ -120,6 +244,15 @@ int main(int argc, char** argv) {
 	time (&rawtime);
 	timeinfo = localtime (&rawtime);
 	strftime (fileName, sizeof fileName,"%Y%m%d_%H%M%S.OSP", timeinfo);
+	ROLLUP = parser.addOption("-u", "--rollup", "ROLLUP", "Per minute rollup sidecar updated while capturing (empty: no rollup)", "");
+	WDOG = parser.addOption("-w", "--watchdog", "WDOG", "Stall watchdog T[:N]: resync the receiver when less than N (default 1) valid messages arrive in T seconds (empty: no watchdog)", "");
+	TRACE = parser.addOption("-x", "--trace", "TRACE", "Chrome trace-event file for the processing stages timeline (empty: no trace)", "");
+	WRITER = parser.addOption("-z", "--writer", "WRITER", "Output writer settings: buffer size, preallocation extent size, DIRECT for direct I/O (a comma separated list, empty: defaults)", "");
+	OPROF = parser.addOption("-o", "--oprofile", "OPROF", "Receiver output profile (rinex, rtk, nav-only, minimal; empty: enable all messages and disable unused ones)", "");
+	DECIM = parser.addOption("-n", "--decim", "DECIM", "Per MID decimation: comma separated list of MID:N (keep 1 in N) or MID:Ts (keep 1 each T seconds)", "");
+	MSGS = parser.addOption("-m", "--msgs", "MSGS", "Messages to record: comma separated list of MID or MID/SID, those preceded by - are discarded (empty: all)", "");
+	TUNING = parser.addOption("-t", "--tuning", "TUNING", "Serial read tuning profile (low-latency, low-wakeup; empty: none)", "");
+	RAW = parser.addOption("-r", "--raw", "RAW", "Raw stream tee file, where all bytes read from the port are recorded (empty: no tee)", "");
 	MID = parser.addOption("-s", "--stop", "MID", "Stop epoch data acquisition when this MID (Message ID) arrives", "7");
 	COMPORT = parser.addOption("-p", "--port", "COMPORT", "Serial port name where receiver is connected", COMDEF);
 	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
@@ -130,6 +263,8 @@ int main(int argc, char** argv) {
 	EPHEM = parser.addOption("-e", "--ephemeris", "EPHEM", "Request ephemeris data (MID15, MID70)", true);
 	DURATION = parser.addOption("-d", "--duration", "DURATION", "Duration of acquisition period, in minutes", "5");
 	BAUD = parser.addOption("-b", "--baud", "BAUD", "Set serial port baud rate", "57600");
+	CATALOG = parser.addOption("-K", "--catalog", "CATALOG", "Archive catalog file to record the output in (empty: no catalog)", "");
+	AUTOSYNC = parser.addOption("-c", "--autosync", "AUTOSYNC", "Detect receiver protocol and baud rate, and switch it to OSP at BAUD, before capture", false);
 	PAT = parser.addOption("-a", "--patience", "PAT", "Maximum number of bytes to read when waiting for a packet start", "500");
 	/// 3- Parses arguments in the command line extracting options and operators
 	try {
@@ -146,10 +281,24 @@ int main(int argc, char** argv) {
 	}
 	/// 4- Sets logging level stated in option
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
-	/// 5- Computes observation interval and number of epochs to read from data given in options
+	if (!OutputWriter::configure(parser.getStrOpt(WRITER))) {
+		log.severe("Incorrect output writer settings " + parser.getStrOpt(WRITER));
+		return 1;
+	}
+	/// 5- Computes observation interval and number of epochs to read from data given in options, and sets message filters
 	int obsIntl = stoi(parser.getStrOpt(OBSINT));
 	int nEpochs = stoi(parser.getStrOpt(DURATION)) * 60 / obsIntl;
 	int patience = stoi(parser.getStrOpt(PAT));
+	try {
+		setMsgFilter(parser.getStrOpt(MSGS));
+		setDecimation(parser.getStrOpt(DECIM));
+		setWatchdog(parser.getStrOpt(WDOG));
+		setOutputProfile(parser.getStrOpt(OPROF), parser.getBoolOpt(G50BPS), parser.getBoolOpt(EPHEM), stoi(parser.getStrOpt(MID)));
+	} catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
 	/// 6- Defines and sets up the SerialTxRx object to be used for communication with the receiver
 	SerialTxRx port;
 	try {
@@ -159,9 +308,18 @@ int main(int argc, char** argv) {
 		log.severe(error);
 		return 2;
 	}
-	/// 7- Verifies that receiver mode is OSP
-	switch (port.readOSPmsg(patience)) {
+	/// 7- Verifies that receiver mode is OSP or, if autosync is requested, detects the receiver protocol and baud rate,
+	/// and switches it to OSP at the baud rate stated. The valid message read, if any, will be recorded
+	bool pending = false;	//a valid message has been read and is pending to be recorded
+	if (parser.getBoolOpt(AUTOSYNC)) {
+		if (!syncReceiver(port, patience, &log)) {
+			log.severe("Error: the receiver cannot be switched to OSP messages");
+			return 3;
+		}
+		pending = true;
+	} else switch (port.readOSPmsg(patience)) {
 	case 0:	//OSP message is OK
+		pending = true;
 		break;
 	case 1:	//Error in OSP message. May be recoverable
 	case 2:
@@ -175,62 +333,163 @@ int main(int argc, char** argv) {
 		log.severe("Error: the receiver is not sending OSP messages");
 		return 3;
 	}
-	/// 8- Sends OSP commands to the communication port to perform receiver setup
+	/// 8- Sends OSP commands to the communication port to perform receiver setup, as per the output profile stated
 	//build vector with sequence of messages to send
-	lstWmsg.push_back(MSGwrite(166, "02 00 " + to_string((long long) obsIntl) + " 00 00 00 00", 10, "Enable all massesges at the interval stated"));
-	lstWmsg.push_back(MSGwrite(166, "04 00 00 00 00 00 00", 16, "Disable debug msgs"));
-	lstWmsg.push_back(MSGwrite(166, "00 1D 00 00 00 00 00", 16, "Disable navigation debug message 29")); 
-	lstWmsg.push_back(MSGwrite(166, "00 1E 00 00 00 00 00", 16, "Disable navigation debug message 30"));
-	lstWmsg.push_back(MSGwrite(166, "00 1F 00 00 00 00 00", 16, "Disable navigation debug message 31"));
-	lstWmsg.push_back(MSGwrite(166, "00 04 00 00 00 00 00", 16, "Disable message 4 navigation"));
-	if (!parser.getBoolOpt(G50BPS))
-		lstWmsg.push_back(MSGwrite(166, "00 08 00 00 00 00 00", 16, "Disable message 8 50 BPD data"));
-	lstWmsg.push_back(MSGwrite(166, "00 40 00 00 00 00 00", 16, "Disable message 64 aux measurements data"));
-	lstWmsg.push_back(MSGwrite(166, "00 32 00 00 00 00 00", 16, "Disable message 50 SBAS stat"));
-	lstWmsg.push_back(MSGwrite(166, "00 29 00 00 00 00 00", 16, "Disable message 41 Geodetic nav"));
-	//lstWmsg.push_back(MSGwrite(133, "01 00 00 00 00 00", 16, "Set DGPS source to SBAS"));
-	//Commands to request specific messages with data needed for RINEX files
-	lstWmsg.push_back(MSGwrite(132, "00", 16, "Poll Software Version. Answer in MID6"));
-	lstWmsg.push_back(MSGwrite(152, "00", 16, "Poll Navigation parameters. Answer in MID19"));
-	if (parser.getBoolOpt(EPHEM)) {
-		lstWmsg.push_back(MSGwrite(147, "00 00", 16, "Poll ephemeris. Answer in MID15"));
-		lstWmsg.push_back(MSGwrite(147, "00 00", 16, "Poll ephemeris. Answer in MID15"));
-		lstWmsg.push_back(MSGwrite(147, "00 00", 16, "Poll ephemeris. Answer in MID15"));
-		lstWmsg.push_back(MSGwrite(212, "0C", 16, "In SiRFV: GLONASS Broadcast Ephemeris Request SID12. Answer in MID70 SID12"));
-		lstWmsg.push_back(MSGwrite(212, "0C", 16, "In SiRFV: GLONASS Broadcast Ephemeris Request SID12. Answer in MID70 SID12"));
-		lstWmsg.push_back(MSGwrite(212, "0C", 16, "In SiRFV: GLONASS Broadcast Ephemeris Request SID12. Answer in MID70 SID12"));
-		//lstWmsg.push_back(MSGwrite(232, "02 FF FF", 16, "Poll ephemeris status SID2. Answer in MID56 SID3"));
-	}
-	for (vector<MSGwrite>::iterator it = lstWmsg.begin() ; it != lstWmsg.end(); ++it) {
-		try {
-			log.info("W OSP<" + to_string((long long) it->msgId) + "> b" + to_string((long long) it->base) +" pld:"+ it->payload + ". " + it->comment);
-			port.writeOSPcmd(it->msgId, it->payload, it->base);
-		} catch (string error) {	//an error has occurred when setting receiver
-			log.severe(error);
+	if (profileSet) addProfileCmds(obsIntl);
+	else {
+		lstWmsg.push_back(MSGwrite(166, "02 00 " + to_string((long long) obsIntl) + " 00 00 00 00", 10, "Enable all massesges at the interval stated"));
+		lstWmsg.push_back(MSGwrite(166, "04 00 00 00 00 00 00", 16, "Disable debug msgs"));
+		lstWmsg.push_back(MSGwrite(166, "00 1D 00 00 00 00 00", 16, "Disable navigation debug message 29")); 
+		lstWmsg.push_back(MSGwrite(166, "00 1E 00 00 00 00 00", 16, "Disable navigation debug message 30"));
+		lstWmsg.push_back(MSGwrite(166, "00 1F 00 00 00 00 00", 16, "Disable navigation debug message 31"));
+		lstWmsg.push_back(MSGwrite(166, "00 04 00 00 00 00 00", 16, "Disable message 4 navigation"));
+		if (!parser.getBoolOpt(G50BPS))
+			lstWmsg.push_back(MSGwrite(166, "00 08 00 00 00 00 00", 16, "Disable message 8 50 BPD data"));
+		lstWmsg.push_back(MSGwrite(166, "00 40 00 00 00 00 00", 16, "Disable message 64 aux measurements data"));
+		lstWmsg.push_back(MSGwrite(166, "00 32 00 00 00 00 00", 16, "Disable message 50 SBAS stat"));
+		lstWmsg.push_back(MSGwrite(166, "00 29 00 00 00 00 00", 16, "Disable message 41 Geodetic nav"));
+		//lstWmsg.push_back(MSGwrite(133, "01 00 00 00 00 00", 16, "Set DGPS source to SBAS"));
+		//Commands to request specific messages with data needed for RINEX files
+		lstWmsg.push_back(MSGwrite(132, "00", 16, "Poll Software Version. Answer in MID6"));
+		lstWmsg.push_back(MSGwrite(152, "00", 16, "Poll Navigation parameters. Answer in MID19"));
+		if (parser.getBoolOpt(EPHEM)) {
+			lstWmsg.push_back(MSGwrite(147, "00 00", 16, "Poll ephemeris. Answer in MID15"));
+			lstWmsg.push_back(MSGwrite(147, "00 00", 16, "Poll ephemeris. Answer in MID15"));
+			lstWmsg.push_back(MSGwrite(147, "00 00", 16, "Poll ephemeris. Answer in MID15"));
+			lstWmsg.push_back(MSGwrite(212, "0C", 16, "In SiRFV: GLONASS Broadcast Ephemeris Request SID12. Answer in MID70 SID12"));
+			lstWmsg.push_back(MSGwrite(212, "0C", 16, "In SiRFV: GLONASS Broadcast Ephemeris Request SID12. Answer in MID70 SID12"));
+			lstWmsg.push_back(MSGwrite(212, "0C", 16, "In SiRFV: GLONASS Broadcast Ephemeris Request SID12. Answer in MID70 SID12"));
+			//lstWmsg.push_back(MSGwrite(232, "02 FF FF", 16, "Poll ephemeris status SID2. Answer in MID56 SID3"));
 		}
 	}
-	/// 8- Creates the output binary file
-	FILE *outFile = fopen(parser.getStrOpt(BFILE).c_str(), "wb");
-	if (outFile == NULL) {
+	sendSetupCmds(port, &log);
+	/// 8- Creates the output binary file, to be written from a background thread
+	OutputWriter outFile;
+	AsyncWriter ospOut;
+	if (!outFile.open(parser.getStrOpt(BFILE), "wb") || !ospOut.open(&outFile)) {
 		log.severe("Cannot create the binary output file " + string(fileName));
 		return 5;
 	}
-	/// 9- Calls acquireBin to acquire and record data form receiver
-	int n = acquireBin(port, outFile, nEpochs * 20, nEpochs, patience, &log);
-	fclose(outFile);
+#ifdef ROLLUPS
+	if (rollup.open(parser.getStrOpt(ROLLUP), parser.getStrOpt(BFILE), 1, &log)) rollup.restart();	//the OSP file is new
+#endif
+	/// 9- Calls acquireBin to acquire and record data form receiver, reading directly the port if raw data are teed
+	/// or port reading is tuned
+	TraceLog::open(parser.getStrOpt(TRACE));
+	int n;
+	if (parser.getStrOpt(RAW).empty() && parser.getStrOpt(TUNING).empty())
+		n = acquireBin(port, port, pending, ospOut, nEpochs * 20, nEpochs, patience, &log);
+	else n = acquireStream(port, pending, ospOut, nEpochs * 20, nEpochs, patience, obsIntl * 1000, &log);
+	checkCompliance(&log);
+	if (!ospOut.close() && n == 0) {
+		log.severe("Write error in the binary output file");
+		n = 6;
+	}
+	log.info("OSP output bytes:" + to_string((long long) ospOut.bytesWritten()) + " batches:" + to_string((long long) ospOut.batches())
+		+ " capture waits:" + to_string((long long) ospOut.producerWaits()));
+	if (!outFile.close() && n == 0) {
+		log.severe("Write error in the binary output file");
+		n = 6;
+	}
+	log.info(outFile.report());
 	port.closePort();
+	if (TraceLog::close()) log.info("Processing trace written to " + parser.getStrOpt(TRACE));
+#ifdef ROLLUPS
+	if (rollup.isOpen()) {
+		rollup.close(n == 0);
+		log.info("Rollup minutes stored:" + to_string((long long) rollup.rowsStored()));
+	}
+#endif
+	/// 10- Records the output file in the archive catalog, if given
+#ifdef ARCHIVECAT
+	ArchiveCatalog::record(parser.getStrOpt(CATALOG), parser.getStrOpt(BFILE), vector<string>(), &log);
+#endif
+	return n;
+}
+/**acquireStream
+ * acquires binary OSP messages from the receiver, reading directly the port with a SerialStream, and record them
+ * in the binary OSP file. Port reading is tuned as stated in options. If a raw stream tee file is stated, all bytes
+ * read are also recorded in it, and periodic offset/time markers in the markers file.
+ *
+ *@param rxPort the SerialTxRx object used to set the port and the receiver
+ *@param pending true if a valid message read with rxPort is pending to be recorded
+ *@param ospOut the writer for the binary output file
+ *@param maxMsgs the maximum number of messages to be recorded
+ *@param maxEpochs the maximum number of epochs to be recorded
+ *@param patience the maximum number of erroneous contiguous bytes to read before returning a read error
+ *@param timeout the maximum time to wait for data from the port, in milliseconds
+ *@param plog the pointer to the Logger
+ *@return a read status as per acquireBin, or (8) if the port cannot be read directly or the raw stream tee files
+ * cannot be created
+ */
+int acquireStream(SerialTxRx& rxPort, bool pending, AsyncWriter& ospOut, int maxMsgs, int maxEpochs, int patience, int timeout, Logger* plog) {
+#ifdef DIRECTREAD
+	/**The acquireStream process sequence follows:*/
+	/// 1- Opens the port for direct reading and tunes it
+	string tuningName = parser.getStrOpt(TUNING);
+	SerialStream::Tuning tuning = SerialStream::TUNE_NONE;
+	if (tuningName.compare("low-latency") == 0) tuning = SerialStream::TUNE_LOWLATENCY;
+	else if (tuningName.compare("low-wakeup") == 0) tuning = SerialStream::TUNE_LOWWAKEUP;
+	else if (!tuningName.empty()) {
+		plog->severe("Unknown serial tuning profile " + tuningName);
+		return 8;
+	}
+	SerialStream stream;
+	if (!stream.open(parser.getStrOpt(COMPORT), timeout)) {
+		plog->severe("Cannot open port for direct reading " + parser.getStrOpt(COMPORT));
+		return 8;
+	}
+	if (!stream.tune(tuning, stoi(parser.getStrOpt(BAUD))))
+		plog->warning("Serial tuning profile " + tuningName + " not fully applied");
+	/// 2- Creates the raw stream tee files, if requested
+	string rawName = parser.getStrOpt(RAW);
+	OutputWriter rawFile;
+	FILE* markFile = NULL;
+	AsyncWriter rawOut, markOut;
+	if (!rawName.empty()) {
+		bool rawOpen = rawFile.open(rawName, "wb");
+		markFile = fopen((rawName + ".mrk").c_str(), "w");
+		if (!rawOpen || markFile == NULL || !rawOut.open(&rawFile) || !markOut.open(markFile, 4096, 5000)) {
+			plog->severe("Cannot create the raw stream tee files " + rawName);
+			if (markFile != NULL) fclose(markFile);
+			return 8;
+		}
+		stream.setTee(&rawOut, &markOut, RAWMARKPERIOD);
+	}
+	/// 3- Acquires data
+	int n = acquireBin(stream, rxPort, pending, ospOut, maxMsgs, maxEpochs, patience, plog);
+	/// 4- Closes the tee files and reports reading statistics
+	if (!rawName.empty()) {
+		bool teeOK = rawOut.close() && markOut.close();
+		teeOK = rawFile.close() && teeOK;
+		teeOK = (fclose(markFile) == 0) && teeOK;
+		if (!teeOK) plog->severe("Write error in the raw stream tee files " + rawName);
+		plog->info("Raw tee capture waits:" + to_string((long long) rawOut.producerWaits()) + ". " + rawFile.report());
+	}
+	char stats[128];
+	snprintf(stats, sizeof stats, " wakeups/s:%.1f latency mean:%.0fus max:%.0fus",
+		stream.wakeupsPerSecond(), stream.meanLatency(), stream.maxLatency());
+	plog->info("Serial tuning " + (tuningName.empty()? string("none") : tuningName) + " bytes read:"
+		+ to_string((long long) stream.bytesRead()) + stats);
 	return n;
+#else
+	plog->severe("Direct port reading (raw stream tee, serial tuning) is not available in this platform");
+	return 8;
+#endif
 }
+
 /**acquireBin
  * acquires binary OSP messages from the receiver and record them in the binary OSP file.
  * Data are read from the receiver and written to the OSP file until:
  * - the maximum number of messages is reached, or
  * - the maximum number of epoch is reached, or
- * - an unrecoverable error happens reading data from receiver
+ * - an unrecoverable error happens reading data from receiver, or resyncs of a stalled receiver fail
  * - a write error happens
  * 
- *@param  port the SerialTxRx object used to communicate with the receiver
- *@param  outFile the binary output file to record the messages received from receiver
+ *@param  port the object used to read messages from the receiver: a SerialTxRx or a SerialStream
+ *@param rxPort the SerialTxRx object used to set the port and the receiver when it shall be resynchronized
+ *@param pending true if a valid message read with rxPort is pending to be recorded
+ *@param  outFile the writer of the binary output file to record the messages received from receiver
  *@param maxMsgs the maximum number of messages to be recorded
  *@param maxEpochs the maximum number of epochs to be recorded
  *@param patience the maximum number of erroneous contiguous bytes to read before returning a read error
@@ -238,20 +497,33 @@ int main(int argc, char** argv) {
  *@return a read status according to the following values and meaning:
  *		- (0) no errors have been detected
  *		- (6) error has occurred when writing data read from receiver
- *		- (7) error reading data from receiver: patience exahusted or EOF
+ *		- (7) error reading data from receiver: patience exahusted or EOF, or receiver resync failed
  */
-int acquireBin(SerialTxRx port, FILE *outFile, int maxMsgs, int maxEpochs, int patience, Logger* plog) {
+template <class Reader> int acquireBin(Reader& port, SerialTxRx& rxPort, bool pending, AsyncWriter& outFile, int maxMsgs, int maxEpochs, int patience, Logger* plog) {
 	/**The acquireBin process sequence follows:*/
 	string txtToLog;
 	int lastMsgMID = stoi(parser.getStrOpt(MID));
-	/// 1- Sets counters
+	/// 1- Sets counters and the watchdog window
 	int nMsgs = 0;
 	int nErrors = 0;
 	int nEpochs = 0;
+	int nFiltered = 0;
+	int nResyncs = 0;
+	int failedResyncs = 0;
+	int windowMsgs = 0;		//valid messages received in the current watchdog window
+	chrono::steady_clock::time_point windowStart = chrono::steady_clock::now();
 	int readResult = 0;
-	/// 2- Reads messages from the input stream until counts exhausted or unrecoverable error happen 
+	bool written;
+	uint64_t tr = TraceLog::mark();	//start time of the stage being traced
+	if (pending) takeMessage(port, rxPort);
+	/// 2- Reads messages from the input stream until counts exhausted or unrecoverable error happen.
+	/// A message already read with rxPort is processed first
 	while ((nMsgs < maxMsgs) && (nEpochs < maxEpochs)) {
-		readResult = port.readOSPmsg(patience);
+		if (pending) {
+			readResult = 0;
+			pending = false;
+		} else readResult = port.readOSPmsg(patience);
+		tr = TraceLog::span(TR_READ, tr);
 		/// - Log message read using format OSP<MID,length> Result
 		txtToLog = "R OSP<"
 			+ to_string((long long) ((int) port.payBuff[0])) 
@@ -259,11 +531,28 @@ int acquireBin(SerialTxRx port, FILE *outFile, int maxMsgs, int maxEpochs, int p
 		switch (readResult) {
 		case 0:	//message is correct
 			txtToLog += "OK";
-			/// - Update counters and write message to OSP file
+			/// - Update counters, apply message filters and decimation, and write message to OSP file
+			midCount[port.payBuff[0]]++;
+			if (nEpochs > 0) complyCount[port.payBuff[0]]++;
+			windowMsgs++;
+			if (port.payBuff[0] == lastMsgMID && ++nEpochs == COMPLYEPOCHS + 1) checkCompliance(plog);
+			written = passFilter(port.payBuff, port.payloadLen);
+			tr = TraceLog::span(TR_FILTER, tr);
+			if (!written) {
+				nFiltered++;
+				plog->finest(txtToLog + " filtered");
+				break;
+			}
 			nMsgs++;
-			if (port.payBuff[0] == lastMsgMID) nEpochs++;
-			if ((fwrite(port.paylenBuff, 1, 2, outFile) != 2) ||
-				(fwrite(port.payBuff, 1, port.payloadLen, outFile) != port.payloadLen)) {
+			written = outFile.write(port.paylenBuff, 2) && outFile.write(port.payBuff, port.payloadLen);
+#ifdef ROLLUPS
+			if (!rollup.add(port.payBuff, port.payloadLen)) {
+				plog->warning("Rollup sidecar write error. It will not be updated");
+				rollup.close(false);
+			}
+#endif
+			tr = TraceLog::span(TR_WRITE, tr);
+			if (!written) {
 				plog->severe(txtToLog + ". Write error");
 				plog->info("nMsgs:" + to_string((long long) nMsgs) + " nEpochs:" + to_string((long long) nEpochs));
 				return 6;
@@ -292,6 +581,7 @@ int acquireBin(SerialTxRx port, FILE *outFile, int maxMsgs, int maxEpochs, int p
 			break;
 		case 6:
 			plog->warning("Error reading. Patience exahusted or EOF");
+			if (wdogPeriod > 0) break;	//the watchdog will try to resync the receiver
 			plog->info("nMsgs:" + to_string((long long) nMsgs) + " nEpochs:" + to_string((long long) nEpochs));
 			return 7;
 		default:
@@ -299,7 +589,298 @@ int acquireBin(SerialTxRx port, FILE *outFile, int maxMsgs, int maxEpochs, int p
 			nErrors++;
 			break;
 		}
+		/// - If the watchdog is set, at the end of each window checks the number of valid messages received.
+		/// When it is below the minimum, or reading has failed, resyncs the receiver and resumes writing to the same file
+		if (wdogPeriod == 0) continue;
+		chrono::steady_clock::time_point now = chrono::steady_clock::now();
+		bool stalled = readResult == 6;
+		if (!stalled && now - windowStart < chrono::seconds(wdogPeriod)) continue;
+		stalled = stalled || windowMsgs < wdogMinMsgs;
+		if (stalled) {
+			plog->warning("Receiver stalled: " + to_string((long long) windowMsgs) + " valid messages in the watchdog window. Resync");
+			if (syncReceiver(rxPort, patience, plog)) {
+				sendSetupCmds(rxPort, plog);
+				if (!resumeReading(port)) plog->warning("Serial tuning profile not applied again after resync");
+				takeMessage(port, rxPort);
+				pending = true;
+				nResyncs++;
+				failedResyncs = 0;
+				plog->info("Receiver resynced in " + to_string((long long) chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - now).count())
+					+ "ms. Capture resumed");
+			} else if (++failedResyncs == MAXRESYNCS) {
+				plog->severe("Receiver resync failed " + to_string((long long) failedResyncs) + " times");
+				plog->info("nMsgs:" + to_string((long long) nMsgs) + " nEpochs:" + to_string((long long) nEpochs)
+					+ " nResyncs:" + to_string((long long) nResyncs));
+				return 7;
+			}
+			now = chrono::steady_clock::now();
+		}
+		windowStart = now;
+		windowMsgs = 0;
 	}
-	plog->info("Acq End; nMsgs:" + to_string((long long) nMsgs) + " nEpochs:" + to_string((long long) nEpochs));
+	plog->info("Acq End; nMsgs:" + to_string((long long) nMsgs) + " nEpochs:" + to_string((long long) nEpochs)
+		+ " nFiltered:" + to_string((long long) nFiltered) + " nResyncs:" + to_string((long long) nResyncs));
 	return 0;
 }
+
+/**setOutputProfile
+ * sets the receiver output profile having the given name, stating the messages expected from the receiver.
+ *
+ *@param name the profile name. If empty, no profile is set
+ *@param g50bps if MID8 with GPS 50bps nav message is also requested
+ *@param ephem if ephemeris data are requested
+ *@param stopMID the MID used to count epochs, which is always requested
+ *@throws error message if the profile name does not exist
+ */
+void setOutputProfile(string name, bool g50bps, bool ephem, int stopMID) {
+	if (name.empty()) return;
+	for (profileIdx = 0; profileIdx < NPROFILES && name.compare(outProfiles[profileIdx].name) != 0; profileIdx++);
+	if (profileIdx == NPROFILES) throw "Unknown output profile " + name;
+	profileSet = true;
+	vector<string> mids = getTokens(outProfiles[profileIdx].periodic, ',');
+	for (vector<string>::iterator it = mids.begin(); it != mids.end(); ++it) midProfile[stoi(*it)] = MIDPERIODIC;
+	if (stopMID >= 0 && stopMID < 256) midProfile[stopMID] = MIDPERIODIC;
+	//answers to commands and polls
+	midProfile[6] = midProfile[11] = midProfile[12] = midProfile[75] = MIDANSWER;
+	if (outProfiles[profileIdx].navData) {
+		if (g50bps) midProfile[8] = MIDPERIODIC;
+		midProfile[19] = MIDANSWER;
+		if (ephem) midProfile[15] = midProfile[70] = MIDANSWER;
+	}
+}
+
+/**addProfileCmds
+ * adds to the list of commands to be sent to the receiver the ones needed to output only the messages in the
+ * output profile stated: disable all messages and debug messages, enable each periodic one, and poll the ones to be
+ * answered.
+ *
+ *@param obsIntl the observation interval, in seconds
+ */
+void addProfileCmds(int obsIntl) {
+	string rate = to_string((long long) obsIntl);
+	lstWmsg.push_back(MSGwrite(166, "02 00 00 00 00 00 00", 10, "Disable all messages"));
+	lstWmsg.push_back(MSGwrite(166, "04 00 00 00 00 00 00", 16, "Disable debug msgs"));
+	for (int mid = 0; mid < 256; mid++) {
+		if (midProfile[mid] == MIDPERIODIC) {
+			string strMid = to_string((long long) mid);
+			lstWmsg.push_back(MSGwrite(166, "00 " + strMid + " " + rate + " 00 00 00 00", 10, "Enable message " + strMid + " at the interval stated"));
+		}
+	}
+	lstWmsg.push_back(MSGwrite(132, "00", 16, "Poll Software Version. Answer in MID6"));
+	if (midProfile[19] == MIDANSWER)
+		lstWmsg.push_back(MSGwrite(152, "00", 16, "Poll Navigation parameters. Answer in MID19"));
+	if (midProfile[15] == MIDANSWER) {
+		for (int i = 0; i < 3; i++) lstWmsg.push_back(MSGwrite(147, "00 00", 16, "Poll ephemeris. Answer in MID15"));
+		for (int i = 0; i < 3; i++) lstWmsg.push_back(MSGwrite(212, "0C", 16, "In SiRFV: GLONASS Broadcast Ephemeris Request SID12. Answer in MID70 SID12"));
+	}
+}
+
+/**checkCompliance
+ * logs the histogram of MIDs received and, if an output profile has been stated, verifies that the receiver
+ * complies with it: all periodic messages in the profile have been received, and no other messages except answers.
+ * Only messages received after the end of the first epoch are verified, as messages sent before the receiver applies
+ * the profile commands would be reported as unexpected.
+ *
+ *@param plog the pointer to the Logger
+ *@return true if the receiver complies with the profile or no profile is stated, false otherwise
+ */
+bool checkCompliance(Logger* plog) {
+	string histogram;
+	bool complies = true;
+	for (int mid = 0; mid < 256; mid++) {
+		if (midCount[mid] > 0) histogram += " " + to_string((long long) mid) + ":" + to_string((long long) midCount[mid]);
+		if (!profileSet) continue;
+		if (midProfile[mid] == MIDPERIODIC && complyCount[mid] == 0) {
+			plog->warning("Output profile " + string(outProfiles[profileIdx].name) + ": MID " + to_string((long long) mid) + " not received");
+			complies = false;
+		} else if (midProfile[mid] == 0 && complyCount[mid] > 0) {
+			plog->warning("Output profile " + string(outProfiles[profileIdx].name) + ": unexpected MID " + to_string((long long) mid)
+				+ " received " + to_string((long long) complyCount[mid]) + " times");
+			complies = false;
+		}
+	}
+	plog->info("MID histogram:" + histogram);
+	if (profileSet && complies) plog->info("Receiver complies with output profile " + string(outProfiles[profileIdx].name));
+	return complies;
+}
+
+/**setMsgFilter
+ * sets the rules to filter messages to be recorded from the given list.
+ * Each element in the list is a MID, or a MID/SID pair, to be kept. If preceded by -, it is to be discarded.
+ * If any element to be kept exists, only the listed messages are kept.
+ * Rules for MID/SID pairs take precedence over rules for MIDs.
+ *
+ *@param msgList a comma separated list of MID or MID/SID elements, optionally preceded by -
+ *@throws error message if the list has erroneous elements
+ */
+void setMsgFilter(string msgList) {
+	int mid, sid;
+	char c;
+	vector<string> items = getTokens(msgList, ',');
+	for (vector<string>::iterator it = items.begin(); it != items.end(); ++it) {
+		if (it->empty()) continue;
+		unsigned char rule = RULEKEEP;
+		const char* item = it->c_str();
+		if (*item == '-') {
+			rule = RULEDROP;
+			item++;
+		}
+		int n = sscanf(item, "%d/%d%c", &mid, &sid, &c);
+		if ((n != 1 && n != 2) || mid < 0 || mid > 255 || (n == 2 && (sid < 0 || sid > 255)))
+			throw "Erroneous message filter " + *it;
+		if (n == 2) sidRule[mid * 256 + sid] = rule;
+		else midRule[mid] = rule;
+		if (rule == RULEKEEP) keepListed = true;
+	}
+}
+
+/**setDecimation
+ * sets the decimation to be applied to messages with the given MIDs.
+ * Each element in the list has the format MID:N to keep one message each N, or MID:Ts to keep one message each T seconds.
+ *
+ *@param decimList a comma separated list of MID:N or MID:Ts elements
+ *@throws error message if the list has erroneous elements
+ */
+void setDecimation(string decimList) {
+	int mid;
+	double value;
+	char unit, c;
+	vector<string> items = getTokens(decimList, ',');
+	for (vector<string>::iterator it = items.begin(); it != items.end(); ++it) {
+		if (it->empty()) continue;
+		int n = sscanf(it->c_str(), "%d:%lf%c%c", &mid, &value, &unit, &c);
+		if (n < 2 || n > 3 || mid < 0 || mid > 255 || value <= 0 || (n == 3 && unit != 's'))
+			throw "Erroneous decimation " + *it;
+		if (n == 3) decimT[mid] = (long long) (value * 1000);
+		else if (value != (int) value) throw "Erroneous decimation " + *it;
+		else decimN[mid] = (int) value;
+		decimCount[mid] = 0;
+		decimLast[mid] = -decimT[mid];
+	}
+}
+
+/**passFilter
+ * checks if the given message passes the filters and decimation stated, and shall be recorded.
+ *
+ *@param payload the message payload
+ *@param len the payload length
+ *@return true if the message shall be recorded, false otherwise
+ */
+bool passFilter(unsigned char* payload, unsigned int len) {
+	int mid = payload[0];
+	unsigned char rule = len > 1? sidRule[mid * 256 + payload[1]] : 0;
+	if (rule == 0) rule = midRule[mid];
+	if (rule == RULEDROP || (rule == 0 && keepListed)) return false;
+	if (decimN[mid] > 1) {
+		if (decimCount[mid]++ % decimN[mid] != 0) return false;
+	}
+	if (decimT[mid] > 0) {
+		long long now = (long long) chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+		if (now - decimLast[mid] < decimT[mid]) return false;
+		decimLast[mid] = now;
+	}
+	return true;
+}
+
+/**setWatchdog
+ * sets the stall watchdog from the given definition T[:N]: the receiver shall be resynced when less than N valid
+ * messages are received in T seconds.
+ *
+ *@param wdog the watchdog definition. If empty, no watchdog is set
+ *@throws error message if the definition is not correct
+ */
+void setWatchdog(string wdog) {
+	char c;
+	if (wdog.empty()) return;
+	int n = sscanf(wdog.c_str(), "%d:%d%c", &wdogPeriod, &wdogMinMsgs, &c);
+	if (n < 1 || n > 2 || wdogPeriod <= 0 || wdogMinMsgs <= 0) throw "Erroneous watchdog " + wdog;
+}
+
+/**sendSetupCmds
+ * sends to the receiver the OSP commands in the list built to perform its setup.
+ *
+ *@param port the SerialTxRx object used to communicate with the receiver
+ *@param plog the pointer to the Logger
+ */
+void sendSetupCmds(SerialTxRx& port, Logger* plog) {
+	for (vector<MSGwrite>::iterator it = lstWmsg.begin() ; it != lstWmsg.end(); ++it) {
+		try {
+			plog->info("W OSP<" + to_string((long long) it->msgId) + "> b" + to_string((long long) it->base) +" pld:"+ it->payload + ". " + it->comment);
+			port.writeOSPcmd(it->msgId, it->payload, it->base);
+		} catch (string error) {	//an error has occurred when setting receiver
+			plog->severe(error);
+		}
+	}
+}
+
+/**syncReceiver
+ * synchronizes the receiver, at start when autosync is requested or when it has stalled: restores the port settings
+ * stated for the capture, detects the receiver protocol and baud rate, and changes them to OSP at the capture baud rate.
+ * The last valid OSP message read remains in the port buffers.
+ *
+ *@param port the SerialTxRx object used to communicate with the receiver
+ *@param patience the maximum number of bytes to read when waiting for a message start
+ *@param plog the pointer to the Logger
+ *@return true if the receiver is sending OSP messages at the capture baud rate, false otherwise
+ */
+bool syncReceiver(SerialTxRx& port, int patience, Logger* plog) {
+	int baud = stoi(parser.getStrOpt(BAUD));
+	ReceiverSync sync(port, patience, plog);
+	try {
+		port.setPortParams(baud, stoi(parser.getStrOpt(OBSINT)));
+		if (sync.synchronize(ReceiverSync::OSP) != ReceiverSync::OSP || !sync.setOSPbaud(baud)) {
+			plog->warning("Receiver sync failed: OSP at " + to_string((long long) baud) + " not reached");
+			return false;
+		}
+		port.setPortParams(baud, stoi(parser.getStrOpt(OBSINT)));
+	} catch (string error) {
+		plog->severe(error);
+		return false;
+	}
+	return true;
+}
+
+/**resumeReading
+ * prepares the reader to resume reading after the receiver has been resynced.
+ * When reading with the SerialTxRx object used for the resync (the only reader where DIRECTREAD is not available)
+ * there is nothing to prepare, and the object is not used.
+ *
+ *@return true
+ */
+bool resumeReading(SerialTxRx&) {
+	return true;
+}
+
+/**takeMessage
+ * makes available for reading the valid message already read with the SerialTxRx object.
+ * When reading with the SerialTxRx object which has read the message (the only reader where DIRECTREAD is not
+ * available), the message is already in its buffers, and the objects are not used.
+ */
+void takeMessage(SerialTxRx&, SerialTxRx&) {
+}
+
+#ifdef DIRECTREAD
+/**resumeReading
+ * prepares the reader to resume reading after the receiver has been resynced: bytes read before are discarded,
+ * and the tuning stated is applied again.
+ *
+ *@param stream the SerialStream object
+ *@return true if the tuning has been applied again, false otherwise
+ */
+bool resumeReading(SerialStream& stream) {
+	return stream.resume();
+}
+
+/**takeMessage
+ * makes available for reading the valid message already read with the SerialTxRx object, copying it to the
+ * SerialStream buffers.
+ *
+ *@param stream the SerialStream object used to read
+ *@param rxPort the SerialTxRx object which has read the message
+ */
+void takeMessage(SerialStream& stream, SerialTxRx& rxPort) {
+	stream.payloadLen = rxPort.payloadLen < SerialStream::MAXPAYLOADSIZE? rxPort.payloadLen : SerialStream::MAXPAYLOADSIZE;
+	memcpy(stream.paylenBuff, rxPort.paylenBuff, sizeof stream.paylenBuff);
+	memcpy(stream.payBuff, rxPort.payBuff, stream.payloadLen);
+}
+#endif
@@ -0,0 +1,254 @@
+/** @file ReceiverSync.cpp
+ * Contains the implementation of the ReceiverSync class.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release. Synchronization logic extracted from SynchroRX
+ */
+#include "ReceiverSync.h"
+
+#include <stdio.h>
+
+//@cond DUMMY
+///Maximum time limit for timeout when reading data from serial port
+const int MAXtimeout = 50;	//tenthsecons
+///Sleeping time to wait after sending to the receiver a command to change mode or speed (in milliseconds)
+const int SLPtime = 3000;
+//Bit rates that can be used
+const int bRates[] = {ReceiverSync::NMEAbRate, ReceiverSync::OSPbRate, 1200, 2400, 4800, 38400, 115200, 0};
+//arguments for SiRF receiver commands
+//NMEA cmd args to change mode from NMEA to OSP at 57600 bps baud rate
+const char* cmdNMEA100 = "0,57600,8,1,0";
+//OSP cmd args to set baud rate at 57600 bps
+const char* cmdOSP134 = "00 00 E1 00 08 01 00 00";
+//OSP cmd args to change mode from OSP to NMEA at 9600 bps baud rate
+const char* cmdOSP129 = "02 01 01 00 01 01 01 05 01 01 01 00 01 00 01 00 01 00 01 00 01 25 80";
+//@endcond
+
+/**ReceiverSync
+ * constructs a ReceiverSync for the receiver connected to the given port.
+ *
+ *@param port the SerialTxRx object, with the port already opened
+ *@param patience the maximum number of bytes to read when waiting for a message start
+ *@param plog the pointer to the logger
+ */
+ReceiverSync::ReceiverSync(SerialTxRx& port, int patience, Logger* plog) : port(port) {
+	this->patience = patience;
+	this->plog = plog;
+}
+
+/**detect
+ * discovers the receiver mode and baud rate, setting the computer port at the rate used by the receiver.
+ * First looks for "most likely" ones (NMEA at NMEAbRate, OSP at OSPbRate). When failed, iterates over all baud rates
+ * sending NMEA and OSP commands to set the receiver mode to OSP at OSPbRate, and then checks if it has changed.
+ *
+ *@return the protocol used by the receiver, or UNKNOWN if it cannot be detected
+ */
+ReceiverSync::Protocol ReceiverSync::detect() {
+	int currentBaud, currentTimeout;
+	bool rawMode;
+	char textBuf[200];
+	Protocol currentMode = UNKNOWN;
+	/// 1- Checks current computer baud rate
+	port.getPortParams(currentBaud, currentTimeout, rawMode);
+	logPortParams("Computer port initial settings");
+	/// 2- Discover initial receiver mode and baud rate, first look for "most likely" ones:
+	/// - if the computer computer baud rate is not the NMEA or OSP one, set the NMEA rate
+	/// - if computer baud rate is the NMEA one, check if receiver is sending NMEA messages
+	/// - if computer baud rate is the OSP one, check if receiver is sending OSP messages
+	if (currentBaud!=NMEAbRate && currentBaud!=OSPbRate) {
+		plog->info("As computer port baud rate is not for NMEA or OSP, set NMEA rate");
+		port.setPortParams(NMEAbRate, MAXtimeout);
+		port.getPortParams(currentBaud, currentTimeout, rawMode);
+		logPortParams("Computer port set at");
+	}
+	if (currentBaud == NMEAbRate) {
+		plog->info("As computer port baud rate is for NMEA, check if receiver is in NMEA mode");
+		if(checkProtocol(NMEA, 10)) currentMode = NMEA;
+		else {
+			plog->info("Receiver not sending NMEA. Try at OSP rate");
+			port.setPortParams(OSPbRate, MAXtimeout);
+			logPortParams("Computer port set at");
+			if(checkProtocol(OSP, 10)) currentMode = OSP;
+		}
+	} else if (currentBaud == OSPbRate) {
+		plog->info("As computer port baud rate is for OSP, check if receiver is in OSP mode");
+		if(checkProtocol(OSP, 10)) currentMode = OSP;
+		else {
+			plog->info("Receiver not sending OSP. Try at NMEA rate");
+			port.setPortParams(NMEAbRate, MAXtimeout);
+			logPortParams("Computer port set at");
+			if(checkProtocol(NMEA, 10)) currentMode = NMEA;
+		}
+	}
+	plog->info("Receiver initial protocol: " + protocolTXT(currentMode));
+	/// 3- When failed to discover receiver mode at usual baud rates, iterate over all baud rates
+	///		setting computer port speed and sending NMEA and OSP commands to set its mode to OSP at 57600 bps.
+	///		Then checks if the current receiver mode has changed to OSP.
+	if (currentMode == UNKNOWN) {	//mode not identified at usual baud rates
+		plog->info("Iterate over all baud rates trying to set receiver in OSP mode at 57600 bps");
+		//broadcast a change to OSP at 57600 in the receiver using all baud rates in the computer
+		for(int i=0; bRates[i]!=0; i++) {
+			port.setPortParams(bRates[i], MAXtimeout);
+			port.getPortParams(currentBaud, currentTimeout, rawMode);
+			port.writeNMEAcmd(100,cmdNMEA100);
+			port.writeNMEAcmd(100,cmdNMEA100);
+			sprintf(textBuf, "Computer port set at BaudRate %d and NMEA command sent to change to OSP mode at 57600 bps", currentBaud);
+			plog->info(string(textBuf));
+		}
+		for(int i=0; bRates[i]!=0; i++) {
+			port.setPortParams(bRates[i], MAXtimeout);
+			port.getPortParams(currentBaud, currentTimeout, rawMode);
+			port.writeOSPcmd(134,cmdOSP134);
+			port.writeOSPcmd(134,cmdOSP134);
+			sprintf(textBuf, "Computer port set at BaudRate %d and OSP command sent to change at 57600 bps", currentBaud);
+			plog->info(string(textBuf));
+		}
+		port.setPortParams(OSPbRate, MAXtimeout);
+		port.getPortParams(currentBaud, currentTimeout, rawMode);
+		sprintf(textBuf, "Computer port set at BaudRate %d to check if receiver is sending OSP at 57600 bps", currentBaud);
+		plog->info(string(textBuf));
+		if(checkProtocol(OSP, 2)) currentMode = OSP;
+		plog->info("After broadcasting change to OSP, receiver protocol is " + protocolTXT(currentMode));
+	}
+	return currentMode;
+}
+
+/**synchronize
+ * detects the receiver mode and baud rate and, if the mode is not the wanted one, changes it.
+ * If the current receiver mode is OSP, but it is wanted to be NMEA, sends a OSP command to change it, and sets
+ * computer port speed at NMEAbRate. If the current receiver mode is NMEA, but it is wanted to be OSP, sends a NMEA
+ * command to change it, and sets computer port speed at OSPbRate. Then checks if the mode has changed.
+ *
+ *@param wanted the protocol wanted (OSP or NMEA)
+ *@return the final protocol used by the receiver
+ */
+ReceiverSync::Protocol ReceiverSync::synchronize(Protocol wanted) {
+	char textBuf[200];
+	Protocol currentMode = detect();
+	if (currentMode==OSP && wanted==NMEA) {
+		plog->info("In receiver OSP mode, sends MID129 to change to NMEA at 9600 bps");
+		port.writeOSPcmd(129,cmdOSP129);
+		port.sleepTime(SLPtime);	//wait some seconds after changing receiver speed
+		port.setPortParams(NMEAbRate, MAXtimeout);		//now change computer port speed
+		if(checkProtocol(NMEA, 10)) currentMode = NMEA;
+	} else if (currentMode==NMEA && wanted==OSP) {
+		plog->info("In receiver NMEA mode, sends NMEA 100 to change to osp at 57600 bps");
+		port.writeNMEAcmd(100,cmdNMEA100);
+		port.sleepTime(SLPtime);	//wait some seconds after changing receiver speed
+		port.setPortParams(OSPbRate, MAXtimeout);		//now change computer port speed
+		if(checkProtocol(OSP, 10)) currentMode = OSP;
+	}
+	sprintf(textBuf, "Receiver final protocol: %s. Change is %s", protocolTXT(currentMode).c_str(), currentMode==wanted? "OK" : "NOK");
+	plog->info(string(textBuf));
+	logPortParams("Computer port final settings");
+	return currentMode;
+}
+
+/**setOSPbaud
+ * sets the receiver in OSP mode and the computer port at the given baud rate, sending to the receiver the OSP
+ * command MID134. The receiver shall be in OSP mode and synchronized with the computer port.
+ *
+ *@param baud the baud rate to set
+ *@return true if the receiver is sending OSP messages at the given baud rate, false otherwise
+ */
+bool ReceiverSync::setOSPbaud(int baud) {
+	int currentBaud, currentTimeout;
+	bool rawMode;
+	port.getPortParams(currentBaud, currentTimeout, rawMode);
+	if (currentBaud == baud) return true;
+	char cmd[40];
+	sprintf(cmd, "%02X %02X %02X %02X 08 01 00 00", (baud >> 24) & 0xFF, (baud >> 16) & 0xFF, (baud >> 8) & 0xFF, baud & 0xFF);
+	plog->info("Sends MID134 to change OSP baud rate to " + to_string((long long) baud));
+	port.writeOSPcmd(134, cmd);
+	port.sleepTime(SLPtime);	//wait some seconds after changing receiver speed
+	port.setPortParams(baud, currentTimeout);
+	logPortParams("Computer port set at");
+	return checkProtocol(OSP, 10);
+}
+
+/**checkProtocol
+ * checks if the given protocol is currently being used by the GPS receiver.
+ *
+ * @param prtcl the protocol to be checked (OSP or NMEA)
+ * @param ntimes the maximum number of attempts for receiving a message before returning a false result
+ * @return true when a correct message of the given protocol is received, false otherwise
+ */
+bool ReceiverSync::checkProtocol(Protocol prtcl, int ntimes) {
+	int resultCode;
+	string logMsg;
+	int nattempt = 0;
+	do {
+		resultCode = prtcl==NMEA? port.readNMEAmsg(patience) : port.readOSPmsg(patience);
+		ntimes--;
+		nattempt++;
+	} while (resultCode!=0 && ntimes>0);
+	//log result
+	if (prtcl == NMEA) {
+		logMsg = "Checked receiver NMEA mode: In attempt " + to_string((long long) nattempt) + ", ";
+		switch (resultCode) {
+		case 0: logMsg += "message OK"; break;
+		case 1: logMsg += "checksum error"; break;
+		case 2: logMsg += "message too short (<$XXX*SS)"; break;
+		case 3: logMsg += "no NMEA messages, or input error occurred, or EOF"; break;
+		case 4: logMsg += "no NMEA start received in " + to_string((long long) patience * nattempt) + " bytes"; break;
+		default: logMsg += "UNKNOWN";
+		}
+		plog->info(logMsg);
+		if (resultCode == 0) plog->fine("NMEA message received: " + string((char*) port.payBuff));
+	} else {
+		logMsg = "Checked receiver OSP mode: In attempt " + to_string((long long) nattempt) + ", ";
+		switch (resultCode) {
+		case 0: logMsg += "message OK"; break;
+		case 1: logMsg += "checksum error"; break;
+		case 2: logMsg += "error reading payload or few bytes"; break;
+		case 3: logMsg += "payload length out of margin"; break;
+		case 4:
+		case 5: logMsg += "error reading payload length"; break;
+		case 6: logMsg += "no OSP start received in " + to_string((long long) patience * nattempt) + " bytes"; break;
+		default: logMsg += "UNKNOWN";
+		}
+		plog->info(logMsg);
+		if (resultCode == 0) plog->fine("OSP message received: MID=" + to_string((long long) port.payBuff[0]) + " len=" + to_string((long long) port.payloadLen));
+	}
+	return resultCode == 0;
+}
+
+/**protocolTXT
+ * gives a readable description on the protocol
+ *
+ *@param p the protocol
+ *@return the protocol name
+ */
+string ReceiverSync::protocolTXT(Protocol p) {
+	switch (p) {
+	case NMEA: return "NMEA";
+	case OSP: return "OSP";
+	default: return "UNKNOWN";
+	}
+}
+
+/**logPortParams
+ * logs the current computer port settings.
+ *
+ *@param prefix the text to log before the settings
+ */
+void ReceiverSync::logPortParams(string prefix) {
+	int currentBaud, currentTimeout;
+	bool rawMode;
+	char textBuf[200];
+	port.getPortParams(currentBaud, currentTimeout, rawMode);
+	sprintf(textBuf, "%s: BaudRate=%d; Timeout=%d; RawMode=%c", prefix.c_str(), currentBaud, currentTimeout, rawMode?'T':'F');
+	plog->info(string(textBuf));
+}
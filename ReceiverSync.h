@@ -0,0 +1,68 @@
+/** @file ReceiverSync.h
+ * Contains the definition of the ReceiverSync class, used to synchronize a SiRF receiver and the computer serial port
+ * where it is connected.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release. Synchronization logic extracted from SynchroRX
+ */
+#ifndef RECEIVERSYNC_H
+#define RECEIVERSYNC_H
+
+#include <string>
+
+//from CommonClasses
+#include "Logger.h"
+#if defined(_WIN32) || defined(WIN32) || defined(_WIN64) || defined(WIN64)
+#include "SerialTxRxWin.h"
+#else
+#include "SerialTxRxLnx.h"
+#endif
+
+using namespace std;
+
+/**ReceiverSync synchronizes the computer serial port and the SiRF receiver connected to it, detecting the protocol
+ * (NMEA or OSP) and baud rate used by the receiver, and changing them to the wanted ones.
+ *<p>
+ * To allow synchronization it is assumed the following for the receiver:
+ * - It is providing data continuously, ASCII NMEA or binary OSP messages, depending on the mode.
+ * - It is receiving/sending data at 1200, 2400, 4800, 9600, 38400, 57600 or 115200 bps, with one stop bit and parity none.
+ *<p>
+ * After synchronization, bit rates will be set to NMEAbRate when exchanging NMEA data or to OSPbRate when exchanging
+ * OSP messages.
+ *<p>
+ * Methods performing communications can throw the error messages thrown by the SerialTxRx object.
+ */
+class ReceiverSync {
+public:
+	///Protocols / modes used by the receiver to exchange data
+	enum Protocol {OSP = 0, NMEA, UNKNOWN};
+	///Default baud rate for OSP binary data transfers
+	static const int OSPbRate = 57600;
+	///Default baud rate for NMEA ASCII data transfers
+	static const int NMEAbRate = 9600;
+
+	ReceiverSync(SerialTxRx& port, int patience, Logger* plog);
+	Protocol detect();
+	Protocol synchronize(Protocol wanted);
+	bool setOSPbaud(int baud);
+	bool checkProtocol(Protocol prtcl, int ntimes);
+	static string protocolTXT(Protocol p);
+private:
+	SerialTxRx& port;	//the port where the receiver is connected
+	int patience;		//maximum number of bytes to read when waiting for a message start
+	Logger* plog;		//the logger
+	void logPortParams(string prefix);
+};
+#endif
@@ -0,0 +1,368 @@
+/** @file ResultCache.cpp
+ * Contains the implementation of the ResultCache class and the Hash64 class it uses.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#include "ResultCache.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#if defined(__linux__)
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+
+//@cond DUMMY
+//XXH64 primes
+static const uint64_t PRIME1 = 11400714785074694791ULL;
+static const uint64_t PRIME2 = 14029467366897019727ULL;
+static const uint64_t PRIME3 = 1609587929392839161ULL;
+static const uint64_t PRIME4 = 9650029242287828579ULL;
+static const uint64_t PRIME5 = 2870177450012600261ULL;
+//the name of the file in each cache entry stating the outputs
+static const char* MANIFEST = "MANIFEST";
+
+static inline uint64_t rotl(uint64_t x, int r) {return (x << r) | (x >> (64 - r));}
+static inline uint64_t read64(const unsigned char* p) {
+	uint64_t v = 0;
+	for (int i = 7; i >= 0; i--) v = (v << 8) | p[i];
+	return v;
+}
+static inline uint32_t read32(const unsigned char* p) {
+	return (uint32_t) p[0] | ((uint32_t) p[1] << 8) | ((uint32_t) p[2] << 16) | ((uint32_t) p[3] << 24);
+}
+static inline uint64_t round64(uint64_t acc, uint64_t input) {
+	acc += input * PRIME2;
+	acc = rotl(acc, 31);
+	return acc * PRIME1;
+}
+static inline uint64_t merge64(uint64_t acc, uint64_t val) {
+	acc ^= round64(0, val);
+	return acc * PRIME1 + PRIME4;
+}
+//@endcond
+
+/**Hash64
+ * constructs a Hash64 object to compute the hash of a new stream.
+ *
+ *@param seed the hash seed
+ */
+Hash64::Hash64(uint64_t seed) {
+	this->seed = seed;
+	v[0] = seed + PRIME1 + PRIME2;
+	v[1] = seed + PRIME2;
+	v[2] = seed;
+	v[3] = seed - PRIME1;
+	totalLen = 0;
+	memSize = 0;
+}
+
+/**update
+ * adds data to the stream being hashed.
+ *
+ *@param data pointer to the data
+ *@param len the data length in bytes
+ */
+void Hash64::update(const void* data, size_t len) {
+	const unsigned char* p = (const unsigned char*) data;
+	const unsigned char* end = p + len;
+	totalLen += len;
+	if (memSize + len < 32) {
+		memcpy(mem + memSize, p, len);
+		memSize += len;
+		return;
+	}
+	if (memSize > 0) {	//complete the pending stripe
+		memcpy(mem + memSize, p, 32 - memSize);
+		for (int i = 0; i < 4; i++) v[i] = round64(v[i], read64(mem + i * 8));
+		p += 32 - memSize;
+		memSize = 0;
+	}
+	for (; p + 32 <= end; p += 32)
+		for (int i = 0; i < 4; i++) v[i] = round64(v[i], read64(p + i * 8));
+	memSize = end - p;
+	memcpy(mem, p, memSize);
+}
+
+/**digest
+ * gives the hash of the data added to the stream.
+ *
+ *@return the hash value
+ */
+uint64_t Hash64::digest() {
+	uint64_t h;
+	if (totalLen >= 32) {
+		h = rotl(v[0], 1) + rotl(v[1], 7) + rotl(v[2], 12) + rotl(v[3], 18);
+		for (int i = 0; i < 4; i++) h = merge64(h, v[i]);
+	} else h = seed + PRIME5;
+	h += totalLen;
+	const unsigned char* p = mem;
+	const unsigned char* end = mem + memSize;
+	for (; p + 8 <= end; p += 8) {
+		h ^= round64(0, read64(p));
+		h = rotl(h, 27) * PRIME1 + PRIME4;
+	}
+	if (p + 4 <= end) {
+		h ^= (uint64_t) read32(p) * PRIME1;
+		h = rotl(h, 23) * PRIME2 + PRIME3;
+		p += 4;
+	}
+	for (; p < end; p++) {
+		h ^= (*p) * PRIME5;
+		h = rotl(h, 11) * PRIME1;
+	}
+	h ^= h >> 33;
+	h *= PRIME2;
+	h ^= h >> 29;
+	h *= PRIME3;
+	h ^= h >> 32;
+	return h;
+}
+
+/**toHex
+ * gives the hash value as a string of 16 hexadecimal digits.
+ *
+ *@param h the hash value
+ *@return the hexadecimal string
+ */
+string Hash64::toHex(uint64_t h) {
+	char buf[17];
+	snprintf(buf, sizeof buf, "%016llx", (unsigned long long) h);
+	return string(buf);
+}
+
+/**ResultCache
+ * constructs an empty and disabled ResultCache object.
+ */
+ResultCache::ResultCache() {
+}
+
+/**open
+ * enables the cache using the given directory, which is created if it does not exist.
+ *
+ *@param cacheDir the cache directory. If empty, the cache remains disabled
+ *@param toolId the name and version of the command using the cache
+ *@return true if the cache is enabled, false otherwise
+ */
+bool ResultCache::open(string cacheDir, string toolId) {
+	this->cacheDir.clear();
+	if (cacheDir.empty()) return false;
+	if ((mkdir(cacheDir.c_str(), 0775) != 0) && (errno != EEXIST)) return false;
+	this->cacheDir = cacheDir;
+	this->toolId = toolId;
+	return true;
+}
+
+/**enabled
+ * tells if the cache is in use.
+ *
+ *@return true if enabled, false otherwise
+ */
+bool ResultCache::enabled() {
+	return !cacheDir.empty();
+}
+
+/**addInput
+ * adds to the conversion key the contents of the given input file.
+ * If the file cannot be read, the cache is disabled for this conversion.
+ *
+ *@param fileName the input file name
+ *@return true if the file has been hashed, false otherwise
+ */
+bool ResultCache::addInput(string fileName) {
+	if (!enabled()) return false;
+	static const size_t CHUNK = 1 << 20;
+	vector<unsigned char> buf(CHUNK);
+	FILE* f = fopen(fileName.c_str(), "rb");
+	if (f == NULL) {
+		cacheDir.clear();
+		return false;
+	}
+	Hash64 h;
+	size_t n;
+	while ((n = fread(&buf[0], 1, CHUNK, f)) > 0) h.update(&buf[0], n);
+	fclose(f);
+	inputHashes.push_back(Hash64::toHex(h.digest()));
+	return true;
+}
+
+/**addOption
+ * adds to the conversion key an option affecting the outputs.
+ *
+ *@param name the option name
+ *@param value the option value
+ */
+void ResultCache::addOption(string name, string value) {
+	options[name] = value;
+}
+
+/**addFlag
+ * adds to the conversion key a boolean option affecting the outputs.
+ *
+ *@param name the option name
+ *@param value the option value
+ */
+void ResultCache::addFlag(string name, bool value) {
+	options[name] = value? "TRUE" : "FALSE";
+}
+
+/**key
+ * computes the conversion key from the command identification, the input hashes and the options stated.
+ *
+ *@return the key as a string of 16 hexadecimal digits
+ */
+string ResultCache::key() {
+	string keyData = toolId + "\n";
+	for (vector<string>::iterator it = inputHashes.begin(); it != inputHashes.end(); ++it) keyData += *it + "\n";
+	for (map<string, string>::iterator it = options.begin(); it != options.end(); ++it)
+		keyData += it->first + "=" + it->second + "\n";
+	Hash64 h;
+	h.update(keyData.c_str(), keyData.size());
+	return Hash64::toHex(h.digest());
+}
+
+/**restore
+ * restores the outputs of a previous conversion having the same key, if it exists in the cache.
+ *
+ *@param plog the pointer to the logger
+ *@return true if all outputs have been restored, false otherwise
+ */
+bool ResultCache::restore(Logger* plog) {
+	if (!enabled()) return false;
+	string entry = cacheDir + "/" + key();
+	FILE* manifest = fopen((entry + "/" + MANIFEST).c_str(), "r");
+	if (manifest == NULL) return false;
+	char line[4200];
+	bool restored = true;
+	outputs.clear();
+	for (int i = 0; restored && (fgets(line, sizeof line, manifest) != NULL); i++) {
+		line[strcspn(line, "\r\n")] = 0;
+		string outFile = string(line);
+		restored = cloneFile(entry + "/out" + to_string((long long) i), outFile);
+		if (restored) {
+			plog->fine("Restored from cache " + outFile);
+			outputs.push_back(outFile);
+		} else plog->warning("Cannot restore from cache " + outFile);
+	}
+	fclose(manifest);
+	if (!restored) outputs.clear();
+	return restored;
+}
+
+/**release
+ * removes an existing output file before rewriting it, so as the new output is always written into a new file.
+ *
+ *@param outFile the output file name
+ */
+void ResultCache::release(string outFile) {
+	if (enabled()) unlink(outFile.c_str());
+}
+
+/**addOutput
+ * adds an output file to the list of outputs to store in the cache.
+ *
+ *@param outFile the output file name
+ */
+void ResultCache::addOutput(string outFile) {
+	if (enabled()) outputs.push_back(outFile);
+}
+
+/**outputFiles
+ * gives the output files added, or the ones restored from the cache.
+ *
+ *@return the output file names
+ */
+const vector<string>& ResultCache::outputFiles() {
+	return outputs;
+}
+
+/**store
+ * stores in the cache the outputs added. They are placed first in a temporary directory which is renamed to the
+ * entry name at the end, so as concurrent conversions never see incomplete entries.
+ *
+ *@param plog the pointer to the logger
+ *@return true if outputs have been stored, false otherwise
+ */
+bool ResultCache::store(Logger* plog) {
+	if (!enabled() || outputs.empty()) return false;
+	string entry = cacheDir + "/" + key();
+	string tmpEntry = entry + ".tmp" + to_string((long long) getpid());
+	if (mkdir(tmpEntry.c_str(), 0775) != 0) return false;
+	FILE* manifest = fopen((tmpEntry + "/" + MANIFEST).c_str(), "w");
+	bool stored = manifest != NULL;
+	for (size_t i = 0; stored && i < outputs.size(); i++) {
+		string cached = tmpEntry + "/out" + to_string((long long) i);
+		stored = cloneFile(outputs[i], cached) && (fprintf(manifest, "%s\n", outputs[i].c_str()) > 0);
+		if (stored) chmod(cached.c_str(), 0444);	//only the private copy in the cache is set read-only
+	}
+	if (manifest != NULL) stored = (fclose(manifest) == 0) && stored;
+	if (stored && (rename(tmpEntry.c_str(), entry.c_str()) == 0)) {
+		plog->info("Outputs stored in cache entry " + entry);
+		return true;
+	}
+	//remove the temporary entry: it is incomplete, or another process stored the same entry meanwhile
+	for (size_t i = 0; i < outputs.size(); i++) unlink((tmpEntry + "/out" + to_string((long long) i)).c_str());
+	unlink((tmpEntry + "/" + MANIFEST).c_str());
+	rmdir(tmpEntry.c_str());
+	if (!stored) plog->warning("Cannot store outputs in cache entry " + entry);
+	return false;
+}
+
+//@cond DUMMY
+/**cloneFile
+ * makes dst to have the same contents that src, using a reflink if possible, or copying data otherwise.
+ * Hard links are never used: dst shall not share its inode with src, as one of them is a user output which can be
+ * rewritten or have its permissions changed, and the other one is in the cache.
+ *
+ *@param src the source file
+ *@param dst the destination file. If it exists, it is replaced
+ *@return true if dst has been created, false otherwise
+ */
+bool ResultCache::cloneFile(string src, string dst) {
+	unlink(dst.c_str());
+	int sfd = ::open(src.c_str(), O_RDONLY);
+	if (sfd < 0) return false;
+#if defined(__linux__) && defined(FICLONE)
+	int dfd = ::open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0664);
+	if (dfd >= 0) {
+		if (ioctl(dfd, FICLONE, sfd) == 0) {
+			close(dfd);
+			close(sfd);
+			return true;
+		}
+		close(dfd);
+		unlink(dst.c_str());
+	}
+#endif
+	//copy data
+	bool copied = false;
+	int dfdc = ::open(dst.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0664);
+	if (dfdc >= 0) {
+		char buf[65536];
+		ssize_t n = 0;
+		copied = true;
+		while (copied && (n = read(sfd, buf, sizeof buf)) > 0) copied = write(dfdc, buf, n) == n;
+		copied = (close(dfdc) == 0) && copied && (n == 0);
+	}
+	close(sfd);
+	return copied;
+}
+//@endcond
@@ -0,0 +1,83 @@
+/** @file ResultCache.h
+ * Contains the definition of the ResultCache class, used by conversion commands to reuse the outputs of a previous
+ * conversion of the same input data with the same options.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+#include <map>
+
+#include "Logger.h"
+
+using namespace std;
+
+/**Hash64 computes the 64 bits xxHash (XXH64) of a data stream given in consecutive chunks.
+ */
+class Hash64 {
+public:
+	Hash64(uint64_t seed = 0);
+	void update(const void* data, size_t len);
+	uint64_t digest();
+	static string toHex(uint64_t h);
+private:
+	uint64_t v[4];			//the accumulators
+	uint64_t seed;
+	uint64_t totalLen;
+	unsigned char mem[32];	//bytes pending to complete a 32 bytes stripe
+	size_t memSize;
+};
+
+/**ResultCache defines data and methods to store and reuse conversion outputs.
+ * Each conversion is identified by a key computed hashing the command name and version, the contents of its input
+ * files, and the values of the options affecting the outputs (sorted by name, so as their order does not matter).
+ *<p>
+ * Outputs of a conversion are stored in the cache directory, in a subdirectory named with the key, together with a
+ * manifest stating the output file names. When a conversion with the same key is requested, outputs are restored
+ * from the cache using reflinks (copy on write clones) when the file system supports them, or copies otherwise.
+ * Outputs are stored in the cache the same way, so as a user output never shares its inode with a cached file.
+ * Files in the cache are set read-only, and outputs are removed before being rewritten (see release).
+ *<p>
+ * An empty cache directory name disables the cache: all methods do nothing.
+ */
+class ResultCache {
+public:
+	ResultCache();
+	bool open(string cacheDir, string toolId);
+	bool enabled();
+	bool addInput(string fileName);
+	void addOption(string name, string value);
+	void addFlag(string name, bool value);
+	string key();
+	bool restore(Logger* plog);
+	void release(string outFile);
+	void addOutput(string outFile);
+	const vector<string>& outputFiles();
+	bool store(Logger* plog);
+private:
+	string cacheDir;			//the cache directory. Empty when cache is disabled
+	string toolId;				//the command name and version
+	vector<string> inputHashes;	//the hashes of input files contents
+	map<string, string> options;//the options affecting the outputs
+	vector<string> outputs;		//the output files to store
+	static bool cloneFile(string src, string dst);
+};
+#endif
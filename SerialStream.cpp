@@ -0,0 +1,378 @@
+/** @file SerialStream.cpp
+ * Contains the implementation of the SerialStream class.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#include "SerialStream.h"
+
+#include <stdio.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/time.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#if defined(__linux__)
+#include <linux/serial.h>
+#endif
+#include <chrono>
+
+//@cond DUMMY
+#define START1 0xA0	///<OSP messages from receiver are preceded by the synchro sequence START1, START2
+#define START2 0xA2
+#define END1 0xB0	///<and followed by the sequence END1, END2
+#define END2 0xB3
+///Bytes to read each time in low latency tuning
+const size_t LOWLATENCY_READ = 64;
+///VMIN and VTIME (tenths of second of inter-byte timeout) in low wakeup tuning
+const cc_t LOWWAKEUP_VMIN = 255;
+const cc_t LOWWAKEUP_VTIME = 2;
+
+static int64_t msNow() {
+	return (int64_t) chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static int64_t usNow() {
+	return (int64_t) chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+//@endcond
+
+/**SerialStream
+ * constructs a SerialStream not yet opened.
+ */
+SerialStream::SerialStream() {
+	payloadLen = 0;
+	fd = -1;
+	timeout = 0;
+	bufPos = bufLen = 0;
+	offset = 0;
+	rawOut = markOut = NULL;
+	markPeriod = 0;
+	lastMark = 0;
+	tuning = TUNE_NONE;
+	savedFlags = -1;
+	readSize = sizeof buf;
+	byteTime = 0;
+	startTime = chunkTime = 0;
+	wakeups = nFrames = 0;
+	sumLatency = topLatency = 0;
+}
+
+/**~SerialStream
+ * closes the descriptor used, if open.
+ */
+SerialStream::~SerialStream() {
+	close();
+}
+
+/**open
+ * opens a non blocking descriptor to read from the given port. Port parameters are not modified.
+ *
+ *@param portName the device name of the serial port
+ *@param timeout the maximum time to wait for data, in milliseconds
+ *@return true if the port has been opened, false otherwise
+ */
+bool SerialStream::open(string portName, int timeout) {
+	close();
+	fd = ::open(portName.c_str(), O_RDONLY | O_NOCTTY | O_NONBLOCK);
+	this->timeout = timeout;
+	bufPos = bufLen = 0;
+	offset = 0;
+	tuning = TUNE_NONE;
+	readSize = sizeof buf;
+	startTime = chunkTime = usNow();
+	wakeups = nFrames = 0;
+	sumLatency = topLatency = 0;
+	return fd >= 0;
+}
+
+/**close
+ * restores the port attributes changed by tune, and closes the descriptor used, if open.
+ */
+void SerialStream::close() {
+	if (fd < 0) return;
+	if (tuning != TUNE_NONE) tcsetattr(fd, TCSANOW, &savedTio);
+#if defined(__linux__)
+	if (savedFlags >= 0) {
+		struct serial_struct serial;
+		if (ioctl(fd, TIOCGSERIAL, &serial) == 0) {
+			serial.flags = savedFlags;
+			ioctl(fd, TIOCSSERIAL, &serial);
+		}
+	}
+#endif
+	::close(fd);
+	fd = -1;
+	tuning = TUNE_NONE;
+	savedFlags = -1;
+}
+
+/**setTee
+ * states where bytes read and markers will be written.
+ *
+ *@param rawOut the writer for all bytes read from the port, or NULL if they are not teed
+ *@param markOut the writer for offset/time markers, or NULL if markers are not written
+ *@param markPeriod the minimum time between markers, in milliseconds
+ */
+void SerialStream::setTee(AsyncWriter* rawOut, AsyncWriter* markOut, int markPeriod) {
+	this->rawOut = rawOut;
+	this->markOut = markOut;
+	this->markPeriod = markPeriod;
+	lastMark = msNow() - markPeriod;
+}
+
+/**tune
+ * tunes the port reading. Reads become blocking, and port attributes VMIN and VTIME are changed: they are shared with
+ * other descriptors opened on the port.
+ * In low latency tuning, the ASYNC_LOW_LATENCY flag is also set in the driver, if it supports it.
+ *
+ *@param tuning the tuning to apply
+ *@param baud the port baud rate, used to estimate the arrival time of bytes
+ *@return true if the tuning has been fully applied, false otherwise
+ */
+bool SerialStream::tune(Tuning tuning, int baud) {
+	if (fd < 0) return false;
+	byteTime = baud > 0? 1.0E7 / baud : 0;	//10 bits per byte
+	if (tuning == TUNE_NONE) return true;
+	struct termios tio;
+	if (tcgetattr(fd, &tio) != 0) return false;
+	savedTio = tio;
+	bool done = true;
+	if (tuning == TUNE_LOWLATENCY) {
+		tio.c_cc[VMIN] = 1;
+		tio.c_cc[VTIME] = 0;
+		readSize = LOWLATENCY_READ;
+#if defined(__linux__)
+		struct serial_struct serial;
+		if (ioctl(fd, TIOCGSERIAL, &serial) == 0) {
+			savedFlags = serial.flags;
+			serial.flags |= ASYNC_LOW_LATENCY;
+			done = ioctl(fd, TIOCSSERIAL, &serial) == 0;
+			if (!done) savedFlags = -1;
+		} else done = false;
+#else
+		done = false;
+#endif
+	} else {
+		tio.c_cc[VMIN] = LOWWAKEUP_VMIN;
+		tio.c_cc[VTIME] = LOWWAKEUP_VTIME;
+		readSize = sizeof buf;
+	}
+	if (tcsetattr(fd, TCSANOW, &tio) != 0) return false;
+	this->tuning = tuning;
+	int flags = fcntl(fd, F_GETFL);
+	if (flags < 0 || fcntl(fd, F_SETFL, flags & ~O_NONBLOCK) != 0) {
+		this->tuning = TUNE_NONE;
+		tcsetattr(fd, TCSANOW, &savedTio);
+		return false;
+	}
+	return done;
+}
+
+/**resume
+ * prepares the stream to resume reading after the port has been set by other descriptor, for example when the
+ * receiver has been resynchronized: bytes in the buffer are discarded, and the tuning stated is applied again.
+ * The port attributes to be restored when closing become the current ones.
+ *
+ *@return true if the tuning has been applied again, false otherwise
+ */
+bool SerialStream::resume() {
+	if (fd < 0) return false;
+	bufPos = bufLen = 0;
+	if (tuning == TUNE_NONE) return true;
+	struct termios tio;
+	if (tcgetattr(fd, &tio) != 0) return false;
+	savedTio = tio;
+	if (tuning == TUNE_LOWLATENCY) {
+		tio.c_cc[VMIN] = 1;
+		tio.c_cc[VTIME] = 0;
+	} else {
+		tio.c_cc[VMIN] = LOWWAKEUP_VMIN;
+		tio.c_cc[VTIME] = LOWWAKEUP_VTIME;
+	}
+	return tcsetattr(fd, TCSANOW, &tio) == 0;
+}
+
+/**readOSPmsg
+ * skips bytes from the port until the start of an OSP message, reads the message, and verifies it.
+ * Payload data and length are placed in payBuff, paylenBuff, and payloadLen.
+ *
+ *@param patience the maximum number of bytes to skip when waiting for the message start
+ *@return the read status according to the following values and meaning:
+ *		- (0) message is correct
+ *		- (1) error in checksum
+ *		- (2) error reading checksum or tail
+ *		- (3) error: length out of margin
+ *		- (4) error reading payload length
+ *		- (5) error reading payload
+ *		- (6) patience exhausted, timeout or read error when waiting for the message start
+ */
+int SerialStream::readOSPmsg(unsigned int patience) {
+	int c;
+	unsigned int skipped = 0;
+	bool start1 = false;
+	//find the synchro sequence
+	while (true) {
+		if ((c = getByte()) < 0) return 6;
+		if (start1 && c == START2) break;
+		start1 = c == START1;
+		if (!start1 && ++skipped > patience) return 6;
+	}
+	payloadLen = 0;
+	if (!getBytes(paylenBuff, 2)) return 4;
+	payloadLen = ((unsigned int) paylenBuff[0] << 8) | paylenBuff[1];
+	if (payloadLen == 0 || payloadLen > MAXPAYLOADSIZE) {
+		payloadLen = 0;
+		return 3;
+	}
+	if (!getBytes(payBuff, payloadLen)) return 5;
+	unsigned char tail[4];
+	if (!getBytes(tail, 4)) return 2;
+	unsigned int checksum = 0;
+	for (unsigned int i = 0; i < payloadLen; i++) checksum += payBuff[i];
+	checksum &= 0x7FFF;
+	if (checksum != (((unsigned int) tail[0] << 8) | tail[1])) return 1;
+	if (tail[2] != END1 || tail[3] != END2) return 2;
+	//latency from the estimated arrival of the last message byte
+	double latency = (bufLen - bufPos) * byteTime + (usNow() - chunkTime);
+	sumLatency += latency;
+	if (latency > topLatency) topLatency = latency;
+	nFrames++;
+	return 0;
+}
+
+/**bytesRead
+ * gives the number of bytes read from the port.
+ *
+ *@return the number of bytes
+ */
+uint64_t SerialStream::bytesRead() {
+	return offset;
+}
+
+/**wakeupsPerSecond
+ * gives the mean number of times per second the reading thread has been woken up since the port was opened.
+ *
+ *@return the wakeups per second
+ */
+double SerialStream::wakeupsPerSecond() {
+	int64_t elapsed = usNow() - startTime;
+	return elapsed > 0? wakeups * 1.0E6 / elapsed : 0;
+}
+
+/**meanLatency
+ * gives the mean latency from the arrival of the last byte of each message to its framing.
+ *
+ *@return the mean latency in microseconds
+ */
+double SerialStream::meanLatency() {
+	return nFrames > 0? sumLatency / nFrames : 0;
+}
+
+/**maxLatency
+ * gives the maximum latency from the arrival of the last byte of a message to its framing.
+ *
+ *@return the maximum latency in microseconds
+ */
+double SerialStream::maxLatency() {
+	return topLatency;
+}
+
+/**fill
+ * waits for data in the port and reads them into the buffer, teeing them and writing a marker if required.
+ *
+ *@return true if data have been read, false if timeout or read error happened
+ */
+bool SerialStream::fill() {
+	if (fd < 0) return false;
+	struct pollfd pfd;
+	pfd.fd = fd;
+	pfd.events = POLLIN;
+	ssize_t n;
+	if (tuning == TUNE_NONE) {	//non blocking reads, waiting in poll when no data are available
+		while (true) {
+			n = read(fd, buf, readSize);
+			if (n > 0) break;
+			if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)) return false;
+			int ready = poll(&pfd, 1, timeout);
+			wakeups++;
+			if (ready == 0) return false;
+			if (ready < 0 && errno != EINTR) return false;
+		}
+	} else {	//blocking reads, after waiting in poll for the first byte to bound the waiting time
+		while (true) {
+			int ready = poll(&pfd, 1, timeout);
+			wakeups++;
+			if (ready == 0) return false;
+			if (ready < 0) {
+				if (errno == EINTR) continue;
+				return false;
+			}
+			n = read(fd, buf, readSize);
+			if (tuning == TUNE_LOWWAKEUP) wakeups++;	//read waits for VMIN bytes or the inter-byte timeout
+			if (n > 0) break;
+			if (n == 0 || errno != EINTR) return false;
+		}
+	}
+	chunkTime = usNow();
+	if (markOut != NULL) {
+		int64_t now = msNow();
+		if (now - lastMark >= markPeriod) {
+			struct timeval tv;
+			gettimeofday(&tv, NULL);
+			char mark[64];
+			int len = snprintf(mark, sizeof mark, "%llu %ld.%06ld\n", (unsigned long long) offset, (long) tv.tv_sec, (long) tv.tv_usec);
+			markOut->write(mark, len);
+			lastMark = now;
+		}
+	}
+	if (rawOut != NULL) rawOut->write(buf, n);
+	offset += n;
+	bufPos = 0;
+	bufLen = n;
+	return true;
+}
+
+/**getByte
+ * gets the next byte from the port.
+ *
+ *@return the byte value, or -1 if timeout or read error happened
+ */
+int SerialStream::getByte() {
+	if (bufPos == bufLen && !fill()) return -1;
+	return buf[bufPos++];
+}
+
+/**getBytes
+ * gets the given number of bytes from the port.
+ *
+ *@param dst where bytes will be placed
+ *@param n the number of bytes to get
+ *@return true if all bytes have been got, false if timeout or read error happened
+ */
+bool SerialStream::getBytes(unsigned char* dst, size_t n) {
+	while (n > 0) {
+		if (bufPos == bufLen && !fill()) return false;
+		size_t avail = bufLen - bufPos;
+		size_t k = n < avail? n : avail;
+		for (size_t i = 0; i < k; i++) dst[i] = buf[bufPos + i];
+		bufPos += k;
+		dst += k;
+		n -= k;
+	}
+	return true;
+}
@@ -0,0 +1,95 @@
+/** @file SerialStream.h
+ * Contains the definition of the SerialStream class, used to read and frame the OSP messages flowing from a receiver
+ * connected to a serial port, having access to all bytes read.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef SERIALSTREAM_H
+#define SERIALSTREAM_H
+
+#include <stdint.h>
+#include <termios.h>
+#include <string>
+
+#include "AsyncWriter.h"
+
+using namespace std;
+
+/**SerialStream reads the data stream coming from a serial port and extracts from it OSP messages.
+ * It is intended to be used on a port already opened and set (baud rate, etc.) with a SerialTxRx object: the
+ * SerialStream opens its own non blocking descriptor on the same device and reads from it, instead of the SerialTxRx.
+ * The interface for reading OSP messages is the same as the SerialTxRx one.
+ *<p>
+ * All bytes read from the port, including the ones skipped or belonging to erroneous messages, can be copied (teed)
+ * to an AsyncWriter. In this case, markers stating the stream offset and the time of reading can also be written
+ * periodically to another AsyncWriter, as text lines "offset seconds.microseconds" (seconds from the Unix epoch).
+ *<p>
+ * Port reading can be tuned for low latency (ASYNC_LOW_LATENCY driver flag, VMIN=1/VTIME=0, small reads) or for low
+ * wakeups (large VMIN with inter-byte timeout, to read bytes in batches). The port attributes are restored when the
+ * SerialStream is closed. To compare them, the wakeups per second of
+ * the reading thread, and the latency from the arrival of the last byte of each message to its framing, are measured.
+ * The arrival time of a byte is estimated from the time its read ended, the bytes read after it, and the baud rate.
+ *<p>
+ * This class is available only on POSIX systems.
+ */
+class SerialStream {
+public:
+	///Tunings of the port reading
+	enum Tuning {TUNE_NONE = 0, TUNE_LOWLATENCY, TUNE_LOWWAKEUP};
+	static const unsigned int MAXPAYLOADSIZE = 2048;	//the maximum size in bytes of any message payload
+	unsigned char payBuff[MAXPAYLOADSIZE];	//buffer for the OSP message payload
+	unsigned char paylenBuff[2];			//buffer for the OSP message payload length
+	unsigned int payloadLen;				//the payload length in bytes of current message
+
+	SerialStream();
+	~SerialStream();
+	bool open(string portName, int timeout);
+	void close();
+	void setTee(AsyncWriter* rawOut, AsyncWriter* markOut, int markPeriod);
+	bool tune(Tuning tuning, int baud);
+	bool resume();
+	int readOSPmsg(unsigned int patience);
+	uint64_t bytesRead();
+	double wakeupsPerSecond();
+	double meanLatency();
+	double maxLatency();
+private:
+	int fd;						//the descriptor used to read from the port
+	int timeout;				//the maximum time to wait for data, in milliseconds
+	unsigned char buf[4096];	//the buffer for bytes read from the port
+	size_t bufPos;				//position of the next byte in buf to be used
+	size_t bufLen;				//number of bytes in buf
+	uint64_t offset;			//number of bytes read from the port
+	AsyncWriter* rawOut;		//where all bytes read are teed, if not NULL
+	AsyncWriter* markOut;		//where offset/time markers are written, if not NULL
+	int markPeriod;				//the minimum time between markers, in milliseconds
+	int64_t lastMark;			//the time of the last marker, in milliseconds
+	Tuning tuning;				//the tuning applied
+	struct termios savedTio;	//the port attributes before tuning, restored when closing
+	int savedFlags;				//the driver flags before tuning, or -1 if not changed
+	size_t readSize;			//the maximum number of bytes to read each time
+	double byteTime;			//the time to transmit a byte at the port baud rate, in microseconds
+	int64_t startTime;			//the time the port was opened, in microseconds
+	int64_t chunkTime;			//the time the last read ended, in microseconds
+	uint64_t wakeups;			//times the reading thread has been woken up
+	uint64_t nFrames;			//number of messages framed
+	double sumLatency;			//sum of the latencies of messages framed, in microseconds
+	double topLatency;			//maximum latency of messages framed, in microseconds
+	bool fill();
+	int getByte();
+	bool getBytes(unsigned char* dst, size_t n);
+};
+#endif
@@ -0,0 +1,402 @@
+/** @file SpoolToRINEX.cpp
+ * Contains the command line program that watches spool directories and converts into OSP, RINEX and RTK files the
+ * GP2, PKT and OSP files dropped into them.
+ *<p>Usage:
+ *<p>SpoolToRINEX {options}
+ *<p>Options are:
+ *	- -b BINDIR or --bindir=BINDIR : Directory where the conversion commands are. Default value BINDIR = .
+ *	- -h or --help : Show usage data and stops. Default value HELP=FALSE
+ *	- -j JOURNAL or --journal=JOURNAL : File where processed input files are recorded. Default value JOURNAL = SPOOL.jnl
+ *	- -l LOGLEVEL or --llevel=LOGLEVEL : Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST). Default value LOGLEVEL = INFO
+ *	- -o OUTDIR or --outdir=OUTDIR : Directory where conversion outputs are placed. Default value OUTDIR = .
+ *	- -p PRIO or --priority=PRIO : Input file types in priority order. Default value PRIO = OSP,PKT,GP2
+ *	- -r RNXOPT or --rinexopt=RNXOPT : Options to pass to OSPtoRINEX (blank separated). Default value RNXOPT = -n
+ *	- -s SPOOL or --spool=SPOOL : Comma separated list of spool directories to watch. Default value SPOOL = .
+ *	- -w WORKERS or --workers=WORKERS : Maximum number of conversions running at the same time. Default value WORKERS = 2
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+
+//from CommonClasses
+#include "ArgParser.h"
+#include "Logger.h"
+#include "Utilities.h"
+//from this project
+#include "ConversionChain.h"
+#include "FileList.h"
+//standard and Linux
+#include <stdio.h>
+#include <string.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <errno.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <set>
+#include <map>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+using namespace std;
+
+//@cond DUMMY
+///The command line format
+const string CMDLINE = "SpoolToRINEX {options}";
+///The current program version
+const string MYVER = " V1.0";
+///The parser object to store options and operators passed in the command line
+ArgParser parser;
+//Metavariables for options
+int BINDIR, HELP, JOURNAL, LOGLEVEL, OUTDIR, PRIO, RNXOPT, SPOOL, WORKERS;
+
+///A conversion job: an input file waiting to be converted
+struct Job {
+	string path;		//the input file
+	string key;			//the key identifying the file contents: path, size and modification time
+	int priority;		//the lower the value, the higher the priority
+	unsigned long seq;	//arrival order, used to keep FIFO order among files with the same priority
+
+	Job(string pth, string k, int prio, unsigned long sq) {
+		path = pth;
+		key = k;
+		priority = prio;
+		seq = sq;
+	}
+};
+///Ordering for the job queue: priority first, arrival order after
+struct JobOrder {
+	bool operator()(const Job& a, const Job& b) const {
+		if (a.priority != b.priority) return a.priority > b.priority;
+		return a.seq > b.seq;
+	}
+};
+//the queue of pending jobs and related state, protected by queueMtx
+priority_queue<Job, vector<Job>, JobOrder> jobs;
+set<string> knownKeys;		//keys of files converted without errors (from journal), queued or being converted
+set<string> busyDirs;		//working directories of the conversions in progress
+multimap<string, Job> deferred;	//jobs waiting for the end of a conversion using the same working directory
+unsigned long jobSeq = 0;
+bool stopping = false;
+mutex queueMtx;
+condition_variable queueCv;
+//the journal of processed files, and the logger, shared by workers
+FILE* journal = NULL;
+mutex journalMtx;
+mutex logMtx;
+vector<string> prioList;
+volatile sig_atomic_t stopRequested = 0;
+//functions in this file
+string fileKey(string path);
+int loadJournal(string fileName);
+void enqueue(string path, Logger* plog);
+void scanSpool(string dir, Logger* plog);
+void worker(ConversionChain* chain, Logger* plog);
+void onSignal(int);
+//@endcond
+
+/**main
+ * gets the command line arguments, set parameters accordingly and starts the spool watching service.
+ *<p>
+ * Each spool directory is watched using inotify. A file is considered complete when it is closed after being written,
+ * or when it is renamed (moved) into the spool directory. Files with extension GP2, PKT or OSP are queued for
+ * conversion according to the priority given to their type, and converted by a bounded pool of workers.
+ * For each file the conversion chain is: GP2toOSP or PacketToOSP (if not already an OSP file), followed by OSPtoRINEX
+ * and OSPtoRTK. Outputs are placed in a directory under OUTDIR named after the input file.
+ *<p>
+ * Each converted file is recorded in the journal file together with the conversion result, its size and modification
+ * time. Files recorded as converted without errors are not converted again when the service restarts, and failed ones
+ * are retried. Failed files are also retried while the service runs when they are dropped again or the spool
+ * directories are rescanned. At start up, spool directories are scanned to queue files arrived while the service was not running.
+ * They are also rescanned when inotify events are lost by an event queue overflow.
+ *<p>
+ * The service ends when it receives SIGINT or SIGTERM, after ending the conversions in progress.
+ *
+ *@param argc the number of arguments passed from the command line
+ *@param argv the array of arguments passed from the command line
+ *@return  the exit status according to the following values and meaning:
+ *		- (0) no errors have been detected
+ *		- (1) an error has been detected in arguments
+ *		- (2) error when setting the watch on spool directories
+ *		- (3) error when opening the journal file
+ */
+int main(int argc, char** argv) {
+	/**The main process sequence follows:*/
+	/// 1- Defines and sets the error logger object
+	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
+	/// 2- Setups the valid options in the command line. They will be used by the argument/option parser
+	WORKERS = parser.addOption("-w", "--workers", "WORKERS", "Maximum number of conversions running at the same time", "2");
+	SPOOL = parser.addOption("-s", "--spool", "SPOOL", "Comma separated list of spool directories to watch", ".");
+	RNXOPT = parser.addOption("-r", "--rinexopt", "RNXOPT", "Options to pass to OSPtoRINEX (blank separated)", "-n");
+	PRIO = parser.addOption("-p", "--priority", "PRIO", "Input file types in priority order", "OSP,PKT,GP2");
+	OUTDIR = parser.addOption("-o", "--outdir", "OUTDIR", "Directory where conversion outputs are placed", ".");
+	LOGLEVEL = parser.addOption("-l", "--llevel", "LOGLEVEL", "Maximum level to log (SEVERE, WARNING, INFO, CONFIG, FINE, FINER, FINEST)", "INFO");
+	JOURNAL = parser.addOption("-j", "--journal", "JOURNAL", "File where processed input files are recorded", "SPOOL.jnl");
+	HELP = parser.addOption("-h", "--help", "HELP", "Show usage data and stops", false);
+	BINDIR = parser.addOption("-b", "--bindir", "BINDIR", "Directory where the conversion commands are", ".");
+	/// 3- Parses arguments in the command line extracting options and operators
+	try {
+		parser.parseArgs(argc, argv);
+	}  catch (string error) {
+		parser.usage("Argument error: " + error, CMDLINE);
+		log.severe(error);
+		return 1;
+	}
+	log.info(parser.showOptValues());
+	if (parser.getBoolOpt(HELP)) {
+		//help info has been requested
+		parser.usage("Watches spool directories and converts to OSP, RINEX and RTK the GP2, PKT and OSP files dropped into them", CMDLINE);
+		return 0;
+	}
+	/// 4- Sets logging level stated in option
+	log.setLevel(parser.getStrOpt(LOGLEVEL));
+	int nWorkers = stoi(parser.getStrOpt(WORKERS));
+	if (nWorkers < 1) {
+		log.severe("Incorrect number of workers");
+		return 1;
+	}
+	prioList = getTokens(parser.getStrOpt(PRIO), ',');
+	/// 5- Loads the journal of already processed files and opens it to append new ones
+	int n = loadJournal(parser.getStrOpt(JOURNAL));
+	if ((journal = fopen(parser.getStrOpt(JOURNAL).c_str(), "a")) == NULL) {
+		log.severe("Cannot open journal file " + parser.getStrOpt(JOURNAL));
+		return 3;
+	}
+	log.info("Files already processed in journal: " + to_string((long long) n));
+	/// 6- Sets the watches on the spool directories. They are set before scanning to not miss files arriving meanwhile
+	int inFd = inotify_init();
+	if (inFd < 0) {
+		log.severe("Cannot initialize inotify");
+		return 2;
+	}
+	map<int, string> watched;
+	vector<string> spools = getTokens(parser.getStrOpt(SPOOL), ',');
+	for (vector<string>::iterator it = spools.begin(); it != spools.end(); ++it) {
+		int wd = inotify_add_watch(inFd, it->c_str(), IN_CLOSE_WRITE | IN_MOVED_TO);
+		if (wd < 0) {
+			log.severe("Cannot watch spool directory " + *it + ": " + string(strerror(errno)));
+			return 2;
+		}
+		watched[wd] = *it;
+	}
+	/// 7- Queues files already existing in the spool directories and not yet processed
+	for (vector<string>::iterator it = spools.begin(); it != spools.end(); ++it) scanSpool(*it, &log);
+	/// 8- Starts the pool of workers. Stop signals are blocked in workers to be delivered to the main thread
+	struct sigaction sa;
+	memset(&sa, 0, sizeof sa);
+	sa.sa_handler = onSignal;	//without SA_RESTART, to interrupt the blocking read
+	sigaction(SIGINT, &sa, NULL);
+	sigaction(SIGTERM, &sa, NULL);
+	sigset_t stopSignals;
+	sigemptyset(&stopSignals);
+	sigaddset(&stopSignals, SIGINT);
+	sigaddset(&stopSignals, SIGTERM);
+	pthread_sigmask(SIG_BLOCK, &stopSignals, NULL);
+	ConversionChain chain(parser.getStrOpt(BINDIR), parser.getStrOpt(OUTDIR), getTokens(parser.getStrOpt(RNXOPT), ' '));
+	vector<thread> pool;
+	for (int i = 0; i < nWorkers; i++) pool.push_back(thread(worker, &chain, &log));
+	pthread_sigmask(SIG_UNBLOCK, &stopSignals, NULL);
+	/// 9- Waits for inotify events and queues files completed, until a stop signal arrives
+	char evBuf[4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	while (!stopRequested) {
+		ssize_t len = read(inFd, evBuf, sizeof evBuf);
+		if (len <= 0) {
+			if (len < 0 && errno == EINTR) continue;
+			lock_guard<mutex> lock(logMtx);
+			log.severe("Error reading inotify events");
+			break;
+		}
+		for (char* p = evBuf; p < evBuf + len; p += sizeof(struct inotify_event) + ((struct inotify_event*) p)->len) {
+			struct inotify_event* ev = (struct inotify_event*) p;
+			if (ev->mask & IN_Q_OVERFLOW) {
+				//events have been lost: files dropped meanwhile are found rescanning the spool directories
+				{
+					lock_guard<mutex> lock(logMtx);
+					log.warning("Inotify event queue overflow. Rescanning spool directories");
+				}
+				for (vector<string>::iterator it = spools.begin(); it != spools.end(); ++it) scanSpool(*it, &log);
+				continue;
+			}
+			if ((ev->len == 0) || (ev->mask & IN_ISDIR)) continue;
+			map<int, string>::iterator w = watched.find(ev->wd);
+			if (w != watched.end()) enqueue(w->second + "/" + string(ev->name), &log);
+		}
+	}
+	/// 10- Stops workers after ending the conversions in progress
+	{
+		lock_guard<mutex> lock(logMtx);
+		log.info("Stop requested. Waiting for conversions in progress");
+	}
+	{
+		lock_guard<mutex> lock(queueMtx);
+		stopping = true;
+	}
+	queueCv.notify_all();
+	for (size_t i = 0; i < pool.size(); i++) pool[i].join();
+	close(inFd);
+	fclose(journal);
+	log.info("Pending files not converted: " + to_string((long long) (jobs.size() + deferred.size())));
+	return 0;
+}
+
+//@cond DUMMY
+/**fileKey
+ * builds the key identifying a file and its contents: the path, the size and the modification time.
+ *
+ *@param path the file path
+ *@return the key, or an empty string if the file does not exist or it is not a regular file
+ */
+string fileKey(string path) {
+	struct stat st;
+	if ((stat(path.c_str(), &st) != 0) || !S_ISREG(st.st_mode)) return string();
+	return to_string((long long) st.st_size) + " " + to_string((long long) st.st_mtime) + " " + path;
+}
+
+/**loadJournal
+ * loads keys of the files recorded in the journal as converted without errors. Each journal line contains the
+ * conversion result and the file key. Files whose conversion failed are not loaded, so as they are converted again.
+ *
+ *@param fileName the journal file name
+ *@return the number of files converted
+ */
+int loadJournal(string fileName) {
+	char line[4200];
+	int n = 0;
+	FILE* jnl = fopen(fileName.c_str(), "r");
+	if (jnl == NULL) return 0;
+	while (fgets(line, sizeof line, jnl) != NULL) {
+		char* key = strchr(line, ' ');
+		if (key == NULL) continue;
+		*key++ = 0;
+		if (strcmp(line, "0") != 0) continue;
+		key[strcspn(key, "\r\n")] = 0;
+		if (knownKeys.insert(string(key)).second) n++;
+	}
+	fclose(jnl);
+	return n;
+}
+
+/**enqueue
+ * queues the given file for conversion, if it has a convertible type and it has not been processed or queued.
+ *
+ *@param path the file path
+ *@param plog the pointer to the logger
+ */
+void enqueue(string path, Logger* plog) {
+	if (ConversionChain::firstStage(path) == NSTAGES) return;
+	string key = fileKey(path);
+	if (key.empty()) return;
+	//priority is given by the position of the file type in the priority list
+	string ext = FileList::upperExt(path);
+	int prio = (int) prioList.size();
+	for (size_t i = 0; i < prioList.size(); i++) if (prioList[i].compare(ext) == 0) prio = (int) i;
+	{
+		lock_guard<mutex> lock(queueMtx);
+		if (!knownKeys.insert(key).second) return;
+		jobs.push(Job(path, key, prio, jobSeq++));
+	}
+	queueCv.notify_one();
+	lock_guard<mutex> lock(logMtx);
+	plog->fine("Queued " + path);
+}
+
+/**scanSpool
+ * queues the files existing in the given spool directory.
+ *
+ *@param dir the spool directory
+ *@param plog the pointer to the logger
+ */
+void scanSpool(string dir, Logger* plog) {
+	DIR* dp = opendir(dir.c_str());
+	if (dp == NULL) return;
+	struct dirent* de;
+	while ((de = readdir(dp)) != NULL) enqueue(dir + "/" + string(de->d_name), plog);
+	closedir(dp);
+}
+
+/**worker
+ * takes jobs from the queue and runs the conversion chain for each one, recording the result in the journal.
+ * The result recorded is 0 when all stages ended without errors, or the exit status of the first stage failed.
+ * The key of a file failed is forgotten, so as it can be queued again.
+ * Conversions using the same working directory (as a file dropped again while being converted) are serialized: a job
+ * taken while its working directory is busy is deferred until the conversion in progress ends.
+ *
+ *@param chain the conversion chain to use
+ *@param plog the pointer to the logger
+ */
+void worker(ConversionChain* chain, Logger* plog) {
+	while (true) {
+		unique_lock<mutex> lock(queueMtx);
+		queueCv.wait(lock, [] {return stopping || !jobs.empty();});
+		if (stopping) return;
+		Job job = jobs.top();
+		jobs.pop();
+		string dir = chain->workDir(job.path);
+		if (!busyDirs.insert(dir).second) {
+			deferred.insert(make_pair(dir, job));
+			continue;
+		}
+		lock.unlock();
+		//run the conversion chain
+		int result = 0;
+		string failed;
+		ConvStage stage = ConversionChain::firstStage(job.path);
+		if (!chain->prepare(job.path)) {
+			result = -1;
+			failed = "prepare";
+		} else {
+			if (stage != OSP_RINEX) {
+				result = chain->runStage(stage, job.path);
+				if (result != 0) failed = ConversionChain::stageName(stage);
+			}
+			for (int st = OSP_RINEX; (result == 0) && (st < NSTAGES); st++) {
+				result = chain->runStage((ConvStage) st, job.path);
+				if (result != 0) failed = ConversionChain::stageName((ConvStage) st);
+			}
+		}
+		//record the result
+		{
+			lock_guard<mutex> jlock(journalMtx);
+			fprintf(journal, "%d %s\n", result, job.key.c_str());
+			fflush(journal);
+			fsync(fileno(journal));
+		}
+		//release the working directory, queuing again the jobs deferred on it
+		lock.lock();
+		if (result != 0) knownKeys.erase(job.key);	//allows to retry it when dropped again or spool is rescanned
+		busyDirs.erase(dir);
+		pair<multimap<string, Job>::iterator, multimap<string, Job>::iterator> waiting = deferred.equal_range(dir);
+		for (multimap<string, Job>::iterator it = waiting.first; it != waiting.second; ++it) jobs.push(it->second);
+		bool requeued = waiting.first != waiting.second;
+		deferred.erase(waiting.first, waiting.second);
+		lock.unlock();
+		if (requeued) queueCv.notify_all();
+		lock_guard<mutex> llock(logMtx);
+		if (result == 0) plog->info("Converted " + job.path);
+		else plog->warning("Error converting " + job.path + " in " + failed + ". Exit status " + to_string((long long) result));
+	}
+}
+
+/**onSignal
+ * requests the end of the service
+ */
+void onSignal(int) {
+	stopRequested = 1;
+}
+//@endcond
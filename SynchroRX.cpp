@@ -10,7 +10,7 @@
  *	- -p COMPORT or --port=COMPORT : Serial port name where receiver is connected. Default value COMPORT = COM35
  *	- -m MODE or --mode=MODE : Set receiver protocol to NMEA or OSP. Default value MODE = NMEA
  *<p>
- *Copyright 2015, 2021 by Francisco Cancillo & Luis Cancillo
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
  *<p>
  *This file is part of the RXtoRINEX tool.
  *<p>
@@ -27,6 +27,7 @@
  *<p>V1.1	|2/2016	|Minor improvements for logging messages
  *<p>V1.2	|2/2018	|Adapted to new SerialTxRx I/F to set and get port parameters
  *<p>				|Reviewed to run on Linux
+ *<p>V1.3	|10/2026	|Synchronization logic moved to ReceiverSync, to be shared with RXtoOSP
  */
 
 //from CommonClasses
@@ -43,40 +44,20 @@
 #endif
 #include <stdio.h>
 
+#include "ReceiverSync.h"
+
 using namespace std;
 
 //@cond DUMMY
 ///The command line format
 const string CMDLINE = "SynchroRX.exe {options}";
-const string MYVER = " V1.2";
-///Default baud rate for OSP binary data transfers
-const int OSPbRate = 57600;
-///Default baud rate for NMEA ASCII data transfers
-const int NMEAbRate = 9600;
-///Maximum time limit for timeout when reading data from serial port
-const int MAXtimeout = 50;	//tenthsecons
-///Sleeping time to wait after sending to the receiver a command to change mode or speed (in milliseconds)
-const int SLPtime = 3000;
+const string MYVER = " V1.3";
 ///The parser object to store options and operators passed in the command line
 ArgParser parser;
 //Metavariables for options
 int COMPORT, HELP, LOGLEVEL, MODE, PAT; //metavariables for options in the command line call
 //Metavariables for operators
 
-//Protocols / modes used by the receiver to exchange data
-enum protocol {OSP=0, NMEA, UNKNOWN};
-//Bit rates that can be used 
-const int bRates[] = {NMEAbRate, OSPbRate, 1200, 2400, 4800, 38400, 115200, 0};
-//arguments for SiRF receiver commands
-//NMEA cmd args to change mode from NMEA to OSP at 57600 bps baud rate 
-const char* cmdNMEA100 = "0,57600,8,1,0";
-//OSP cmd args to set baud rate at 57600 bps
-const char* cmdOSP134 = "00 00 E1 00 08 01 00 00";
-//OSP cmd args to change mode from OSP to NMEA at 9600 bps baud rate 
-const char* cmdOSP129 = "02 01 01 00 01 01 01 05 01 01 01 00 01 00 01 00 01 00 01 00 01 25 80";
-//functions in this module
-bool checkProtocol(protocol prtcl, SerialTxRx port, int ntimes, Logger* plog);
-string protocolTXT (protocol p);
 //@endcond 
 
 /**main sets the communication between computer and receiver at the speed and mode requested. 
@@ -110,7 +91,7 @@ string protocolTXT (protocol p);
  */
 int main(int argc, char** argv) {
 	char textBuf[200];
-	sprintf(textBuf, "NMEA or OSP to set receiver protocol to NMEA at %d baud or OSP at %d", NMEAbRate, OSPbRate);
+	sprintf(textBuf, "NMEA or OSP to set receiver protocol to NMEA at %d baud or OSP at %d", ReceiverSync::NMEAbRate, ReceiverSync::OSPbRate);
 	/**The main process sequence follows:*/
 	/// 1- Defines and sets the error logger object
 	Logger log("LogFile.txt", string(), string(argv[0]) + MYVER + string(" START"));
@@ -136,177 +117,27 @@ int main(int argc, char** argv) {
 	/// 4- Sets logging level stated in option
 	log.setLevel(parser.getStrOpt(LOGLEVEL));
 	/// 5- Gets from option the protocol mode to be used
-	protocol wantedMode = NMEA;		//default values
+	ReceiverSync::Protocol wantedMode = ReceiverSync::NMEA;		//default values
 	if(parser.getStrOpt(MODE).compare("OSP") == 0) {
-		wantedMode = OSP;
-		log.info(string("Wanted receiver mode: OSP at " + to_string((long long) OSPbRate)));
-	} else log.info(string("Wanted receiver mode: NMEA at " + to_string((long long) NMEAbRate)));
+		wantedMode = ReceiverSync::OSP;
+		log.info(string("Wanted receiver mode: OSP at " + to_string((long long) ReceiverSync::OSPbRate)));
+	} else log.info(string("Wanted receiver mode: NMEA at " + to_string((long long) ReceiverSync::NMEAbRate)));
 	//Set params for the comm port
 	SerialTxRx port;
-	int currentTimeout;
-	bool rawMode;
-	int currentBaud;
-	protocol currentMode = UNKNOWN;
+	ReceiverSync::Protocol currentMode = ReceiverSync::UNKNOWN;
 	try {
-		/// 6 - Checks current computer baud rate
+		/// 6- Opens the port and discovers initial receiver mode and baud rate, first looking for "most likely" ones.
+		///		When failed, iterates over all baud rates sending NMEA and OSP commands to set receiver mode to OSP at 57600 bps.
 		port.openPort(parser.getStrOpt(COMPORT));
-		port.getPortParams(currentBaud, currentTimeout, rawMode);
-		sprintf(textBuf, "Computer port initial settings: BaudRate=%d; Timeout=%d; RawMode=%c", currentBaud, currentTimeout, rawMode?'T':'F');
-		log.info(string(textBuf));
-		/// 6 - Discover initial receiver mode and baud rate, first look for "most likely" ones:
-		/// - if the computer computer baud rate is not the NMEA or OSP one, set the NMEA rate
-		/// - if computer baud rate is the NMEA one, check if receiver is sending NMEA messages
-		/// - if computer baud rate is the OSP one, check if receiver is sending OSP messages
-		if (currentBaud!=NMEAbRate && currentBaud!=OSPbRate) {
-			log.info("As computer port baud rate is not for NMEA or OSP, set NMEA rate");
-			port.setPortParams(NMEAbRate, MAXtimeout);
-			port.getPortParams(currentBaud, currentTimeout, rawMode);
-			sprintf(textBuf, "Computer port set at: BaudRate=%d; Timeout=%d; RawMode=%c", currentBaud, currentTimeout, rawMode?'T':'F');
-			log.info(string(textBuf));
-		}
-		if (currentBaud == NMEAbRate) {
-			log.info("As computer port baud rate is for NMEA, check if receiver is in NMEA mode");
-			if(checkProtocol(NMEA, port, 10, &log)) currentMode = NMEA;
-			else {
-				log.info("Receiver not sending NMEA. Try at OSP rate");
-				port.setPortParams(OSPbRate, MAXtimeout);
-				port.getPortParams(currentBaud, currentTimeout, rawMode);
-				sprintf(textBuf, "Computer port set at: BaudRate=%d; Timeout=%d; RawMode=%c", currentBaud, currentTimeout, rawMode?'T':'F');
-				log.info(string(textBuf));
-				if(checkProtocol(OSP, port, 10, &log)) currentMode = OSP;
-			}
-		} else if (currentBaud == OSPbRate) {
-			log.info("As computer port baud rate is for OSP, check if receiver is in OSP mode");
-			if(checkProtocol(OSP, port, 10, &log)) currentMode = OSP;
-			else {
-				log.info("Receiver not sending OSP. Try at NMEA rate");
-				port.setPortParams(NMEAbRate, MAXtimeout);
-				port.getPortParams(currentBaud, currentTimeout, rawMode);
-				sprintf(textBuf, "Computer port set at: BaudRate=%d; Timeout=%d; RawMode=%c", currentBaud, currentTimeout, rawMode?'T':'F');
-				log.info(string(textBuf));
-				if(checkProtocol(NMEA, port, 10, &log)) currentMode = NMEA;
-			}
-		}
-		log.info("Receiver initial protocol: " + protocolTXT(currentMode));
-		/// 9- When failed to discover receiver mode at usual baud rates, iterate over all baud rates
-		///		setting computer port speed and sending NMEA and OSP commands to set its mode to OSP at 57600 bps.
-		///		Then checks if the current receiver mode has changed to OSP.
-		if (currentMode == UNKNOWN) {	//mode not identified at usual baud rates
-			log.info("Iterate over all baud rates trying to set receiver in OSP mode at 57600 bps");
-			//broadcast a change to OSP at 57600 in the receiver using all baud rates in the computer
-			for(int i=0; bRates[i]!=0; i++) {
-				port.setPortParams(bRates[i], MAXtimeout);
-				port.getPortParams(currentBaud, currentTimeout, rawMode);
-				port.writeNMEAcmd(100,cmdNMEA100);
-				port.writeNMEAcmd(100,cmdNMEA100);
-				sprintf(textBuf, "Computer port set at BaudRate %d and NMEA command sent to change to OSP mode at 57600 bps", currentBaud);
-				log.info(string(textBuf));
-			}
-			for(int i=0; bRates[i]!=0; i++) {
-				port.setPortParams(bRates[i], MAXtimeout);
-				port.getPortParams(currentBaud, currentTimeout, rawMode);
-				port.writeOSPcmd(134,cmdOSP134);
-				port.writeOSPcmd(134,cmdOSP134);
-				sprintf(textBuf, "Computer port set at BaudRate %d and OSP command sent to change at 57600 bps", currentBaud);
-				log.info(string(textBuf));
-			}
-			port.setPortParams(OSPbRate, MAXtimeout);
-			port.getPortParams(currentBaud, currentTimeout, rawMode);
-			sprintf(textBuf, "Computer port set at BaudRate %d to check if receiver is sending OSP at 57600 bps", currentBaud);
-			log.info(string(textBuf));
-			if(checkProtocol(OSP, port, 2, &log)) currentMode = OSP;
-			log.info("After broadcasting change to OSP, receiver protocol is " + protocolTXT(currentMode));
-		}
-		/// 10- If the current receiver mode is OSP, but it is wanted to be NMEA, sends a OSP command
-		///		to change it, and sets computer com speed at NMEAbRate. Then checks if new mode has changed to NMEA.
-		if (currentMode==OSP && wantedMode==NMEA) {
-			log.info("In receiver OSP mode, sends MID129 to change to NMEA at 9600 bps");
-			port.writeOSPcmd(129,cmdOSP129);
-			port.sleepTime(SLPtime);	//wait some seconds after changing receiver speed
-			port.setPortParams(NMEAbRate, MAXtimeout);		//now change computer port speed
-			if(checkProtocol(NMEA, port, 10, &log)) currentMode = NMEA;
-		/// 11- If the current receiver mode is NMEA, but it is wanted to be OSP, sends a NMEA command
-		///		to change it, and sets computer com speed at OSPbRate Then checks if new mode has changed to OSP.
-		} else if (currentMode==NMEA && wantedMode==OSP) {
-			log.info("In receiver NMEA mode, sends NMEA 100 to change to osp at 57600 bps");
-			port.writeNMEAcmd(100,cmdNMEA100);
-			port.sleepTime(SLPtime);	//wait some seconds after changing receiver speed
-			port.setPortParams(OSPbRate, MAXtimeout);		//now change computer port speed
-			if(checkProtocol(OSP, port, 10, &log)) currentMode = OSP;
-		}
-		sprintf(textBuf, "Receiver final protocol: %s. Change is %s", protocolTXT(currentMode).c_str(), currentMode==wantedMode? "OK" : "NOK");
-		log.info(string(textBuf));
-		port.getPortParams(currentBaud, currentTimeout, rawMode);
-		sprintf(textBuf, "Computer port final settings: BaudRate=%d; Timeout=%d; RawMode=%c\n", currentBaud, currentTimeout, rawMode?'T':'F');
-		log.info(string(textBuf));
+		ReceiverSync sync(port, stoi(parser.getStrOpt(PAT)), &log);
+		/// 7- If the current receiver mode is not the wanted one, sends the command to change it, sets computer
+		///		port speed accordingly, and checks if the mode has changed.
+		currentMode = sync.synchronize(wantedMode);
 	} catch (string error) {
 		log.severe(error);
 		return 2;
 	}
-	/// 12- Verify if the resulting current mode is the wanted one, and returns value accordingly
+	/// 8- Verify if the resulting current mode is the wanted one, and returns value accordingly
 	if (currentMode!=wantedMode) return 3;
 	return 0;
 }
-
-//@cond DUMMY
-/**checkProtocol
- * checks if the given protocol is currently being used by the GPS receiver.
- *
- * @param prtcl the protocol to be checked (OSP or NMEA)
- * @param port the computer SerialTxRx object being used for communications with the GNSS receiver
- * @param ntimes the maximum number of attempts for receiving a message before returning a false result
- * @param plog the pointer to the logger
- * @return true when a correct message of the given protocol is received, false otherwise
- */
-bool checkProtocol(protocol prtcl, SerialTxRx port, int ntimes, Logger* plog) {
-	int resultCode;
-	string logMsg;
-	int nattempt = 0;
-	int patience = stoi(parser.getStrOpt(PAT));
-	do {
-		resultCode = prtcl==NMEA? port.readNMEAmsg(patience) : port.readOSPmsg(patience);
-		ntimes--;
-		nattempt++;
-	} while (resultCode!=0 && ntimes>0);
-	//log result
-	if (prtcl == NMEA) {
-		logMsg = "Checked receiver NMEA mode: In attempt " + to_string((long long) nattempt) + ", ";
-		switch (resultCode) {
-		case 0: logMsg += "message OK"; break;
-		case 1: logMsg += "checksum error"; break;
-		case 2: logMsg += "message too short (<$XXX*SS)"; break;
-		case 3: logMsg += "no NMEA messages, or input error occurred, or EOF"; break;
-		case 4: logMsg += "no NMEA start received in " + to_string((long long) patience * nattempt) + " bytes"; break;
-		default: logMsg += "UNKNOWN";
-		}
-		plog->info(logMsg);
-		if (resultCode == 0) plog->fine("NMEA message received: " + string((char*) port.payBuff));
-	} else {
-		logMsg = "Checked receiver OSP mode: In attempt " + to_string((long long) nattempt) + ", ";
-		switch (resultCode) {
-		case 0: logMsg += "message OK"; break;
-		case 1: logMsg += "checksum error"; break;
-		case 2: logMsg += "error reading payload or few bytes"; break;
-		case 3: logMsg += "payload length out of margin"; break;
-		case 4:
-		case 5: logMsg += "error reading payload length"; break;
-		case 6: logMsg += "no OSP start received in " + to_string((long long) patience * nattempt) + " bytes"; break;
-		default: logMsg += "UNKNOWN";
-		}
-		plog->info(logMsg);
-		if (resultCode == 0) plog->fine("OSP message received: MID=" + to_string((long long) port.payBuff[0]) + " len=" + to_string((long long) port.payloadLen));
-	}
-	return resultCode == 0;
-}
-
-/**protocolTXT
- * gives a readable description on the protocol
- */
-string protocolTXT (protocol p) {
-	switch (p) {
-	case NMEA: return "NMEA";
-	case OSP: return "OSP";
-	default: return "UNKNOWN";
-	}
-}
-//@endcond 
@@ -0,0 +1,248 @@
+/** @file TimeTagSidecar.cpp
+ * Contains the implementation of the TimeTagSidecar class.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#include "TimeTagSidecar.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+//@cond DUMMY
+//the sidecar file identification and format version
+static const char MAGIC[8] = {'G', 'P', '2', 'T', 'T', 'A', 'G', '1'};
+//the size of the buffer to write records
+static const size_t IOBUFSIZE = 1048576;
+
+//the number of days from 01/01/1970 to the given date of the proleptic Gregorian calendar
+static int64_t daysFromCivil(int64_t y, int64_t m, int64_t d) {
+	y -= m <= 2;
+	int64_t era = (y >= 0 ? y : y - 399) / 400;
+	int64_t yoe = y - era * 400;
+	int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+	int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+	return era * 146097 + doe - 719468;
+}
+//the value of n decimal digits
+static inline int digits(const char* p, int n) {
+	int v = 0;
+	for (int i = 0; i < n; i++) v = v * 10 + p[i] - '0';
+	return v;
+}
+//the milliseconds part of a time tag: ".mmm", if present
+static inline bool hasMillis(const char* p) {
+	return p[0] == '.' && isdigit((unsigned char) p[1]) && isdigit((unsigned char) p[2]) && isdigit((unsigned char) p[3]);
+}
+//the maximum length of a varint: 64 bits in 7 bits groups
+static const int MAXVARINT = 10;
+//@endcond
+
+/**Header is the first part of the sidecar file
+ */
+struct TimeTagSidecar::Header {
+	char magic[8];			//the MAGIC identification
+	uint64_t count;			//number of records
+	int64_t first;			//the first time tag, in milliseconds
+	int64_t last;			//the last time tag, in milliseconds
+};
+
+/**TimeTagSidecar
+ * constructs a closed sidecar.
+ */
+TimeTagSidecar::TimeTagSidecar() {
+	file = NULL;
+	count = 0;
+	first = last = 0;
+}
+
+/**open
+ * creates the sidecar file, or opens it to append records if it exists and append is requested.
+ *
+ *@param fileName the sidecar file name
+ *@param append true to append records to an existing sidecar, false to create a new one
+ *@return true if the sidecar is open, false otherwise
+ */
+bool TimeTagSidecar::open(string fileName, bool append) {
+	Header h;
+	count = 0;
+	first = last = 0;
+	if (append && (file = fopen(fileName.c_str(), "r+b")) != NULL) {
+		setvbuf(file, NULL, _IOFBF, IOBUFSIZE);		//before any other operation on the stream, as stated by the standard
+		//position after the last record stated in the header
+		if (fread(&h, sizeof h, 1, file) == 1 && memcmp(h.magic, MAGIC, sizeof MAGIC) == 0) {
+			count = h.count;
+			first = h.first;
+			last = h.last;
+			uint64_t n = 0;
+			int c = 0;
+			while (n < 2 * count && (c = fgetc(file)) != EOF) if ((c & 0x80) == 0) n++;
+			if (n == 2 * count && fseek(file, 0, SEEK_CUR) == 0) return true;
+		}
+		fclose(file);
+		count = 0;
+		first = last = 0;
+	}
+	if ((file = fopen(fileName.c_str(), "wb")) == NULL) return false;
+	setvbuf(file, NULL, _IOFBF, IOBUFSIZE);
+	memset(&h, 0, sizeof h);
+	memcpy(h.magic, MAGIC, sizeof MAGIC);
+	if (fwrite(&h, sizeof h, 1, file) != 1) {
+		fclose(file);
+		file = NULL;
+		return false;
+	}
+	return true;
+}
+
+/**isOpen
+ * tells if the sidecar is open.
+ *
+ *@return true if open, false otherwise
+ */
+bool TimeTagSidecar::isOpen() {
+	return file != NULL;
+}
+
+/**add
+ * appends the record of the next message.
+ *
+ *@param millis the time tag of the message, in milliseconds
+ *@param field the "(n)" field of the message
+ *@return true if written, false otherwise
+ */
+bool TimeTagSidecar::add(int64_t millis, int32_t field) {
+	if (file == NULL) return false;
+	if (count == 0) first = last = millis;
+	bool ok = putVarint(millis - last) && putVarint(field);
+	last = millis;
+	count++;
+	return ok;
+}
+
+/**close
+ * updates the sidecar header and closes it.
+ *
+ *@return true if the sidecar has been written completely, false otherwise
+ */
+bool TimeTagSidecar::close() {
+	if (file == NULL) return false;
+	Header h;
+	memcpy(h.magic, MAGIC, sizeof MAGIC);
+	h.count = count;
+	h.first = first;
+	h.last = last;
+	bool ok = fflush(file) == 0 && fseek(file, 0, SEEK_SET) == 0 && fwrite(&h, sizeof h, 1, file) == 1;
+	ok = (fclose(file) == 0) && ok;
+	file = NULL;
+	return ok;
+}
+
+/**readAll
+ * reads all records in the given sidecar. The n-th record belongs to the n-th message in the OSP file.
+ *
+ *@param fileName the sidecar file name
+ *@param tags where the time tags are returned
+ *@return true if the sidecar has been read, false if it cannot be read or it is not valid
+ */
+bool TimeTagSidecar::readAll(string fileName, vector<TimeTag>& tags) {
+	tags.clear();
+	FILE* f = fopen(fileName.c_str(), "rb");
+	if (f == NULL) return false;
+	setvbuf(f, NULL, _IOFBF, IOBUFSIZE);
+	Header h;
+	if (fread(&h, sizeof h, 1, f) != 1 || memcmp(h.magic, MAGIC, sizeof MAGIC) != 0) {
+		fclose(f);
+		return false;
+	}
+	tags.reserve(h.count);
+	int64_t t = h.first;
+	int64_t v[2];
+	int c = 0;
+	while (tags.size() < h.count && c != EOF) {
+		for (int i = 0; i < 2 && c != EOF; i++) {
+			uint64_t u = 0;
+			int shift = 0;
+			while ((c = fgetc(f)) != EOF) {
+				if (shift == 7 * MAXVARINT) {	//too long: not a valid varint
+					c = EOF;
+					break;
+				}
+				u |= (uint64_t) (c & 0x7F) << shift;
+				shift += 7;
+				if ((c & 0x80) == 0) break;
+			}
+			v[i] = (int64_t) (u >> 1) ^ -(int64_t) (u & 1);
+		}
+		if (c == EOF) break;
+		t += v[0];
+		TimeTag tag = {t, (int32_t) v[1]};
+		tags.push_back(tag);
+	}
+	fclose(f);
+	return tags.size() == h.count;
+}
+
+/**tagMillis
+ * gives the time in milliseconds of the given GP2 time tag, counted from 01/01/1970 00:00:00.000 of the same clock.
+ * Time tags without milliseconds are accepted, as they are by GP2toOSP, and taken at the whole second.
+ *
+ *@param timeTag the time tag at the start of a GP2 line: dd/mm/yyyy hh:mm:ss.mmm or dd/mm/yyyy hh:mm:ss
+ *@return the time in milliseconds, or -1 if the time tag is not valid
+ */
+int64_t TimeTagSidecar::tagMillis(const char* timeTag) {
+	int day, month, year, hour, minute, second, n = 0;
+	if (sscanf(timeTag, "%d/%d/%d %d:%d:%d%n", &day, &month, &year, &hour, &minute, &second, &n) != 6) return -1;
+	int64_t secs = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second;
+	return secs * 1000 + (hasMillis(timeTag + n) ? digits(timeTag + n + 1, 3) : 0);
+}
+
+/**tagField
+ * gives the value of the "(n)" field following the time tag in a GP2 line.
+ *
+ *@param gp2Line the GP2 line
+ *@return the field value, or -1 if it does not exist
+ */
+int32_t TimeTagSidecar::tagField(const char* gp2Line) {
+	int n = 0;
+	if (sscanf(gp2Line, "%*d/%*d/%*d %*d:%*d:%*d%n", &n) != 0 || n == 0) return -1;
+	const char* p = gp2Line + n;
+	if (hasMillis(p)) p += 4;
+	while (*p == ' ') p++;
+	if (*p != '(') return -1;
+	return (int32_t) strtol(p + 1, NULL, 10);
+}
+
+//@cond DUMMY
+/**putVarint
+ * writes the given value zigzag encoded as a variable length integer.
+ *
+ *@param v the value
+ *@return true if written, false otherwise
+ */
+bool TimeTagSidecar::putVarint(int64_t v) {
+	unsigned char buf[10];
+	uint64_t u = ((uint64_t) v << 1) ^ (uint64_t) (v >> 63);
+	int n = 0;
+	do {
+		buf[n] = (unsigned char) (u & 0x7F);
+		u >>= 7;
+		if (u != 0) buf[n] |= 0x80;
+		n++;
+	} while (u != 0);
+	return fwrite(buf, 1, n, file) == (size_t) n;
+}
+//@endcond
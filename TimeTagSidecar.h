@@ -0,0 +1,65 @@
+/** @file TimeTagSidecar.h
+ * Contains the definition of the TimeTagSidecar class, used to keep the GP2 time tags of the messages in an OSP file.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef TIMETAGSIDECAR_H
+#define TIMETAGSIDECAR_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**TimeTag is the host side timing of a message: the GP2 line time tag and its "(n)" field
+ */
+struct TimeTag {
+	int64_t millis;		//time tag in milliseconds from 01/01/1970 00:00:00.000 of the same clock (local time, as logged)
+	int32_t field;		//the value between parentheses following the time tag
+};
+
+/**TimeTagSidecar writes and reads the time tag sidecar of an OSP file generated from a GP2 file.
+ *<p>
+ * The sidecar contains, for each message in the OSP file and in the same order, the time tag and "(n)" field of the
+ * GP2 line it comes from, so that the n-th record in the sidecar belongs to the n-th message in the OSP file.
+ * After a header with the number of records and the first and last time tags, each record contains the difference in
+ * milliseconds from the previous time tag and the field value, both encoded as variable length integers (zigzag
+ * encoded, 7 bits per byte), taking usually 3 bytes per message.
+ *<p>
+ * Records are written through a large buffer. The header is updated when the sidecar is closed, and records beyond the
+ * count stated in it, as left by an interrupted conversion, are ignored by readers and overwritten when appending.
+ */
+class TimeTagSidecar {
+public:
+	TimeTagSidecar();
+	bool open(string fileName, bool append);
+	bool isOpen();
+	bool add(int64_t millis, int32_t field);
+	bool close();
+	static bool readAll(string fileName, vector<TimeTag>& tags);
+	static int64_t tagMillis(const char* timeTag);
+	static int32_t tagField(const char* gp2Line);
+private:
+	struct Header;
+	FILE* file;			//the sidecar file, or NULL if closed
+	uint64_t count;		//number of records
+	int64_t first;		//the first time tag
+	int64_t last;		//the last time tag
+	bool putVarint(int64_t v);
+};
+#endif
@@ -0,0 +1,182 @@
+/** @file TraceLog.cpp
+ * Contains the implementation of the TraceLog class.
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#include "TraceLog.h"
+
+#include <stdio.h>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#if defined(__linux__)
+#include <unistd.h>
+#include <sys/syscall.h>
+#endif
+
+//@cond DUMMY
+///A span recorded
+struct TraceEvent {
+	uint64_t start;
+	uint64_t end;
+	unsigned char stage;
+};
+///Events are recorded in chunks of this size, to avoid reallocations when recording
+const size_t CHUNKEVENTS = 32768;
+///The buffer of events recorded by a thread
+struct ThreadBuffer {
+	long tid;
+	vector<TraceEvent*> chunks;
+	size_t used;	//events used in the last chunk
+};
+static mutex regMtx;
+static vector<ThreadBuffer*> buffers;
+static thread_local ThreadBuffer* myBuffer = NULL;
+static atomic<unsigned> generation(0);		//incremented by each close, as it releases all buffers
+static thread_local unsigned myGeneration = 0;	//the generation of myBuffer
+static uint64_t origin = 0;
+
+static long threadId() {
+#if defined(__linux__)
+	return (long) syscall(SYS_gettid);
+#else
+	return (long) (hash<thread::id>()(this_thread::get_id()) & 0x7FFFFFFF);
+#endif
+}
+//@endcond
+
+atomic<bool> TraceLog::enabled(false);
+string TraceLog::fileName;
+
+/**open
+ * starts recording spans to be written in the given file.
+ *
+ *@param fileName the trace file name. If empty, tracing is not enabled
+ *@return true if tracing has been enabled, false otherwise
+ */
+bool TraceLog::open(string fileName) {
+	if (fileName.empty()) return false;
+	TraceLog::fileName = fileName;
+	origin = now();
+	enabled = true;
+	return true;
+}
+
+/**now
+ * gives the current time from a monotonic clock.
+ *
+ *@return the time in nanoseconds
+ */
+uint64_t TraceLog::now() {
+	return (uint64_t) chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/**record
+ * records in the buffer of the calling thread the given span.
+ *
+ *@param stage the stage performed
+ *@param start the time the stage started, in nanoseconds
+ *@param end the time the stage ended, in nanoseconds
+ */
+void TraceLog::record(TraceStage stage, uint64_t start, uint64_t end) {
+	ThreadBuffer* tb = myBuffer;
+	if (tb == NULL || myGeneration != generation.load()) {
+		//first span of the thread, or its buffer was released by close: register a new one
+		lock_guard<mutex> lock(regMtx);
+		if (!enabled) return;
+		tb = new ThreadBuffer();
+		tb->tid = threadId();
+		tb->used = CHUNKEVENTS;
+		buffers.push_back(tb);
+		myBuffer = tb;
+		myGeneration = generation.load();
+	}
+	if (tb->used == CHUNKEVENTS) {
+		tb->chunks.push_back(new TraceEvent[CHUNKEVENTS]);
+		tb->used = 0;
+	}
+	TraceEvent& ev = tb->chunks.back()[tb->used++];
+	ev.start = start;
+	ev.end = end;
+	ev.stage = (unsigned char) stage;
+}
+
+/**stageName
+ * gives the name of the stage as shown in the trace file.
+ *
+ *@param stage the stage
+ *@return the stage name
+ */
+string TraceLog::stageName(TraceStage stage) {
+	switch (stage) {
+	case TR_READ: return "read";
+	case TR_FRAME: return "frame";
+	case TR_DECODE: return "decode";
+	case TR_FILTER: return "filter";
+	case TR_FORMAT: return "format";
+	case TR_WRITE: return "write";
+	default: return "unknown";
+	}
+}
+
+/**close
+ * stops recording and writes the spans recorded by all threads to the trace file, as complete ("X") events of the
+ * Chrome trace-event format. Times are given in microseconds from the start of tracing.
+ * It shall be called when threads recording spans have ended. Buffers of all threads are released: threads recording
+ * spans after a later open register new ones.
+ *
+ *@return true if the trace file has been written, false otherwise
+ */
+bool TraceLog::close() {
+	if (!enabled.exchange(false)) return false;
+	FILE* out = fopen(fileName.c_str(), "w");
+	bool written = out != NULL;
+	lock_guard<mutex> lock(regMtx);
+	long pid = 0;
+#if defined(__linux__)
+	pid = (long) getpid();
+#endif
+	if (written) {
+		fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+		bool first = true;
+		for (size_t b = 0; b < buffers.size(); b++) {
+			ThreadBuffer* tb = buffers[b];
+			fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%ld,\"tid\":%ld,\"args\":{\"name\":\"%s%ld\"}}",
+				first? "" : ",\n", pid, tb->tid, tb->tid == pid? "main " : "thread ", tb->tid);
+			first = false;
+			for (size_t c = 0; c < tb->chunks.size(); c++) {
+				size_t n = (c == tb->chunks.size() - 1)? tb->used : CHUNKEVENTS;
+				for (size_t i = 0; i < n; i++) {
+					TraceEvent& ev = tb->chunks[c][i];
+					fprintf(out, ",\n{\"name\":\"%s\",\"cat\":\"OSPtools\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%ld,\"tid\":%ld}",
+						stageName((TraceStage) ev.stage).c_str(), (ev.start - origin) / 1000.0, (ev.end - ev.start) / 1000.0, pid, tb->tid);
+				}
+			}
+		}
+		fprintf(out, "\n]}\n");
+		written = fclose(out) == 0;
+	}
+	for (size_t b = 0; b < buffers.size(); b++) {
+		for (size_t c = 0; c < buffers[b]->chunks.size(); c++) delete[] buffers[b]->chunks[c];
+		delete buffers[b];
+	}
+	buffers.clear();
+	generation++;	//buffers of other threads are not valid now
+	myBuffer = NULL;
+	return written;
+}
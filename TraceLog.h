@@ -0,0 +1,98 @@
+/** @file TraceLog.h
+ * Contains the definition of the TraceLog class, used to record the timeline of the processing stages of OSPtools
+ * commands and to write it as a Chrome trace-event JSON file (viewable in Perfetto or chrome://tracing).
+ *<p>
+ *Copyright 2015, 2026 by Francisco Cancillo & Luis Cancillo
+ *<p>
+ *This file is part of the RXtoRINEX tool.
+ *<p>
+ *RXtoRINEX is free software: you can redistribute it and/or modify it under the terms of the GNU General Public License
+ *as published by the Free Software Foundation, either version 3 of the License, or (at your option) any later version.
+ *<p>RXtoRINEX is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY; without even the implied
+ *warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+ *<p>See the GNU General Public License for more details.
+ *A copy of the GNU General Public License can be found at <http://www.gnu.org/licenses/>.
+ *
+ *<p>Ver.	|Date	|Reason for change
+ *<p>------+-------+------------------
+ *<p>V1.0	|10/2026	|First release
+ */
+#ifndef TRACELOG_H
+#define TRACELOG_H
+
+#include <stdint.h>
+#include <atomic>
+#include <string>
+
+using namespace std;
+
+/**TraceStage identifies the processing stages recorded in the timeline.
+ */
+enum TraceStage {TR_READ = 0, TR_FRAME, TR_DECODE, TR_FILTER, TR_FORMAT, TR_WRITE, TR_NSTAGES};
+
+/**TraceLog records time spans of processing stages, with the identification of the thread performing them.
+ * Each thread records its spans in its own buffer, without locks. Buffers are registered (the only operation
+ * requiring a lock) when a thread records its first span after tracing has been opened: buffers are released by close,
+ * and the ones a thread registered before are not used again.
+ *<p>
+ * Code to be traced marks the time where a stage starts and records the span when it ends. As stages usually follow
+ * one after the other, span returns the end time to be used as start of the next stage:
+ *<p>
+ *		uint64_t t = TraceLog::mark();
+ *<p>
+ *		read(...); t = TraceLog::span(TR_READ, t);
+ *<p>
+ *		decode(...); t = TraceLog::span(TR_DECODE, t);
+ *<p>
+ * When tracing is not enabled, mark and span only test a flag and return 0.
+ * The trace file is written by close, which shall be called when all traced threads have ended.
+ */
+class TraceLog {
+public:
+	static atomic<bool> enabled;	//true when spans are being recorded
+	static bool open(string fileName);
+	static bool close();
+	static uint64_t now();
+	/**mark
+	 * gives the time to be used as start of a span.
+	 *
+	 *@return the current time in nanoseconds, or 0 if tracing is not enabled
+	 */
+	static inline uint64_t mark() {
+		return enabled.load(memory_order_relaxed)? now() : 0;
+	}
+	/**span
+	 * records the span of a stage started at the given time and ending now.
+	 *
+	 *@param stage the stage performed
+	 *@param start the time the stage started, as given by mark or a previous span
+	 *@return the current time, to be used as start of the next stage, or 0 if tracing is not enabled
+	 */
+	static inline uint64_t span(TraceStage stage, uint64_t start) {
+		if (!enabled.load(memory_order_relaxed)) return 0;
+		uint64_t end = now();
+		record(stage, start, end);
+		return end;
+	}
+	static void record(TraceStage stage, uint64_t start, uint64_t end);
+	static string stageName(TraceStage stage);
+private:
+	static string fileName;
+};
+
+/**TraceSpan records the span of a stage performed in a block, from its construction to its destruction.
+ */
+class TraceSpan {
+public:
+	TraceSpan(TraceStage stage) {
+		this->stage = stage;
+		start = TraceLog::mark();
+	}
+	~TraceSpan() {
+		TraceLog::span(stage, start);
+	}
+private:
+	TraceStage stage;
+	uint64_t start;
+};
+#endif